@@ -0,0 +1,474 @@
+﻿/**
+ * Grafik
+ * Benchmarks
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Benchmarks.h"
+
+#include "Harness.h"
+#include "core/JobSystem.h"
+#include "events/ApplicationEvent.h"
+#include "events/EventManager.h"
+#include "events/InputEvent.h"
+#include "labb/Batch.h"
+#include "labb/Loop.h"
+#include "renderer/opengl/OpenGLShader.h"
+#include "TextureAtlas.h"
+#include "utils/File.h"
+#include "VertexBufferLayout.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+
+namespace bench
+{
+    namespace
+    {
+        // Reach the protected static helpers without creating a lab, which needs a context
+        struct BatchAccess : labb::LBatch { using LBatch::MakeQuad; };
+        struct LoopAccess : labb::LLoop { using LLoop::MakeCylinder; };
+
+        struct TickListener
+        {
+            uint64_t ticks { 0 };
+            void OnTick(TickEvent&) { ticks++; }
+        };
+
+        // Appends its id to a shared log, onTick runs once to change the listeners mid-broadcast
+        struct OrderListener
+        {
+            std::string* log { nullptr };
+            char id { };
+            std::function<void()> onTick { };
+            void OnTick(TickEvent&) { *log += id; if (onTick) std::exchange(onTick, nullptr)(); }
+            void OnEvent(Event&) { *log += static_cast<char>(std::toupper(id)); }
+        };
+
+        // Grid laid out like LBatch::OnRender
+        labb::Vertex* FillGrid(labb::Vertex* vertexPtr, size_t quads)
+        {
+            constexpr float size { 0.1f };
+            const size_t rows = static_cast<size_t>(std::floor(std::sqrt(static_cast<double>(quads))));
+            const size_t cols = (quads + rows - 1) / rows;
+            for (size_t n = 0; n < quads; n++)
+            {
+                const float x = static_cast<float>(n / rows) * size;
+                const float y = static_cast<float>(n % rows) * size;
+                const glm::vec4 color { static_cast<float>(n % rows) / static_cast<float>(rows), 1.0f - x / static_cast<float>(cols), 0.5f, 1.0f };
+                vertexPtr = BatchAccess::MakeQuad(vertexPtr, x, y, 0.0f, size, size, static_cast<float>(n % 3), color);
+            }
+            return vertexPtr;
+        }
+    }
+
+    void RunGeometry(Harness& harness)
+    {
+        for (const size_t quads : { 1000, 20000, 100000 })
+        {
+            std::vector<labb::Vertex> vertices(quads * 4);
+            harness.Run("MakeQuad/grid/" + std::to_string(quads), quads, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    labb::Vertex* end = FillGrid(vertices.data(), quads);
+                    DoNotOptimize(end);
+                }
+            });
+
+            std::vector<unsigned> indices(quads * 6);
+            harness.Run("MakeQuadIndices/" + std::to_string(quads), quads, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    labb::MakeQuadIndices(indices);
+                    DoNotOptimize(indices[i % indices.size()]);
+                }
+            });
+        }
+
+        harness.Run("MakeCylinder/" + std::to_string(labb::loopSegments), labb::loopSegments, [](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                auto vertices = LoopAccess::MakeCylinder({ 0.0f, 0.0f }, 2.0f, 1.0f, static_cast<int>(labb::loopSegments));
+                DoNotOptimize(vertices);
+            }
+        });
+
+        harness.Run("VertexBufferLayout/lab", 1, [](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                VertexBufferLayout layout;
+                layout.Push<glm::vec3>(1);
+                layout.Push<glm::vec4>(1);
+                layout.Push<glm::vec2>(1);
+                layout.Push<float>(1);
+                DoNotOptimize(layout);
+            }
+        });
+    }
+
+    void RunEvents(Harness& harness)
+    {
+        EventManager* events = EventManager::Get();
+        for (const size_t count : { 1, 16, 256 })
+        {
+            std::vector<TickListener> listeners(count);
+            for (TickListener& listener : listeners)
+            {
+                events->addListener<TickEvent, &TickListener::OnTick>(&listener);
+            }
+
+            TickEvent event { 1.0 / 60.0 };
+            events->Broadcast(event);   // resolves the table outside the timed loop
+
+            harness.Run("EventManager::Broadcast/" + std::to_string(count), count, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    events->Broadcast(event);
+                }
+            });
+            events->Reset();
+        }
+
+        harness.Run("EventManager::Broadcast/reentrant", 1, [&](uint64_t iterations)
+        {
+            bool bPassed { true };
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                // a removes c, adds d and broadcasts again. The nested broadcast sees the change,
+                // the outer one skips c and leaves d for next time
+                std::string log;
+                OrderListener a { &log, 'a' }, b { &log, 'b' }, c { &log, 'c' }, d { &log, 'd' };
+                events->addListener<&OrderListener::OnEvent>(&a, Event::None);
+                events->addListener<TickEvent, &OrderListener::OnTick>(&a);
+                events->addListener<TickEvent, &OrderListener::OnTick>(&b);
+                events->addListener<TickEvent, &OrderListener::OnTick>(&c);
+                events->setCategoryMask(&a, Event::Application);
+                a.onTick = [&]
+                {
+                    events->removeListener(&c);
+                    events->addListener<TickEvent, &OrderListener::OnTick>(&d);
+                    TickEvent nested { 0.0 };
+                    events->Broadcast(nested);
+                };
+
+                TickEvent event { 0.0 };
+                events->Broadcast(event);
+                events->Broadcast(event);
+                bPassed &= log == "AaAabdbAabd";
+                events->Reset();
+            }
+            harness.Check(bPassed, "EventManager::Broadcast called listeners out of order or after removal");
+        });
+
+        // Producers post numbered events while this thread dispatches, each must arrive once and in order
+        constexpr unsigned producers { 4 };
+        constexpr unsigned perProducer { 2048 };
+        struct PostListener
+        {
+            std::array<unsigned, producers> next { };
+            uint64_t errors { 0 };
+            void OnKeyChar(KeyCharEvent& e)
+            {
+                unsigned& expected = next[static_cast<size_t>(e.GetTimestamp())];
+                errors += e.GetCodepoint() != expected;
+                expected = e.GetCodepoint() + 1;
+            }
+        };
+
+        harness.Run("EventManager::Post/" + std::to_string(producers) + "x" + std::to_string(perProducer), producers * perProducer, [&](uint64_t iterations)
+        {
+            PostListener listener;
+            events->addListener<KeyCharEvent, &PostListener::OnKeyChar>(&listener);
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                listener.next.fill(0);
+                std::atomic<unsigned> finished { 0 };
+                {
+                    std::vector<std::jthread> threads;
+                    for (unsigned producer = 0; producer < producers; producer++)
+                    {
+                        threads.emplace_back([&, producer]
+                        {
+                            for (unsigned n = 0; n < perProducer; n++)
+                            {
+                                while (!events->Post(KeyCharEvent { static_cast<double>(producer), n }))
+                                {
+                                    std::this_thread::yield();
+                                }
+                            }
+                            finished.fetch_add(1, std::memory_order_release);
+                        });
+                    }
+
+                    // One more pass after the last producer finished picks up its final events
+                    bool bDone { false };
+                    while (!bDone)
+                    {
+                        bDone = finished.load(std::memory_order_acquire) == producers;
+                        while (events->DispatchPosted() > 0) { }
+                        std::this_thread::yield();
+                    }
+                }
+                listener.errors += static_cast<uint64_t>(std::ranges::count_if(listener.next, [&](unsigned n) { return n != perProducer; }));
+            }
+            events->Reset();
+            harness.Check(listener.errors == 0, "EventManager::Post lost, repeated or reordered events");
+        });
+    }
+
+    void RunShader(Harness& harness)
+    {
+        // Runs against the GL stub, so this times the location cache and call overhead
+        const OpenGLShader shader { "batch", "data/shaders/batch.vert", "data/shaders/batch.frag" };
+        if (!shader.IsOK())
+        {
+            std::fprintf(stderr, "Skipping shader benchmarks, run from the repository root\n");
+            return;
+        }
+
+        const std::string names[] { "u_MVP", "u_Textures", "u_Color", "u_TexId" };
+        harness.Run("OpenGLShader::GetUniformLocation", std::size(names), [&](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                for (const std::string& name : names)
+                {
+                    int location = shader.GetUniformLocation(name);
+                    DoNotOptimize(location);
+                }
+            }
+        });
+
+        const glm::mat4 mvp { 1.0f };
+        harness.Run("OpenGLShader::SetUniformMat4f", 1, [&](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                shader.SetUniformMat4f("u_MVP", mvp);
+            }
+        });
+    }
+
+    void RunAtlas(Harness& harness)
+    {
+        // Glyph and icon sized images, the page stays around half full while entries come and go
+        constexpr size_t live { 512 };
+        const std::vector<unsigned char> pixels(64 * 64 * 4, 0xFF);
+        std::minstd_rand random { 1 };
+        std::uniform_int_distribution<int> sizes { 8, 64 };
+
+        TextureAtlas::Settings settings;
+        settings.pageSize = 1024;
+        TextureAtlas atlas { settings };
+        std::vector<TextureAtlas::Handle> handles;
+        for (size_t i = 0; i < live; i++)
+        {
+            handles.push_back(atlas.Insert(pixels.data(), sizes(random), sizes(random)));
+        }
+        const size_t filledPages = atlas.GetPageCount();
+
+        uint64_t failed { 0 };
+        auto churn = [&](uint64_t iterations)
+        {
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                const size_t slot = random() % live;
+                atlas.Remove(handles[slot]);
+                handles[slot] = atlas.Insert(pixels.data(), sizes(random), sizes(random));
+                failed += handles[slot] == TextureAtlas::InvalidHandle;
+            }
+        };
+
+        // Fragments take thousands of replacements to pile up, more than a short timed run does
+        churn(16 * live);
+
+        harness.Run("TextureAtlas/churn/" + std::to_string(live), 1, [&](uint64_t iterations)
+        {
+            churn(iterations);
+            harness.Check(failed == 0 && atlas.GetCount() == live, "TextureAtlas/churn lost entries");
+
+            // Freed space has to merge back, otherwise fragments push new images onto new pages
+            harness.Check(atlas.GetPageCount() <= filledPages, "TextureAtlas/churn opened " + std::to_string(atlas.GetPageCount()) + " pages, filled " + std::to_string(filledPages));
+        });
+    }
+
+    void RunFiles(Harness& harness)
+    {
+        const std::filesystem::path directory = std::filesystem::temp_directory_path() / "grafik-bench";
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+
+        for (const size_t size : { 4 * 1024, 256 * 1024, 4 * 1024 * 1024 })
+        {
+            const std::filesystem::path path = directory / ("file-" + std::to_string(size) + ".bin");
+            {
+                std::ofstream out(path, std::ios::binary | std::ios::trunc);
+                const std::string data(size, 'g');
+                out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            }
+
+            const File file { path.string() };
+            harness.Run("File::Read/" + std::to_string(size), size, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    auto contents = file.Read();
+                    DoNotOptimize(contents);
+                }
+            });
+            harness.Run("File::Load/" + std::to_string(size), size, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    auto contents = file.Load();
+                    DoNotOptimize(contents);
+                }
+            });
+        }
+
+        // A batch like a lab's textures and shaders, each file filled with its own byte so order shows
+        constexpr size_t batchFiles { 16 };
+        constexpr size_t batchSize { 256 * 1024 };
+        std::vector<std::string> paths;
+        for (size_t i = 0; i < batchFiles; i++)
+        {
+            const std::filesystem::path path = directory / ("batch-" + std::to_string(i) + ".bin");
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            const std::string data(batchSize, static_cast<char>('a' + i));
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            paths.push_back(path.string());
+        }
+
+        for (const auto& [mode, name] : { std::pair { File::Mode::Read, "read" }, std::pair { File::Mode::Map, "map" } })
+        {
+            harness.Run("File::ReadMany/" + std::string { name } + "/" + std::to_string(batchFiles), batchFiles * batchSize, [&](uint64_t iterations)
+            {
+                bool bPassed { true };
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    auto buffers = File::ReadMany(paths, mode);
+                    for (size_t n = 0; n < batchFiles; n++)
+                    {
+                        const auto& buffer = buffers[n];
+                        bPassed &= buffer && buffer->GetSize() == batchSize && buffer->IsMapped() == (mode == File::Mode::Map)
+                            && buffer->GetData()[0] == static_cast<char>('a' + n) && buffer->GetData()[batchSize - 1] == static_cast<char>('a' + n);
+                    }
+                    DoNotOptimize(buffers);
+                }
+                harness.Check(bPassed, "File::ReadMany/" + std::string { name } + " returned wrong contents");
+            });
+        }
+        std::filesystem::remove_all(directory, error);
+    }
+
+    void RunJobs(Harness& harness)
+    {
+        // A single core gets no workers, start one so the deques and stealing are what's timed
+        const bool bStarted = !JobSystem::IsRunning();
+        if (bStarted)
+        {
+            JobSystem::Init(1);
+        }
+
+        harness.Run("JobSystem::Run/empty", 1, [](uint64_t iterations)
+        {
+            JobCounter counter;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                JobSystem::Run([] { }, &counter);
+                if ((i & 255) == 255)
+                {
+                    JobSystem::Wait(counter);
+                }
+            }
+            JobSystem::Wait(counter);
+        });
+
+        for (const uint32_t jobs : { 64u, 1024u, 10000u })
+        {
+            // 10000 is past the 4096 jobs a thread may have queued, the rest must run inline
+            harness.Run("JobSystem::Run/fanout/" + std::to_string(jobs), jobs, [&](uint64_t iterations)
+            {
+                std::atomic<uint64_t> done { 0 };
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    JobCounter counter;
+                    for (uint32_t job = 0; job < jobs; job++)
+                    {
+                        JobSystem::Run([&done] { done.fetch_add(1, std::memory_order_relaxed); }, &counter);
+                    }
+                    JobSystem::Wait(counter);
+                }
+                harness.Check(done.load() == iterations * jobs, "JobSystem::Run/fanout/" + std::to_string(jobs) + " lost jobs");
+            });
+        }
+
+        constexpr size_t count { 1 << 20 };
+        std::vector<float> values(count, 1.0f);
+        for (const size_t grain : { size_t { 0 }, size_t { 256 }, size_t { 4096 }, size_t { 65536 } })
+        {
+            harness.Run("JobSystem::ParallelFor/grain/" + (grain ? std::to_string(grain) : std::string { "auto" }), count, [&](uint64_t iterations)
+            {
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    JobSystem::ParallelFor(count, [&](size_t begin, size_t end)
+                    {
+                        for (size_t n = begin; n < end; n++)
+                        {
+                            values[n] = values[n] * 0.5f + 0.5f;
+                        }
+                    }, grain);
+                }
+                DoNotOptimize(values);
+            });
+        }
+
+        // Diamond per frame like a lab update: one root, a wide middle, one join
+        constexpr uint32_t width { 32 };
+        std::atomic<uint64_t> ran { 0 };
+        TaskGraph graph;
+        const TaskGraph::TaskId root = graph.Add("root", [&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+        const TaskGraph::TaskId join = static_cast<TaskGraph::TaskId>(width + 1);
+        for (uint32_t i = 0; i < width; i++)
+        {
+            graph.Add("middle", [&ran] { ran.fetch_add(1, std::memory_order_relaxed); }, { root });
+        }
+        graph.Add("join", [&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+        for (TaskGraph::TaskId i = 1; i < join; i++)
+        {
+            graph.AddDependency(join, i);
+        }
+
+        harness.Run("TaskGraph::Run/diamond/" + std::to_string(width), graph.GetCount(), [&](uint64_t iterations)
+        {
+            ran = 0;
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                graph.Run();
+            }
+            harness.Check(ran.load() == iterations * graph.GetCount(), "TaskGraph::Run/diamond lost tasks");
+        });
+
+        if (bStarted)
+        {
+            // Jobs still queued at shutdown run, a counter left pending would hang whoever waits on it
+            constexpr uint32_t queued { 1024 };
+            std::atomic<uint32_t> done { 0 };
+            JobCounter counter;
+            for (uint32_t job = 0; job < queued; job++)
+            {
+                JobSystem::Run([&done] { done.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            JobSystem::Shutdown();
+            harness.Check(counter.IsDone() && done.load() == queued, "JobSystem::Shutdown dropped queued jobs");
+        }
+    }
+}
@@ -0,0 +1,25 @@
+﻿/**
+ * Grafik
+ * Benchmarks
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+
+namespace bench
+{
+    class Harness;
+
+    // Lab geometry: quad grids, quad indices, the loop cylinder and vertex layouts
+    void RunGeometry(Harness& harness);
+    // Broadcast to growing numbers of listeners
+    void RunEvents(Harness& harness);
+    // Uniform location lookups and uploads, needs the GL stub
+    void RunShader(Harness& harness);
+    // Atlas inserts and removes in a steady churn, needs the GL stub
+    void RunAtlas(Harness& harness);
+    // Reading and mapping files of a few sizes
+    void RunFiles(Harness& harness);
+    // Job submission, fan-out, ParallelFor grains and task graphs
+    void RunJobs(Harness& harness);
+}
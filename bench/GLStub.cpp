@@ -0,0 +1,108 @@
+﻿/**
+ * Grafik
+ * GL Stub
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "GLStub.h"
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+
+namespace bench
+{
+    namespace
+    {
+        GLuint nextName { 1 };
+
+        GLuint APIENTRY CreateObject() { return nextName++; }
+        GLuint APIENTRY CreateShader(GLenum) { return nextName++; }
+        void APIENTRY IgnoreObject(GLuint) { }
+        void APIENTRY ShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) { }
+        void APIENTRY AttachShader(GLuint, GLuint) { }
+        void APIENTRY GetStatus(GLuint, GLenum, GLint* params) { *params = GL_TRUE; }
+
+        // Every program links with the uniforms the shader benchmarks look up
+        constexpr std::string_view activeUniforms[] { "u_MVP", "u_Textures[0]", "u_Color", "u_TexId" };
+
+        void APIENTRY GetProgramiv(GLuint, GLenum name, GLint* params)
+        {
+            switch (name)
+            {
+                case GL_ACTIVE_UNIFORMS:            *params = static_cast<GLint>(std::size(activeUniforms)); break;
+                case GL_ACTIVE_UNIFORM_MAX_LENGTH:  *params = 16; break;
+                default:                            *params = GL_TRUE; break;
+            }
+        }
+
+        void APIENTRY GetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+        {
+            const std::string_view uniform = activeUniforms[index];
+            *length = static_cast<GLsizei>(std::min<size_t>(uniform.size(), static_cast<size_t>(bufSize) - 1));
+            std::memcpy(name, uniform.data(), static_cast<size_t>(*length));
+            name[*length] = '\0';
+            *size = 1;
+            *type = GL_FLOAT;
+        }
+
+        // Stable per name like a real program, without touching the driver
+        GLint APIENTRY GetUniformLocation(GLuint, const GLchar* name)
+        {
+            return static_cast<GLint>(std::hash<std::string_view> { }(name) & 0xFFFF);
+        }
+
+        void APIENTRY Uniform1i(GLint, GLint) { }
+        void APIENTRY Uniform1iv(GLint, GLsizei, const GLint*) { }
+        void APIENTRY Uniform1f(GLint, GLfloat) { }
+        void APIENTRY Uniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { }
+        void APIENTRY UniformNfv(GLint, GLsizei, const GLfloat*) { }
+        void APIENTRY UniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { }
+
+        void APIENTRY CreateNames(GLsizei count, GLuint* names) { for (GLsizei i = 0; i < count; i++) names[i] = nextName++; }
+        void APIENTRY CreateTextures(GLenum, GLsizei count, GLuint* names) { CreateNames(count, names); }
+        void APIENTRY DeleteNames(GLsizei, const GLuint*) { }
+        void APIENTRY TextureStorage2D(GLuint, GLsizei, GLenum, GLsizei, GLsizei) { }
+        void APIENTRY TextureSubImage2D(GLuint, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*) { }
+        void APIENTRY SamplerParameteri(GLuint, GLenum, GLint) { }
+        void APIENTRY BindUnit(GLuint, GLuint) { }
+    }
+
+    void InstallGLStub()
+    {
+        glad_glCreateProgram = CreateObject;
+        glad_glCreateShader = CreateShader;
+        glad_glDeleteProgram = IgnoreObject;
+        glad_glDeleteShader = IgnoreObject;
+        glad_glUseProgram = IgnoreObject;
+        glad_glShaderSource = ShaderSource;
+        glad_glCompileShader = IgnoreObject;
+        glad_glAttachShader = AttachShader;
+        glad_glLinkProgram = IgnoreObject;
+        glad_glValidateProgram = IgnoreObject;
+        glad_glGetShaderiv = GetStatus;
+        glad_glGetProgramiv = GetProgramiv;
+        glad_glGetActiveUniform = GetActiveUniform;
+
+        glad_glGetUniformLocation = GetUniformLocation;
+        glad_glUniform1i = Uniform1i;
+        glad_glUniform1iv = Uniform1iv;
+        glad_glUniform1f = Uniform1f;
+        glad_glUniform4f = Uniform4f;
+        glad_glUniform3fv = UniformNfv;
+        glad_glUniform4fv = UniformNfv;
+        glad_glUniformMatrix4fv = UniformMatrix4fv;
+
+        glad_glCreateTextures = CreateTextures;
+        glad_glDeleteTextures = DeleteNames;
+        glad_glTextureStorage2D = TextureStorage2D;
+        glad_glTextureSubImage2D = TextureSubImage2D;
+        glad_glGenerateTextureMipmap = IgnoreObject;
+        glad_glBindTextureUnit = BindUnit;
+        glad_glCreateSamplers = CreateNames;
+        glad_glDeleteSamplers = DeleteNames;
+        glad_glSamplerParameteri = SamplerParameteri;
+        glad_glBindSampler = BindUnit;
+    }
+}
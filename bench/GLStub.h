@@ -0,0 +1,14 @@
+﻿/**
+ * Grafik
+ * GL Stub
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+
+namespace bench
+{
+    // Points the GL entry points used by shaders, uniforms and textures at no-op stubs, so those paths
+    // run without a context. Shader compilation and linking always succeed.
+    void InstallGLStub();
+}
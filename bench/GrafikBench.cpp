@@ -0,0 +1,31 @@
+﻿/**
+ * Grafik
+ * GrafikBench
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Benchmarks.h"
+#include "GLStub.h"
+#include "Harness.h"
+#include "core/JobSystem.h"
+
+
+int main(const int argc, char** argv)
+{
+    Log::Init(Log::Level::Warn);
+    JobSystem::Init();
+    bench::InstallGLStub();
+
+    bench::Harness harness { argc, argv };
+    bench::RunGeometry(harness);
+    bench::RunEvents(harness);
+    bench::RunShader(harness);
+    bench::RunAtlas(harness);
+    bench::RunFiles(harness);
+    bench::RunJobs(harness);
+
+    JobSystem::Shutdown();
+    const int result = harness.Finish();
+    Log::Shutdown();
+    return result;
+}
@@ -0,0 +1,146 @@
+﻿/**
+ * Grafik
+ * Bench Harness
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Harness.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+
+namespace bench
+{
+    namespace
+    {
+        constexpr int sampleCount { 5 };
+
+        double TimeIterations(FunctionRef<void(uint64_t)> body, uint64_t iterations)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            const auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    }
+
+    Harness::Harness(int argc, char** argv)
+    {
+        for (int i = 1; i < argc - 1; i++)
+        {
+            if (strcmp(argv[i], "-filter") == 0)        _filter = argv[i+1];
+            if (strcmp(argv[i], "-out") == 0)           _output = argv[i+1];
+            if (strcmp(argv[i], "-baseline") == 0)      _baseline = argv[i+1];
+            if (strcmp(argv[i], "-tolerance") == 0)     _tolerance = std::max(0.0, atof(argv[i+1]));
+            if (strcmp(argv[i], "-mintime") == 0)       _minTime = std::max(1.0, atof(argv[i+1]));
+        }
+
+        std::printf("%-40s %14s %14s %16s\n", "Benchmark", "Iterations", "ns/iter", "items/s");
+    }
+
+    void Harness::Run(const std::string& name, uint64_t items, FunctionRef<void(uint64_t)> body)
+    {
+        if (!_filter.empty() && name.find(_filter) == std::string::npos) return;
+
+        // Grow the count until one sample is long enough to time reliably
+        const double sampleTime = _minTime / sampleCount;
+        uint64_t iterations { 1 };
+        double elapsed = TimeIterations(body, iterations);
+        while (elapsed < sampleTime && iterations < (1ull << 40))
+        {
+            const double scale = elapsed > 0.0 ? std::clamp(sampleTime / elapsed * 1.2, 2.0, 100.0) : 100.0;
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * scale);
+            elapsed = TimeIterations(body, iterations);
+        }
+
+        std::array<double, sampleCount> samples { };
+        samples[0] = elapsed;
+        for (int i = 1; i < sampleCount; i++)
+        {
+            samples[i] = TimeIterations(body, iterations);
+        }
+        std::ranges::sort(samples);
+
+        Result result { name, iterations };
+        result.nsPerIteration = samples[sampleCount / 2] * 1e6 / static_cast<double>(iterations);
+        result.itemsPerSecond = static_cast<double>(items) * 1e9 / result.nsPerIteration;
+
+        std::printf("%-40s %14llu %14.1f %16.4g\n", name.c_str(), static_cast<unsigned long long>(iterations),
+            result.nsPerIteration, result.itemsPerSecond);
+        _results.push_back(std::move(result));
+    }
+
+    void Harness::Check(bool bCondition, const std::string& message)
+    {
+        if (bCondition) return;
+
+        std::fprintf(stderr, "Check failed: %s\n", message.c_str());
+        _failedChecks++;
+    }
+
+    int Harness::Finish() const
+    {
+        if (!_output.empty() && !WriteResults())
+        {
+            std::fprintf(stderr, "Unable to write %s\n", _output.c_str());
+            return EXIT_FAILURE;
+        }
+        if (!_baseline.empty() && !CompareBaseline())
+        {
+            return EXIT_FAILURE;
+        }
+        return _failedChecks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    bool Harness::WriteResults() const
+    {
+        std::ofstream out(_output, std::ios::trunc);
+        if (!out) return false;
+
+        out << "name,iterations,ns_per_iteration,items_per_second\n";
+        for (const Result& result : _results)
+        {
+            out << result.name << ',' << result.iterations << ',' << result.nsPerIteration << ',' << result.itemsPerSecond << '\n';
+        }
+        out.close();
+        return static_cast<bool>(out);
+    }
+
+    bool Harness::CompareBaseline() const
+    {
+        std::ifstream in(_baseline);
+        if (!in)
+        {
+            std::fprintf(stderr, "Unable to read baseline %s\n", _baseline.c_str());
+            return false;
+        }
+
+        bool bPassed { true };
+        std::string line;
+        std::getline(in, line);     // header
+        while (std::getline(in, line))
+        {
+            // name,iterations,ns_per_iteration,...
+            const size_t nameEnd = line.find(',');
+            const size_t iterationsEnd = line.find(',', nameEnd + 1);
+            if (nameEnd == std::string::npos || iterationsEnd == std::string::npos) continue;
+
+            const std::string name = line.substr(0, nameEnd);
+            const double baseline = atof(line.c_str() + iterationsEnd + 1);
+
+            const auto result = std::ranges::find(_results, name, &Result::name);
+            if (result == _results.end() || baseline <= 0.0) continue;
+
+            const double change = (result->nsPerIteration / baseline - 1.0) * 100.0;
+            if (change > _tolerance)
+            {
+                std::fprintf(stderr, "Regression: %s %.1f ns -> %.1f ns (+%.1f%%)\n", name.c_str(), baseline, result->nsPerIteration, change);
+                bPassed = false;
+            }
+        }
+        return bPassed;
+    }
+}
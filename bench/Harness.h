@@ -0,0 +1,67 @@
+﻿/**
+ * Grafik
+ * Bench Harness
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "core/Function.h"
+
+#include <atomic>
+
+
+namespace bench
+{
+    // Keeps the compiler from optimizing away a result or the work that produced it
+    template <typename T>
+    void DoNotOptimize(T& value)
+    {
+#   ifdef _MSC_VER
+        static const void* volatile sink;
+        sink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#   else
+        asm volatile("" : : "r"(&value) : "memory");
+#   endif
+    }
+
+    /**
+     * Minimal microbenchmark runner. Each case gets an iteration count to loop over, the count grows
+     * until a sample takes long enough to time, and the median of several samples is reported.
+     * Results can be written as CSV and compared against an earlier run to fail on regressions.
+     */
+    class Harness
+    {
+    public:
+        struct Result
+        {
+            std::string name { };
+            uint64_t iterations { 0 };      // per sample
+            double nsPerIteration { 0.0 };
+            double itemsPerSecond { 0.0 };
+        };
+
+        // -filter <text> -out <csv> -baseline <csv> -tolerance <percent> -mintime <ms>
+        Harness(int argc, char** argv);
+
+        // items is the work done per iteration, for throughput
+        void Run(const std::string& name, uint64_t items, FunctionRef<void(uint64_t iterations)> body);
+
+        // For cases that also check their results, a failed check fails the run
+        void Check(bool bCondition, const std::string& message);
+
+        // Writes and compares the results, returns the process exit code
+        [[nodiscard]] int Finish() const;
+
+    private:
+        [[nodiscard]] bool WriteResults() const;
+        [[nodiscard]] bool CompareBaseline() const;
+
+        std::string _filter { };
+        std::string _output { };
+        std::string _baseline { };
+        double _tolerance { 10.0 };     // percent slower than the baseline before failing
+        double _minTime { 100.0 };      // ms per case
+        std::vector<Result> _results { };
+        uint32_t _failedChecks { 0 };
+    };
+}
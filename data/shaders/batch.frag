@@ -6,11 +6,19 @@ in vec2 v_TexCoord;
 flat in float v_TexId;
 in vec4 v_Color;
 
-uniform sampler2D u_Textures[3];
+uniform sampler2D u_Textures[4];
 
 void main()
 {
     int texId = int(v_TexId);
-    vec4 texColor = texture(u_Textures[texId], v_TexCoord);
+    // GLSL 3.30 only allows constant sampler array indices
+    vec4 texColor;
+    switch (texId)
+    {
+        case 0: texColor = texture(u_Textures[0], v_TexCoord); break;
+        case 1: texColor = texture(u_Textures[1], v_TexCoord); break;
+        case 2: texColor = texture(u_Textures[2], v_TexCoord); break;
+        default: texColor = texture(u_Textures[3], v_TexCoord); break;
+    }
     color = v_Color * texColor;
 }
\ No newline at end of file
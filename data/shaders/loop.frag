@@ -16,6 +16,13 @@ void main()
     vec2 UVs = v_TexCoord;
     if (gl_FrontFacing)
         UVs =  vec2(1 - v_TexCoord.x, v_TexCoord.y);
-    vec4 texColor = texture(u_Textures[u_TexId], UVs);
+    // GLSL 3.30 only allows constant sampler array indices
+    vec4 texColor;
+    switch (u_TexId)
+    {
+        case 0: texColor = texture(u_Textures[0], UVs); break;
+        case 1: texColor = texture(u_Textures[1], UVs); break;
+        default: texColor = texture(u_Textures[2], UVs); break;
+    }
     color = v_Color * u_Color * texColor;
 }
\ No newline at end of file
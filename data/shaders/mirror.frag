@@ -13,7 +13,13 @@ uniform float u_ReflectDarken;
 void main()
 {
     int texId = int(v_TexId);
-    vec4 texColor = texture(u_Textures[texId], v_TexCoord);
+    // GLSL 3.30 only allows constant sampler array indices
+    vec4 texColor;
+    switch (texId)
+    {
+        case 0: texColor = texture(u_Textures[0], v_TexCoord); break;
+        default: texColor = texture(u_Textures[1], v_TexCoord); break;
+    }
     vec4 mirror = vec4(u_ReflectDarken, u_ReflectDarken, u_ReflectDarken, 1.0f);
     color = mix(vec4(v_Color, 1.0f), texColor, u_ColorAlpha) * mirror;
     if (u_ReflectDarken < 1)
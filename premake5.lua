@@ -25,7 +25,8 @@ group "Dependencies"
     include "include/imgui.lua"
 group ""
 
-project "Grafik"
+-- Settings shared by the application and the benchmarks, which build the same sources
+function grafik_project()
     location ""
     kind "ConsoleApp"
     language "C++"
@@ -47,8 +48,6 @@ project "Grafik"
         "src/**.h",
         "src/**.cpp",
 
-        "data/**",
-
         "include/stb/**.h",
         "include/stb/**.cpp",
     }
@@ -75,7 +74,6 @@ project "Grafik"
 
     links
     {
-        "vulkan-1.lib",
         "glad",
         "glfw",
         "imgui",
@@ -93,7 +91,20 @@ project "Grafik"
         systemversion "latest"
         links
         {
-            "opengl32"
+            "vulkan-1.lib",
+            "opengl32",
+            "winmm"
+        }
+
+    -- Headless contexts go through EGL, GLFW needs the rest
+    filter "system:linux"
+        links
+        {
+            "EGL",
+            "X11",
+            "pthread",
+            "dl",
+            "m"
         }
     
     filter "configurations:Debug"
@@ -113,8 +124,39 @@ project "Grafik"
 
     filter "configurations:Release"
         defines "_CONSOLE"
+
+    filter { }
+end
+
+project "Grafik"
+    grafik_project()
+
+    files
+    {
+        "data/**",
+    }
         
     filter "configurations:Dist"
         kind "WindowedApp"
         symbols "off"
         defines "GK_DISTR"
+
+-- CPU microbenchmarks, GL entry points are stubbed so no context is needed
+project "GrafikBench"
+    grafik_project()
+
+    files
+    {
+        "bench/**.h",
+        "bench/**.cpp",
+    }
+    removefiles "src/Grafik.cpp"
+
+    includedirs
+    {
+        "bench",
+    }
+
+    filter "configurations:Dist"
+        symbols "off"
+        defines "GK_DISTR"
@@ -6,24 +6,59 @@
 #include "gpch.h"
 #include "DataTexture.h"
 
+#include "renderer/RenderStats.h"
+
 #include <glad/glad.h>
 
 
-DataTexture::DataTexture(bool isWhite)
+DataTexture::DataTexture(bool isWhite, const SamplerState& sampler)
 {
-    glGenTextures(1, &_id);
-    glBindTexture(GL_TEXTURE_2D, _id);
+    GK_PROFILE_FUNCTION();
 
-    // Set texture parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    _width = _height = 1;
+    _levels = 1;
+    _memoryType = GpuMemory::Resource::DataTexture;
+    
+    glCreateTextures(GL_TEXTURE_2D, 1, &_id);
+    glTextureStorage2D(_id, _levels, GL_RGBA8, _width, _height);
+    GpuMemory::Allocate(_memoryType, GetChainBytes(0));
 
     const unsigned color { isWhite ? 0xFFFFFFFF : 0x00000000 };
     
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &color);
+    glTextureSubImage2D(_id, 0, 0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, &color);
+    RenderStats::Get().textureBytes += sizeof(color);
 
+    _sampler = SamplerCache::Get(sampler);
     _loaded = true;
-    Unbind();
+}
+
+DataTexture::DataTexture(int width, int height, int levels, const SamplerState& sampler)
+{
+    GK_PROFILE_FUNCTION();
+
+    _width = width;
+    _height = height;
+    _levels = std::clamp(levels, 1, GetMipLevels(width, height));
+    _memoryType = GpuMemory::Resource::DataTexture;
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &_id);
+    glTextureStorage2D(_id, _levels, GL_RGBA8, _width, _height);
+    GpuMemory::Allocate(_memoryType, GetChainBytes(0));
+
+    _sampler = SamplerCache::Get(sampler);
+    _loaded = true;
+}
+
+void DataTexture::SetData(int x, int y, int width, int height, const void* pixels, int level) const
+{
+    glTextureSubImage2D(_id, level, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    RenderStats::Get().textureBytes += static_cast<uint64_t>(width) * static_cast<uint64_t>(height) * 4;
+}
+
+void DataTexture::GenerateMipmaps() const
+{
+    if (_levels > 1)
+    {
+        glGenerateTextureMipmap(_id);
+    }
 }
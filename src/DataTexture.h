@@ -9,6 +9,10 @@
 class DataTexture : public Texture
 {
 public:
-    DataTexture(bool isWhite);
- 
+    DataTexture(bool isWhite, const SamplerState& sampler = { SamplerState::Filter::Linear });
+    DataTexture(int width, int height, int levels = 1, const SamplerState& sampler = { });
+
+    // Upload RGBA8 pixels into a region of the given level
+    void SetData(int x, int y, int width, int height, const void* pixels, int level = 0) const;
+    void GenerateMipmaps() const;
 };
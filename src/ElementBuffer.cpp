@@ -6,20 +6,28 @@
 #include "gpch.h"
 #include "ElementBuffer.h"
 
+#include "renderer/GpuMemory.h"
+#include "renderer/RenderStats.h"
+
 #include <glad/glad.h>
 
 
 ElementBuffer::ElementBuffer(const unsigned* data, int count)
     : _count { count }
 {
+    GK_PROFILE_FUNCTION();
+
     glGenBuffers(1, &_id);
     Bind();
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * static_cast<signed long long>(sizeof(unsigned)), data, GL_STATIC_DRAW);
+    RenderStats::Get().bufferBytes += static_cast<uint64_t>(count) * sizeof(unsigned);
+    GpuMemory::Allocate(GpuMemory::Resource::ElementBuffer, static_cast<size_t>(count) * sizeof(unsigned));
 }
 
 ElementBuffer::~ElementBuffer()
 {
     glDeleteBuffers(1, &_id);
+    GpuMemory::Free(GpuMemory::Resource::ElementBuffer, static_cast<size_t>(_count) * sizeof(unsigned));
 }
 
 void ElementBuffer::Bind() const
@@ -0,0 +1,57 @@
+﻿/**
+ * Grafik
+ * Framebuffer
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "Framebuffer.h"
+
+#include <glad/glad.h>
+
+
+Framebuffer::Framebuffer(int width, int height)
+    : _width { width }, _height { height }
+{
+    GK_PROFILE_FUNCTION();
+
+    glCreateTextures(GL_TEXTURE_2D, 1, &_color);
+    glTextureStorage2D(_color, 1, GL_RGBA8, _width, _height);
+
+    glCreateRenderbuffers(1, &_depthStencil);
+    glNamedRenderbufferStorage(_depthStencil, GL_DEPTH24_STENCIL8, _width, _height);
+
+    glCreateFramebuffers(1, &_id);
+    glNamedFramebufferTexture(_id, GL_COLOR_ATTACHMENT0, _color, 0);
+    glNamedFramebufferRenderbuffer(_id, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthStencil);
+
+    if (glCheckNamedFramebufferStatus(_id, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        throw std::runtime_error("Framebuffer is incomplete!");
+    }
+}
+
+Framebuffer::~Framebuffer()
+{
+    glDeleteFramebuffers(1, &_id);
+    glDeleteRenderbuffers(1, &_depthStencil);
+    glDeleteTextures(1, &_color);
+}
+
+void Framebuffer::Bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, _id);
+    glViewport(0, 0, _width, _height);
+}
+
+void Framebuffer::Unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+std::vector<unsigned char> Framebuffer::ReadPixels() const
+{
+    std::vector<unsigned char> pixels(static_cast<size_t>(_width) * static_cast<size_t>(_height) * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glGetTextureImage(_color, 0, GL_RGBA, GL_UNSIGNED_BYTE, static_cast<GLsizei>(pixels.size()), pixels.data());
+    return pixels;
+}
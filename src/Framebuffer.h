@@ -0,0 +1,39 @@
+﻿/**
+ * Grafik
+ * Framebuffer
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+
+
+/**
+ * Offscreen render target with an RGBA8 color texture and a combined depth/stencil buffer.
+ */
+class Framebuffer
+{
+private:
+    unsigned _id { 0 };
+    unsigned _color { 0 };
+    unsigned _depthStencil { 0 };
+    int _width { 0 };
+    int _height { 0 };
+
+public:
+    Framebuffer(int width, int height);
+    ~Framebuffer();
+
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+
+    unsigned GetId() const { return _id; }
+    unsigned GetColorTexture() const { return _color; }
+    int GetWidth() const { return _width; }
+    int GetHeight() const { return _height; }
+
+    // Render into this target, also sets the viewport to cover it
+    void Bind() const;
+    static void Unbind();
+
+    // RGBA8 color, bottom row first. Waits for rendering to finish
+    std::vector<unsigned char> ReadPixels() const;
+};
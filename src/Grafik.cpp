@@ -5,11 +5,13 @@
  */
 #include "gpch.h"
 #include "core/Application.h"
+#include "core/JobSystem.h"
 
 
 int grafik(const int argc, char** argv)
 {
     Grafik::Init();
+    JobSystem::Init();
 
     while (!Grafik::ShouldExit)
     {
@@ -22,19 +24,25 @@ int grafik(const int argc, char** argv)
             .height  = Grafik::WindowHeight,
             .args    = { argc, argv }, 
         };
-        const auto app = std::make_unique<Application>(config);
-
+        // The app goes before the job system, its destructors may still wait on jobs
         try
         {
+            const auto app = std::make_unique<Application>(config);
             app->Init();
             app->Run();
         }
         catch (const std::runtime_error& ex)
         {
-            std::cerr << "Error: " << ex.what() << std::endl;
+            // Release builds have no logging, the reason to exit is always shown
+            JobSystem::Shutdown();
+            Grafik::Shutdown();
+            std::cerr << "Error: " << ex.what() << '\n';
             return EXIT_FAILURE;
         }
     }
+
+    JobSystem::Shutdown();
+    Grafik::Shutdown();
     return EXIT_SUCCESS;
 }
 
@@ -13,6 +13,8 @@
 Pipeline::Pipeline(const std::string& vertexFile, const std::string& fragmentFile)
     : _vertexFilePath { vertexFile }, _fragmentFilePath { fragmentFile }
 {
+    GK_PROFILE_FUNCTION();
+
     _shaderName = ExtractName(vertexFile);
     
     // Read vertex shader from file as binary
@@ -25,12 +27,11 @@ Pipeline::Pipeline(const std::string& vertexFile, const std::string& fragmentFil
 
     if (!vertexSource || !fragmentSource)
     {
-        std::cout << "Error: Failed loading source for shader '" << _shaderName << "'." << std::endl;
+        Log::Error("Pipeline: Failed loading source for shader '{}'", _shaderName);
         return;
     }
 
-    std::cout << "Size vertex: " << vertexSource->size() << std::endl;
-    std::cout << "Size fragment: " << fragmentSource->size() << std::endl;
+    Log::Debug("Pipeline: Vertex {} bytes, fragment {} bytes", vertexSource->size(), fragmentSource->size());
 
     // *vertexSource, *fragmentSource
 }
@@ -0,0 +1,74 @@
+﻿/**
+ * Grafik
+ * Sampler
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "Sampler.h"
+
+#include <glad/glad.h>
+
+#include <ranges>
+
+
+namespace
+{
+    int ToGL(const SamplerState::Filter filter)
+    {
+        switch (filter)
+        {
+            case SamplerState::Filter::Nearest:                 return GL_NEAREST;
+            case SamplerState::Filter::Linear:                  return GL_LINEAR;
+            case SamplerState::Filter::NearestMipmapNearest:    return GL_NEAREST_MIPMAP_NEAREST;
+            case SamplerState::Filter::LinearMipmapNearest:     return GL_LINEAR_MIPMAP_NEAREST;
+            case SamplerState::Filter::NearestMipmapLinear:     return GL_NEAREST_MIPMAP_LINEAR;
+            case SamplerState::Filter::LinearMipmapLinear:      return GL_LINEAR_MIPMAP_LINEAR;
+        }
+        return GL_LINEAR;
+    }
+
+    int ToGL(const SamplerState::Wrap wrap)
+    {
+        switch (wrap)
+        {
+            case SamplerState::Wrap::Repeat:                    return GL_REPEAT;
+            case SamplerState::Wrap::MirroredRepeat:            return GL_MIRRORED_REPEAT;
+            case SamplerState::Wrap::ClampToEdge:               return GL_CLAMP_TO_EDGE;
+            case SamplerState::Wrap::ClampToBorder:             return GL_CLAMP_TO_BORDER;
+        }
+        return GL_REPEAT;
+    }
+}
+
+unsigned SamplerCache::Get(const SamplerState& state)
+{
+    const unsigned key = state.GetKey();
+    if (const auto match = _samplers.find(key); match != _samplers.end())
+    {
+        return match->second;
+    }
+
+    unsigned sampler { 0 };
+    glCreateSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, ToGL(state.minFilter));
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, ToGL(state.magFilter));
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, ToGL(state.wrapS));
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, ToGL(state.wrapT));
+
+    _samplers.emplace(key, sampler);
+    return sampler;
+}
+
+void SamplerCache::Bind(unsigned unit, unsigned sampler)
+{
+    glBindSampler(unit, sampler);
+}
+
+void SamplerCache::Clear()
+{
+    for (const unsigned sampler : _samplers | std::views::values)
+    {
+        glDeleteSamplers(1, &sampler);
+    }
+    _samplers.clear();
+}
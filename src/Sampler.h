@@ -0,0 +1,59 @@
+﻿/**
+ * Grafik
+ * Sampler
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+
+
+struct SamplerState
+{
+    enum class Filter : unsigned char
+    {
+        Nearest,
+        Linear,
+        NearestMipmapNearest,
+        LinearMipmapNearest,
+        NearestMipmapLinear,
+        LinearMipmapLinear
+    };
+
+    enum class Wrap : unsigned char
+    {
+        Repeat,
+        MirroredRepeat,
+        ClampToEdge,
+        ClampToBorder
+    };
+
+    Filter minFilter { Filter::LinearMipmapLinear };
+    Filter magFilter { Filter::Linear };
+    Wrap wrapS { Wrap::Repeat };
+    Wrap wrapT { Wrap::Repeat };
+
+    bool operator==(const SamplerState&) const = default;
+
+    [[nodiscard]] unsigned GetKey() const
+    {
+        return static_cast<unsigned>(minFilter) | static_cast<unsigned>(magFilter) << 8
+            | static_cast<unsigned>(wrapS) << 16 | static_cast<unsigned>(wrapT) << 24;
+    }
+};
+
+/**
+ * Deduplicated sampler objects, shared by every texture using the same state.
+ * Samplers live until Clear() is called while the owning context is still current.
+ */
+class SamplerCache
+{
+public:
+    [[nodiscard]] static unsigned Get(const SamplerState& state);
+
+    static void Bind(unsigned unit, unsigned sampler);
+    static void Clear();
+
+    [[nodiscard]] static size_t GetCount() { return _samplers.size(); }
+
+private:
+    inline static std::unordered_map<unsigned, unsigned> _samplers { };
+};
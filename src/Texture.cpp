@@ -5,62 +5,202 @@
  */
 #include "gpch.h"
 #include "Texture.h"
+#include "TextureStreamer.h"
+#include "core/JobSystem.h"
+#include "utils/Image.h"
+#include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
 
 #include <glad/glad.h>
 
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_FAILURE_USERMSG
-#include <stb/stb_image.h>
+#include <algorithm>
+#include <bit>
 
 
-Texture::Texture(const std::string& filePath) : _filePath { filePath }
+struct Texture::PendingLoad
 {
-    // Load texture from image file
-    stbi_set_flip_vertically_on_load(1);
-    _localBuffer = stbi_load(filePath.c_str(), &_width, &_height, &_bpp, 4);
-    
-    if (_localBuffer)
+    JobCounter counter { };
+    std::optional<Image> image { };
+};
+
+namespace
+{
+    // Recorded while the render thread is active, loading and streaming state stay on the render thread
+    struct BindTextureCommand
+    {
+        Texture* texture;
+        unsigned unit;
+        void Execute() const { texture->Bind(unit); }
+    };
+
+    struct RequestScreenSizeCommand
     {
-        glGenTextures(1, &_id);
-        glBindTexture(GL_TEXTURE_2D, _id);
+        const Texture* texture;
+        float pixels;
+        void Execute() const { texture->RequestScreenSize(pixels); }
+    };
+}
 
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+Texture::Texture() = default;
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, _localBuffer);
-        glGenerateMipmap(GL_TEXTURE_2D);
+Texture::Texture(const std::string& filePath, const SamplerState& sampler, bool bStreamed)
+    : _filePath { filePath }, _streamed { bStreamed }
+{
+    GK_PROFILE_FUNCTION();
 
-        _loaded = true;
+    // Filtering and wrapping lives in a shared sampler object
+    _sampler = SamplerCache::Get(sampler);
+
+    // Decode and build the full mip chain on a job, off the thread holding the context.
+    // Textures created together decode side by side
+    _pending = std::make_unique<PendingLoad>();
+    JobSystem::Run([this] { _pending->image = Image::Load(_filePath); }, &_pending->counter);
+}
+
+void Texture::FinishLoad()
+{
+    GK_PROFILE_FUNCTION();
+
+    // Runs other jobs while waiting, possibly this one
+    JobSystem::Wait(_pending->counter);
+    std::optional<Image> image = std::move(_pending->image);
+    _pending.reset();
+    if (!image)
+    {
+        _failed = true;
+        return;
+    }
+
+    _width = image->GetWidth();
+    _height = image->GetHeight();
+    _levels = image->GetLevels();
+
+    if (_streamed)
+    {
+        // Keep the mip chain on the CPU and start out with only the smallest levels on the GPU
+        _mips = image->ReleaseLevels();
+        _loaded = SetResidentLevel(TextureStreamer::GetInitialLevel(_width, _height));
+        _failed = !_loaded;
+
+        TextureStreamer::Register(this);
     }
     else
     {
-        std::cout << "Error: Failure loading '" << _filePath << "'; " << stbi_failure_reason() << std::endl;
+        // Allocate immutable storage for the full mip chain and upload every level
+        glCreateTextures(GL_TEXTURE_2D, 1, &_id);
+        glTextureStorage2D(_id, _levels, GL_RGBA8, _width, _height);
+        for (int level = 0; level < _levels; level++)
+        {
+            glTextureSubImage2D(_id, level, 0, 0, GetLevelSize(_width, level), GetLevelSize(_height, level),
+                GL_RGBA, GL_UNSIGNED_BYTE, image->GetLevel(level).data());
+        }
+        RenderStats::Get().textureBytes += GetChainBytes(0);
+        GpuMemory::Allocate(_memoryType, GetChainBytes(0));
+
+        _loaded = true;
     }
-    
-    stbi_image_free(_localBuffer);
-    Unbind();
 }
 
 Texture::~Texture()
 {
+    if (_pending)
+    {
+        JobSystem::Wait(_pending->counter);
+    }
+    if (_streamed)
+    {
+        TextureStreamer::Unregister(this);
+    }
+    if (_id)
+    {
+        GpuMemory::Free(_memoryType, GetResidentBytes());
+    }
     glDeleteTextures(1, &_id);
 }
 
-bool Texture::Bind(unsigned unit) const
+bool Texture::Bind(unsigned unit)
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderCommand::Submit(BindTextureCommand { this, unit });
+        return !_failed;
+    }
+    if (_pending)
+    {
+        FinishLoad();
+    }
     if (IsOK())
     {
-        glActiveTexture(GL_TEXTURE0 + unit);
-        glBindTexture(GL_TEXTURE_2D, _id);
+        glBindTextureUnit(unit, _id);
+        SamplerCache::Bind(unit, _sampler);
+        RenderStats::Get().textureBinds++;
         return true;
     }
     return false;
 }
 
-void Texture::Unbind() const
+void Texture::Unbind(unsigned unit) const
+{
+    glBindTextureUnit(unit, 0);
+    SamplerCache::Bind(unit, 0);
+}
+
+size_t Texture::GetChainBytes(int fromLevel) const
+{
+    size_t bytes { 0 };
+    for (int level = fromLevel; level < _levels; level++)
+    {
+        bytes += static_cast<size_t>(GetLevelSize(_width, level)) * static_cast<size_t>(GetLevelSize(_height, level)) * 4;
+    }
+    return bytes;
+}
+
+bool Texture::SetResidentLevel(int level)
+{
+    if (!_streamed || _mips.empty()) return false;
+    
+    level = std::clamp(level, 0, _levels - 1);
+    if (_id && level == _residentLevel) return true;
+
+    // Immutable storage can't shrink or grow, so reallocate with only the resident part of the chain
+    unsigned id { 0 };
+    glCreateTextures(GL_TEXTURE_2D, 1, &id);
+    glTextureStorage2D(id, _levels - level, GL_RGBA8, GetLevelSize(_width, level), GetLevelSize(_height, level));
+    for (int mip = level; mip < _levels; mip++)
+    {
+        glTextureSubImage2D(id, mip - level, 0, 0, GetLevelSize(_width, mip), GetLevelSize(_height, mip),
+            GL_RGBA, GL_UNSIGNED_BYTE, _mips[mip].data());
+    }
+    RenderStats::Get().textureBytes += GetChainBytes(level);
+
+    if (_id)
+    {
+        GpuMemory::Free(_memoryType, GetResidentBytes());
+    }
+    GpuMemory::Allocate(_memoryType, GetChainBytes(level));
+    glDeleteTextures(1, &_id);
+    _id = id;
+    _residentLevel = level;
+    return true;
+}
+
+void Texture::RequestScreenSize(float pixels) const
+{
+    if (RenderThread::ShouldRecord())
+    {
+        RenderCommand::Submit(RequestScreenSizeCommand { this, pixels });
+        return;
+    }
+    const unsigned frame = TextureStreamer::GetFrame();
+    if (_requestFrame != frame)
+    {
+        _requestFrame = frame;
+        _requestedSize = 0.0f;
+    }
+    _requestedSize = std::max(_requestedSize, pixels);
+}
+
+int Texture::GetMipLevels(int width, int height)
 {
-    glBindTexture(GL_TEXTURE_2D, 0);
+    return std::bit_width(static_cast<unsigned>(std::max({ width, height, 1 })));
 }
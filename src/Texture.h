@@ -4,32 +4,76 @@
  * Copyright 2012-2022 Martin Furuberg 
  */
 #pragma once
+#include "Sampler.h"
+#include "renderer/GpuMemory.h"
+
+#include <algorithm>
+#include <atomic>
 
 
 class Texture
 {
     std::string _filePath {};
-    unsigned char* _localBuffer { nullptr };
-    int _bpp { 0 };
 
 protected:
     unsigned _id { 0 };
+    unsigned _sampler { 0 };
     bool _loaded { false };
     int _width { 0 };
     int _height { 0 };
+    int _levels { 1 };
+    GpuMemory::Resource _memoryType { GpuMemory::Resource::Texture };
+
+    // Streaming: CPU copy of the mip chain, GPU storage only holds levels from _residentLevel and down
+    bool _streamed { false };
+    int _residentLevel { 0 };
+    std::vector<std::vector<unsigned char>> _mips { };
+    mutable float _requestedSize { 0.0f };
+    mutable unsigned _requestFrame { 0 };
+
+    // Decoding on a job until the first Bind uploads it
+    struct PendingLoad;
+    std::unique_ptr<PendingLoad> _pending { };
+    // Set on the context thread, what a recording thread knows of a load before it is done
+    std::atomic<bool> _failed { false };
 
 public:
-    Texture() = default;
-    Texture(const std::string& filePath);
+    Texture();
+    // Returns before the image is decoded, the first Bind waits for it
+    Texture(const std::string& filePath, const SamplerState& sampler = { }, bool bStreamed = false);
     ~Texture();
 
-    bool Bind(unsigned unit = 0) const;
-    void Unbind() const;
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+
+    // While the render thread is active this records the bind and returns false only once a load has failed
+    bool Bind(unsigned unit = 0);
+    void Unbind(unsigned unit = 0) const;
 
     unsigned GetId() const { return _id; }
+    unsigned GetSampler() const { return _sampler; }
     bool IsOK() const { return _loaded; }
 
     int GetWidth() const { return _width; }
     int GetHeight() const { return _height; }
+    int GetLevels() const { return _levels; }
     std::string GetPath() const { return _filePath; }
+
+    // Streaming
+    bool IsStreamed() const { return _streamed; }
+    int GetResidentLevel() const { return _residentLevel; }
+    size_t GetResidentBytes() const { return GetChainBytes(_residentLevel); }
+    size_t GetChainBytes(int fromLevel) const;
+    bool SetResidentLevel(int level);
+
+    // Report the on-screen size in pixels this texture is drawn at, this frame
+    void RequestScreenSize(float pixels) const;
+
+    static int GetMipLevels(int width, int height);
+    static int GetLevelSize(int size, int level) { return std::max(1, size >> level); }
+
+private:
+    friend class TextureStreamer;
+
+    void FinishLoad();
 };
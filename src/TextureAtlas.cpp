@@ -0,0 +1,299 @@
+﻿/**
+ * Grafik
+ * TextureAtlas
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "TextureAtlas.h"
+
+#include "utils/Image.h"
+
+#include <algorithm>
+#include <climits>
+#include <ranges>
+
+
+TextureAtlas::TextureAtlas()
+    : TextureAtlas(Settings { }) { }
+
+TextureAtlas::TextureAtlas(const Settings& settings)
+    : _settings { settings }
+{
+    // Page size must be a multiple of the mip block for regions to stay aligned
+    const int alignment = GetAlignment();
+    _settings.pageSize = (std::max(_settings.pageSize, alignment) + alignment - 1) / alignment * alignment;
+}
+
+TextureAtlas::Handle TextureAtlas::Insert(const unsigned char* rgba, int width, int height)
+{
+    if (!rgba || width <= 0 || height <= 0) return InvalidHandle;
+
+    const int alignment = GetAlignment();
+    const int outerWidth = (width + _settings.padding * 2 + alignment - 1) / alignment * alignment;
+    const int outerHeight = (height + _settings.padding * 2 + alignment - 1) / alignment * alignment;
+    if (outerWidth > _settings.pageSize || outerHeight > _settings.pageSize)
+    {
+        Log::Error("TextureAtlas: Image {}x{} does not fit a {} page", width, height, _settings.pageSize);
+        return InvalidHandle;
+    }
+
+    // First page with room, otherwise open a new one
+    unsigned pageIndex { 0 };
+    std::optional<Rect> position;
+    for (; pageIndex < _pages.size() && !position; pageIndex++)
+    {
+        position = FindPosition(_pages[pageIndex], outerWidth, outerHeight);
+    }
+    if (position)
+    {
+        pageIndex--;
+    }
+    else
+    {
+        AddPage();
+        pageIndex = static_cast<unsigned>(_pages.size() - 1);
+        position = FindPosition(_pages[pageIndex], outerWidth, outerHeight);
+    }
+
+    Page& page = _pages[pageIndex];
+    PlaceRect(page, *position);
+    page.usedArea += static_cast<long long>(position->width) * position->height;
+    Upload(page, *position, rgba, width, height);
+
+    Entry entry;
+    entry.outer = *position;
+    entry.region.page = pageIndex;
+    entry.region.x = position->x + _settings.padding;
+    entry.region.y = position->y + _settings.padding;
+    entry.region.width = width;
+    entry.region.height = height;
+
+    const float size = static_cast<float>(_settings.pageSize);
+    entry.region.uvMin = { static_cast<float>(entry.region.x) / size, static_cast<float>(entry.region.y) / size };
+    entry.region.uvMax = { static_cast<float>(entry.region.x + width) / size, static_cast<float>(entry.region.y + height) / size };
+
+    const Handle handle = _nextHandle++;
+    _entries.emplace(handle, entry);
+    return handle;
+}
+
+TextureAtlas::Handle TextureAtlas::Insert(const std::string& filePath)
+{
+    // Same orientation as Texture, pages build their own mips
+    ImageOptions options;
+    options.mipLevels = 1;
+    const std::optional<Image> image = Image::Load(filePath, options);
+    if (!image) return InvalidHandle;
+
+    return Insert(image->GetLevel(0).data(), image->GetWidth(), image->GetHeight());
+}
+
+bool TextureAtlas::Remove(Handle handle)
+{
+    const auto entry = _entries.find(handle);
+    if (entry == _entries.end()) return false;
+
+    const unsigned pageIndex = entry->second.region.page;
+    Page& page = _pages[pageIndex];
+    page.usedArea -= static_cast<long long>(entry->second.outer.width) * entry->second.outer.height;
+    const Rect freed = entry->second.outer;
+    _entries.erase(entry);
+
+    // An empty page starts over, otherwise the free rects grow back over the region
+    if (page.usedArea == 0)
+    {
+        page.freeRects = { { 0, 0, _settings.pageSize, _settings.pageSize } };
+    }
+    else
+    {
+        FreeRect(page, freed);
+    }
+    return true;
+}
+
+const AtlasRegion* TextureAtlas::Get(Handle handle) const
+{
+    const auto entry = _entries.find(handle);
+    return entry != _entries.end() ? &entry->second.region : nullptr;
+}
+
+void TextureAtlas::Flush()
+{
+    for (Page& page : _pages)
+    {
+        if (page.dirty)
+        {
+            page.texture->GenerateMipmaps();
+            page.dirty = false;
+        }
+    }
+}
+
+bool TextureAtlas::Bind(unsigned page, unsigned unit) const
+{
+    return page < _pages.size() && _pages[page].texture->Bind(unit);
+}
+
+float TextureAtlas::GetOccupancy(unsigned page) const
+{
+    if (page >= _pages.size()) return 0.0f;
+    return static_cast<float>(_pages[page].usedArea) / static_cast<float>(static_cast<long long>(_settings.pageSize) * _settings.pageSize);
+}
+
+TextureAtlas::Page& TextureAtlas::AddPage()
+{
+    Page& page = _pages.emplace_back();
+    page.texture = std::make_unique<DataTexture>(_settings.pageSize, _settings.pageSize, _settings.mipLevels, _settings.sampler);
+    page.freeRects.push_back({ 0, 0, _settings.pageSize, _settings.pageSize });
+    return page;
+}
+
+std::optional<TextureAtlas::Rect> TextureAtlas::FindPosition(const Page& page, int width, int height)
+{
+    // Best short side fit, ties broken by long side
+    std::optional<Rect> best;
+    int bestShort { INT_MAX }, bestLong { INT_MAX };
+    for (const Rect& free : page.freeRects)
+    {
+        if (free.width < width || free.height < height) continue;
+
+        const int leftoverX = free.width - width;
+        const int leftoverY = free.height - height;
+        const int shortSide = std::min(leftoverX, leftoverY);
+        const int longSide = std::max(leftoverX, leftoverY);
+        if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong))
+        {
+            best = Rect { free.x, free.y, width, height };
+            bestShort = shortSide;
+            bestLong = longSide;
+        }
+    }
+    return best;
+}
+
+void TextureAtlas::PlaceRect(Page& page, const Rect& used)
+{
+    // Split every free rect overlapping the used one into its remaining maximal parts
+    std::vector<Rect> split;
+    for (size_t i = 0; i < page.freeRects.size();)
+    {
+        const Rect free = page.freeRects[i];
+        if (!free.Intersects(used))
+        {
+            i++;
+            continue;
+        }
+
+        if (used.x > free.x)              split.push_back({ free.x, free.y, used.x - free.x, free.height });
+        if (used.Right() < free.Right())  split.push_back({ used.Right(), free.y, free.Right() - used.Right(), free.height });
+        if (used.y > free.y)              split.push_back({ free.x, free.y, free.width, used.y - free.y });
+        if (used.Bottom() < free.Bottom()) split.push_back({ free.x, used.Bottom(), free.width, free.Bottom() - used.Bottom() });
+
+        page.freeRects[i] = page.freeRects.back();
+        page.freeRects.pop_back();
+    }
+    const size_t firstNew = page.freeRects.size();
+    page.freeRects.insert(page.freeRects.end(), split.begin(), split.end());
+    PruneFreeRects(page, firstNew);
+}
+
+void TextureAtlas::FreeRect(Page& page, const Rect& freed)
+{
+    // Every maximal rect that is new after the removal overlaps the freed region, anything else was
+    // free before and is already covered. Grow the region by joining it with its free neighbours
+    // until nothing new comes out, each join spanning both rects along the side they share
+    auto join = [&freed](const Rect& a, const Rect& b, std::vector<Rect>& out)
+    {
+        const int left = std::max(a.x, b.x), right = std::min(a.Right(), b.Right());
+        const int top = std::max(a.y, b.y), bottom = std::min(a.Bottom(), b.Bottom());
+
+        // Overlapping or touching vertically, sharing a column
+        if (left < right && top <= bottom)
+        {
+            out.push_back({ left, std::min(a.y, b.y), right - left, std::max(a.Bottom(), b.Bottom()) - std::min(a.y, b.y) });
+        }
+        // Overlapping or touching horizontally, sharing a row
+        if (top < bottom && left <= right)
+        {
+            out.push_back({ std::min(a.x, b.x), top, std::max(a.Right(), b.Right()) - std::min(a.x, b.x), bottom - top });
+        }
+        std::erase_if(out, [&freed](const Rect& r) { return !r.Intersects(freed); });
+    };
+
+    std::vector<Rect> grown { freed };
+    std::vector<Rect> joined;
+    for (size_t i = 0; i < grown.size(); i++)
+    {
+        joined.clear();
+        for (const Rect& free : page.freeRects)
+        {
+            join(grown[i], free, joined);
+        }
+        for (size_t j = 0; j < i; j++)
+        {
+            join(grown[i], grown[j], joined);
+        }
+
+        for (const Rect& r : joined)
+        {
+            if (std::ranges::none_of(grown, [&r](const Rect& g) { return g.Contains(r); }))
+            {
+                grown.push_back(r);
+            }
+        }
+    }
+
+    // Old rects swallowed by a grown one go. The grown rects overlap the freed region, which no
+    // old rect does, so none of them lies within an old rect and only pruning among them is left
+    std::erase_if(page.freeRects, [&grown](const Rect& free)
+    {
+        return std::ranges::any_of(grown, [&free](const Rect& g) { return g.Contains(free); });
+    });
+    const size_t firstNew = page.freeRects.size();
+    page.freeRects.insert(page.freeRects.end(), grown.begin(), grown.end());
+    PruneFreeRects(page, firstNew);
+}
+
+void TextureAtlas::PruneFreeRects(Page& page, size_t firstNew)
+{
+    // Drop new rects fully contained in another. The older rects were pruned already, and the callers
+    // make sure no new rect contains one of them
+    std::vector<Rect>& rects = page.freeRects;
+    for (size_t i = firstNew; i < rects.size();)
+    {
+        bool bContained { false };
+        for (size_t j = 0; j < rects.size() && !bContained; j++)
+        {
+            // Of two equal split rects only the later one goes
+            bContained = j != i && rects[j].Contains(rects[i]) && (j < firstNew || !rects[i].Contains(rects[j]) || j < i);
+        }
+        if (bContained)
+        {
+            rects[i] = rects.back();
+            rects.pop_back();
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+void TextureAtlas::Upload(Page& page, const Rect& outer, const unsigned char* rgba, int width, int height) const
+{
+    // Extrude edge texels into the gutter
+    std::vector<unsigned char> pixels(static_cast<size_t>(outer.width) * outer.height * 4);
+    for (int y = 0; y < outer.height; y++)
+    {
+        const int srcY = std::clamp(y - _settings.padding, 0, height - 1);
+        for (int x = 0; x < outer.width; x++)
+        {
+            const int srcX = std::clamp(x - _settings.padding, 0, width - 1);
+            std::copy_n(rgba + (static_cast<size_t>(srcY) * width + srcX) * 4, 4,
+                pixels.data() + (static_cast<size_t>(y) * outer.width + x) * 4);
+        }
+    }
+
+    page.texture->SetData(outer.x, outer.y, outer.width, outer.height, pixels.data());
+    page.dirty = true;
+}
@@ -0,0 +1,103 @@
+﻿/**
+ * Grafik
+ * TextureAtlas
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+#include "DataTexture.h"
+
+#include <glm/glm.hpp>
+
+
+struct AtlasRegion
+{
+    unsigned    page        { 0 };
+    int         x           { 0 };
+    int         y           { 0 };
+    int         width       { 0 };
+    int         height      { 0 };
+    glm::vec2   uvMin       { 0.0f, 0.0f };
+    glm::vec2   uvMax       { 1.0f, 1.0f };
+};
+
+/**
+ * Packs many small RGBA images into one or more large pages (MaxRects, best short side fit).
+ * Regions are padded with a gutter of repeated edge texels and aligned to the coarsest mip
+ * block, so neither bilinear taps nor the page mips mix neighbouring images.
+ */
+class TextureAtlas
+{
+public:
+    using Handle = unsigned;
+    static constexpr Handle InvalidHandle { 0 };
+
+    struct Settings
+    {
+        int             pageSize    { 2048 };
+        int             padding     { 4 };
+        int             mipLevels   { 3 };
+        SamplerState    sampler     { SamplerState::Filter::LinearMipmapLinear, SamplerState::Filter::Linear,
+                                      SamplerState::Wrap::ClampToEdge, SamplerState::Wrap::ClampToEdge };
+    };
+
+    TextureAtlas();
+    explicit TextureAtlas(const Settings& settings);
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    Handle Insert(const unsigned char* rgba, int width, int height);
+    Handle Insert(const std::string& filePath);
+    bool Remove(Handle handle);
+
+    [[nodiscard]] const AtlasRegion* Get(Handle handle) const;
+
+    // Rebuild mips of pages changed since the last call
+    void Flush();
+
+    bool Bind(unsigned page, unsigned unit = 0) const;
+
+    [[nodiscard]] size_t GetPageCount() const { return _pages.size(); }
+    [[nodiscard]] size_t GetCount() const { return _entries.size(); }
+    [[nodiscard]] float GetOccupancy(unsigned page) const;
+    [[nodiscard]] const DataTexture* GetPage(unsigned page) const { return page < _pages.size() ? _pages[page].texture.get() : nullptr; }
+
+private:
+    struct Rect
+    {
+        int x { 0 }, y { 0 }, width { 0 }, height { 0 };
+
+        [[nodiscard]] int Right() const { return x + width; }
+        [[nodiscard]] int Bottom() const { return y + height; }
+        [[nodiscard]] bool Contains(const Rect& r) const { return r.x >= x && r.y >= y && r.Right() <= Right() && r.Bottom() <= Bottom(); }
+        [[nodiscard]] bool Intersects(const Rect& r) const { return r.x < Right() && r.Right() > x && r.y < Bottom() && r.Bottom() > y; }
+    };
+
+    struct Page
+    {
+        std::unique_ptr<DataTexture> texture { };
+        std::vector<Rect> freeRects { };
+        long long usedArea { 0 };
+        bool dirty { false };
+    };
+
+    struct Entry
+    {
+        AtlasRegion region { };
+        Rect outer { };
+    };
+
+    Settings _settings { };
+    std::vector<Page> _pages { };
+    std::unordered_map<Handle, Entry> _entries { };
+    Handle _nextHandle { 1 };
+
+    [[nodiscard]] int GetAlignment() const { return 1 << (std::max(_settings.mipLevels, 1) - 1); }
+
+    Page& AddPage();
+    static std::optional<Rect> FindPosition(const Page& page, int width, int height);
+    static void PlaceRect(Page& page, const Rect& used);
+    static void FreeRect(Page& page, const Rect& freed);
+    static void PruneFreeRects(Page& page, size_t firstNew);
+    void Upload(Page& page, const Rect& outer, const unsigned char* rgba, int width, int height) const;
+};
@@ -0,0 +1,134 @@
+﻿/**
+ * Grafik
+ * TextureStreamer
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "TextureStreamer.h"
+
+#include "renderer/Renderer.h"
+#include "Texture.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+TextureStreamer::Settings TextureStreamer::_settings { };
+
+void TextureStreamer::Register(Texture* texture)
+{
+    _textures.push_back(texture);
+}
+
+void TextureStreamer::Unregister(Texture* texture)
+{
+    std::erase(_textures, texture);
+}
+
+void TextureStreamer::Update()
+{
+    struct Change
+    {
+        Texture* texture;
+        int level;
+    };
+    
+    // Reused between frames to keep the update off the heap
+    static std::vector<Change> changes;
+    changes.clear();
+
+    size_t total { 0 };
+    for (Texture* texture : _textures)
+    {
+        const int level = GetDesiredLevel(*texture);
+        changes.push_back({ texture, level });
+        total += texture->GetChainBytes(level);
+    }
+
+    // Over budget: drop the top mip of whichever texture holds the largest one until it fits
+    while (total > _settings.budget)
+    {
+        const auto largest = std::ranges::max_element(changes, {}, [](const Change& c)
+        {
+            return c.level < c.texture->GetLevels() - 1 ? c.texture->GetChainBytes(c.level) - c.texture->GetChainBytes(c.level + 1) : 0;
+        });
+        if (largest == changes.end() || largest->level >= largest->texture->GetLevels() - 1) break;
+        
+        total -= largest->texture->GetChainBytes(largest->level) - largest->texture->GetChainBytes(largest->level + 1);
+        largest->level++;
+    }
+
+    // Apply drops before raises to free memory first, limit reallocations per frame
+    std::erase_if(changes, [](const Change& c) { return c.level == c.texture->GetResidentLevel(); });
+    std::ranges::sort(changes, [](const Change& a, const Change& b)
+    {
+        return (a.level - a.texture->GetResidentLevel()) > (b.level - b.texture->GetResidentLevel());
+    });
+    
+    int applied { 0 };
+    for (const auto& [texture, level] : changes)
+    {
+        if (applied++ >= _settings.maxChangesPerFrame) break;
+        texture->SetResidentLevel(level);
+    }
+
+    _frame++;
+}
+
+size_t TextureStreamer::GetResidentBytes()
+{
+    size_t bytes { 0 };
+    for (const Texture* texture : _textures)
+    {
+        bytes += texture->GetResidentBytes();
+    }
+    return bytes;
+}
+
+int TextureStreamer::GetInitialLevel(int width, int height)
+{
+    const int levels = Texture::GetMipLevels(width, height);
+    int level { 0 };
+    while (level < levels - 1 && std::max(Texture::GetLevelSize(width, level), Texture::GetLevelSize(height, level)) > _settings.initialSize)
+    {
+        level++;
+    }
+    return level;
+}
+
+int TextureStreamer::GetDesiredLevel(const Texture& texture)
+{
+    const int largest = std::max(texture.GetWidth(), texture.GetHeight());
+
+    // Not drawn for a while, fall back to the initial low-resolution mips
+    if (texture._requestFrame + _settings.releaseFrames < _frame || texture._requestedSize <= 0.0f)
+    {
+        return std::max(texture.GetResidentLevel(), GetInitialLevel(texture.GetWidth(), texture.GetHeight()));
+    }
+
+    // Highest mip that still has at least one texel per covered pixel
+    const float ratio = static_cast<float>(largest) / texture._requestedSize;
+    const int level = ratio > 1.0f ? static_cast<int>(std::floor(std::log2(ratio))) : 0;
+    return std::clamp(level, 0, texture.GetLevels() - 1);
+}
+
+float TextureStreamer::GetScreenSize(const glm::mat4& mvp, const glm::vec3& center, float worldSize)
+{
+    int width, height;
+    if (!Renderer::GetFramebufferSize(width, height)) return 0.0f;
+
+    auto toScreen = [&](const glm::vec3& point)
+    {
+        const glm::vec4 clip = mvp * glm::vec4(point, 1.0f);
+        const float w = std::max(std::abs(clip.w), 1e-5f);
+        return glm::vec2(clip.x / w * static_cast<float>(width), clip.y / w * static_cast<float>(height)) * 0.5f;
+    };
+
+    const glm::vec2 origin = toScreen(center);
+    const float extentX = glm::length(toScreen(center + glm::vec3(worldSize, 0.0f, 0.0f)) - origin);
+    const float extentY = glm::length(toScreen(center + glm::vec3(0.0f, worldSize, 0.0f)) - origin);
+    const float extentZ = glm::length(toScreen(center + glm::vec3(0.0f, 0.0f, worldSize)) - origin);
+    return std::max({ extentX, extentY, extentZ });
+}
@@ -0,0 +1,53 @@
+﻿/**
+ * Grafik
+ * TextureStreamer
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+#include <glm/fwd.hpp>
+
+
+class Texture;
+
+/**
+ * Drives the resident mip level of streamed textures from the on-screen size reported
+ * by the labs each frame, keeping the total resident size under a budget.
+ * Runs on the thread that owns the context, requests made while recording are recorded with the frame.
+ */
+class TextureStreamer
+{
+public:
+    struct Settings
+    {
+        size_t      budget              { 256ull * 1024 * 1024 };   // bytes of resident texture memory
+        int         initialSize         { 64 };                     // largest mip uploaded at load
+        int         maxChangesPerFrame  { 4 };                      // reallocations per Update()
+        unsigned    releaseFrames       { 120 };                    // frames without requests before dropping mips
+    };
+
+    static void Register(Texture* texture);
+    static void Unregister(Texture* texture);
+
+    // Call once per frame after rendering, applies residency changes
+    static void Update();
+
+    static void SetSettings(const Settings& settings) { _settings = settings; }
+    [[nodiscard]] static const Settings& GetSettings() { return _settings; }
+    static void SetBudget(size_t bytes) { _settings.budget = bytes; }
+
+    [[nodiscard]] static unsigned GetFrame() { return _frame; }
+    [[nodiscard]] static size_t GetResidentBytes();
+    [[nodiscard]] static size_t GetCount() { return _textures.size(); }
+
+    [[nodiscard]] static int GetInitialLevel(int width, int height);
+
+    // Screen-space size in pixels of a square with worldSize sides at center, seen through mvp
+    [[nodiscard]] static float GetScreenSize(const glm::mat4& mvp, const glm::vec3& center, float worldSize);
+
+private:
+    [[nodiscard]] static int GetDesiredLevel(const Texture& texture);
+
+    inline static std::vector<Texture*> _textures { };
+    static Settings _settings;
+    inline static unsigned _frame { 1 };
+};
@@ -9,12 +9,26 @@
 #include "ElementBuffer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
+#include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
 
 #include <glad/glad.h>
 
 
+namespace
+{
+    // Recorded while the render thread is active, binds again on the render thread
+    struct BindVertexArrayCommand
+    {
+        const VertexArray* vao;
+        void Execute() const { vao->Bind(); }
+    };
+}
+
 VertexArray::VertexArray()
 {
+    GK_PROFILE_FUNCTION();
+
     glGenVertexArrays(1, &_id);
     Bind();
 }
@@ -26,7 +40,13 @@ VertexArray::~VertexArray()
 
 void VertexArray::Bind() const
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderCommand::Submit(BindVertexArrayCommand { this });
+        return;
+    }
     glBindVertexArray(_id);
+    RenderStats::Get().vertexArrayBinds++;
 }
 
 void VertexArray::Unbind()
@@ -6,19 +6,61 @@
 #include "gpch.h"
 #include "VertexBuffer.h"
 
+#include "renderer/GpuMemory.h"
+#include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
+
 #include <glad/glad.h>
 
 
+namespace
+{
+    // Recorded while the render thread is active, data points at a copy in the command buffer
+    struct SetDataCommand
+    {
+        const VertexBuffer* vbo;
+        const void* data;
+        unsigned size;
+        unsigned offset;
+
+        void Execute() const { vbo->SetData(data, size, offset); }
+    };
+}
+
 VertexBuffer::VertexBuffer(const void* data, unsigned size, bool dynamic)
+    : _size { size }
 {
+    GK_PROFILE_FUNCTION();
+
     glGenBuffers(1, &_id);
     Bind();
     glBufferData(GL_ARRAY_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+    GpuMemory::Allocate(GpuMemory::Resource::VertexBuffer, size);
+
+    if (data)
+    {
+        RenderStats::Get().bufferBytes += size;
+    }
 }
 
 VertexBuffer::~VertexBuffer()
 {
     glDeleteBuffers(1, &_id);
+    GpuMemory::Free(GpuMemory::Resource::VertexBuffer, _size);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned size, unsigned offset) const
+{
+    if (RenderThread::ShouldRecord())
+    {
+        // The caller is free to refill its vertices right away
+        void* copy = RenderThread::GetCommands().Allocate(size);
+        std::memcpy(copy, data, size);
+        RenderCommand::Submit(SetDataCommand { this, copy, size, offset });
+        return;
+    }
+    glNamedBufferSubData(_id, offset, size, data);
+    RenderStats::Get().bufferBytes += size;
 }
 
 void VertexBuffer::Bind() const
@@ -10,6 +10,7 @@ class VertexBuffer
 {
 private:
     unsigned _id { 0 };
+    unsigned _size { 0 };
     
 public:
     VertexBuffer(const void* data, unsigned size, bool dynamic = false);
@@ -17,6 +18,9 @@ public:
 
     unsigned GetId() const { return _id; }
     
+    // Replace size bytes of the buffer from offset
+    void SetData(const void* data, unsigned size, unsigned offset = 0) const;
+
     void Bind() const;
     static void Unbind();
 };
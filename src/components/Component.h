@@ -6,6 +6,25 @@
 #pragma once
 #include "events/EventManager.h"
 
+#include <cstdint>
+#include <limits>
+
+
+/**
+ * Reference to a component owned by the ComponentManager. The generation is bumped when the
+ * component is detached, so a stale handle resolves to nullptr instead of a dangling or reused slot.
+ */
+struct ComponentHandle
+{
+    static constexpr uint32_t InvalidIndex { std::numeric_limits<uint32_t>::max() };
+
+    uint32_t index { InvalidIndex };
+    uint32_t generation { 0 };
+
+    [[nodiscard]] bool IsValid() const { return index != InvalidIndex; }
+
+    bool operator==(const ComponentHandle&) const = default;
+};
 
 class Component
 {
@@ -27,7 +46,11 @@ public:
 
     [[nodiscard]] bool IsAlive() const { return _keepAlive; }
     [[nodiscard]] bool IsEnabled() const { return _enabled; }
+    [[nodiscard]] ComponentHandle GetHandle() const { return _handle; }
     
 private:
+    ComponentHandle _handle { };
+    bool _detaching { false };
+
     friend class ComponentManager;
 };
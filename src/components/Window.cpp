@@ -6,19 +6,32 @@
 #include "gpch.h"
 #include "Window.h"
 
+#include "core/Input.h"
 #include "events/ApplicationEvent.h"
 #include "renderer/RendererAPI.h"
+#include "renderer/RenderThread.h"
 
 #include <GLFW/glfw3.h>
 
 
 Window::Window(const WindowProperties& props)
-    : _state { props.title, props.width, props.height } { }
+    : _state { props.title, props.width, props.height, props.visible, props.headless } { }
 
 void Window::OnAttach(int& eventMask)
 {
     eventMask = Event::None;
 
+    // No window system involved, the size is only what was asked for
+    if (_state.headless && (_context = GraphicsContext::CreateHeadless()))
+    {
+        _context->Init(nullptr);
+        _state.framebufferWidth = static_cast<int>(_state.width);
+        _state.framebufferHeight = static_cast<int>(_state.height);
+        _state.running = true;
+        Input::SetPumpEvents(false);
+        return;
+    }
+
     glfwSetErrorCallback(glfwError);
     if (!glfwInit())
     {
@@ -30,6 +43,7 @@ void Window::OnAttach(int& eventMask)
     _context = GraphicsContext::Create();
     CreateNativeWindow();
     _context->Init(_window);
+    Input::SetPumpEvents(true);
 
     glfwSetWindowSizeCallback(_window, [](GLFWwindow* window, const int width, const int height)
     {
@@ -46,16 +60,52 @@ void Window::OnAttach(int& eventMask)
         EventManager::Get()->Broadcast(event);
     });
 
-    glfwSetFramebufferSizeCallback(_window, [](GLFWwindow*, const int width, const int height)
+    int width, height;
+    glfwGetFramebufferSize(_window, &width, &height);
+    _state.framebufferWidth = width;
+    _state.framebufferHeight = height;
+
+    glfwSetFramebufferSizeCallback(_window, [](GLFWwindow* window, const int width, const int height)
     {
+        WindowState& state = *static_cast<WindowState*>(glfwGetWindowUserPointer(window));
+        state.framebufferWidth = width;
+        state.framebufferHeight = height;
+
         FramebufferSizeEvent event(width, height);
         EventManager::Get()->Broadcast(event);
     });
+
+    // Input is buffered and handed out by Input::Poll, ImGui chains onto these when it installs its own
+    glfwSetKeyCallback(_window, [](GLFWwindow*, const int key, const int scancode, const int action, const int mods)
+    {
+        Input::PushKey(key, scancode, action, mods);
+    });
+
+    glfwSetCharCallback(_window, [](GLFWwindow*, const unsigned codepoint)
+    {
+        Input::PushChar(codepoint);
+    });
+
+    glfwSetMouseButtonCallback(_window, [](GLFWwindow*, const int button, const int action, const int mods)
+    {
+        Input::PushButton(button, action, mods);
+    });
+
+    glfwSetCursorPosCallback(_window, [](GLFWwindow*, const double x, const double y)
+    {
+        Input::PushMove(x, y);
+    });
+
+    glfwSetScrollCallback(_window, [](GLFWwindow*, const double offsetX, const double offsetY)
+    {
+        Input::PushScroll(offsetX, offsetY);
+    });
 }
 
 void Window::CreateNativeWindow()
 {
     // Create window and init glfw with context
+    glfwWindowHint(GLFW_VISIBLE, _state.visible ? GLFW_TRUE : GLFW_FALSE);
     _window = glfwCreateWindow(static_cast<int>(_state.width), static_cast<int>(_state.height), GetDetailedWindowTitle().c_str(), nullptr, nullptr);
     if (!_window)
     {
@@ -70,8 +120,15 @@ void Window::CreateNativeWindow()
 
 void Window::Update()
 {
-    _context->SwapBuffers();
-    glfwPollEvents();
+    // The render thread swaps once it has executed the frame
+    if (RenderThread::IsActive())
+    {
+        RenderThread::Present();
+    }
+    else
+    {
+        _context->SwapBuffers();
+    }
 }
 
 std::string Window::GetDetailedWindowTitle() const
@@ -88,11 +145,13 @@ void Window::Close()
 
 Window::~Window()
 {
+    if (IsHeadless()) return;
+
     glfwDestroyWindow(_window);
     glfwTerminate();
 }
 
 void Window::glfwError(int error, const char* description)
 {
-    std::cout << "GLFW Error (" << error << "): " << description << std::endl;
+    Log::Error("GLFW Error ({}): {}", error, description);
 }
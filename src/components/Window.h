@@ -7,6 +7,8 @@
 #include "components/Component.h"
 #include "renderer/GraphicsContext.h"
 
+#include <atomic>
+
 
 struct GLFWwindow;
 
@@ -15,6 +17,8 @@ struct WindowProperties
     std::string title { };
     unsigned width { 640 };
     unsigned height { 480 };
+    bool visible { true };
+    bool headless { false };    // no window at all where the platform can render without one
 };
 
 class Window : public Component
@@ -38,7 +42,14 @@ public:
 
     [[nodiscard]] bool IsRunning() const { return _state.running; }
     [[nodiscard]] bool IsMinimized() const { return _state.minimized; }
+    [[nodiscard]] bool IsHeadless() const { return _context && !_window; }
+
+    // nullptr when headless
     [[nodiscard]] GLFWwindow* GetNativeWindow() const { return _window; }
+    [[nodiscard]] GraphicsContext* GetContext() const { return _context.get(); }
+
+    // Last reported size, readable from any thread
+    void GetFramebufferSize(int& width, int& height) const { width = _state.framebufferWidth; height = _state.framebufferHeight; }
 
 protected:
     [[nodiscard]] std::string GetDetailedWindowTitle() const;
@@ -49,6 +60,10 @@ protected:
         std::string title { };
         unsigned width { 640 };
         unsigned height { 480 };
+        bool visible { true };
+        bool headless { false };
+        std::atomic<int> framebufferWidth { 0 };
+        std::atomic<int> framebufferHeight { 0 };
         bool running { false };
         bool minimized { false };
 
@@ -7,8 +7,18 @@
 #include "Application.h"
 
 #include "components/Window.h"
+#include "core/Input.h"
+#include "core/Memory.h"
+#include "renderer/GpuTimer.h"
+#include "renderer/GraphicsContext.h"
 #include "renderer/Renderer.h"
 #include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
+#include "renderer/RenderThread.h"
+#include "Framebuffer.h"
+#include "Sampler.h"
+#include "TextureStreamer.h"
+#include "ui/FontCache.h"
 
 // Labb
 #include "labb/LabMenu.h"
@@ -17,12 +27,44 @@
 #include "labb/Mirror.h"
 #include "labb/Loop.h"
 #include "labb/Stacks.h"
+#include "labb/Swarm.h"
 #include "labb/Triangle.h"
 
 #include <GLFW/glfw3.h>
 #include <imgui/imgui.h>
 
 
+namespace
+{
+    struct BeginFrameCommand
+    {
+        const Framebuffer* target;
+
+        void Execute() const
+        {
+            RenderStats::BeginFrame();
+            GpuTimer::BeginFrame();
+            if (target) target->Bind();
+        }
+    };
+
+    struct UpdateStreamingCommand
+    {
+        void Execute() const { TextureStreamer::Update(); }
+    };
+
+    struct DrawUICommand
+    {
+        UI* ui;
+
+        void Execute() const
+        {
+            GK_GPU_SCOPE("UI");
+            ui->Draw();
+        }
+    };
+}
+
 Application::Application(Config config)
     : _config { std::move(config) }
 {
@@ -34,18 +76,62 @@ Application::Application(Config config)
 
 void Application::Init()
 {
+    Profiler::SetThreadName("Main");
+    if (_config.profileFrames > 0)
+    {
+        Profiler::BeginCapture(_config.profileFrames);
+    }
+
+    Memory::SetScopeTracking(_config.trackAllocations);
+
     Renderer::Init(_config.api);
+    TextureStreamer::SetBudget(static_cast<size_t>(_config.textureBudget) * 1024 * 1024);
 
     // Initialize event system
-    EventManager::Get()->addListener(this, GK_BIND_EVENT_HANDLER(Application::OnEvent), Event::Application);
-
-    const WindowProperties props { _config.title, _config.width, _config.height };
+    const auto events = EventManager::Get();
+    // events->addListener<WindowSizeEvent, &Application::OnWindowResize>(this);
+    events->addListener<WindowCloseEvent, &Application::OnWindowClose>(this);
+    events->addListener<FramebufferSizeEvent, &Application::OnFramebufferSize>(this);
+    events->addListener<InitLabEvent, &Application::OnInitLab>(this);
+
+    const bool bBenchmark = !_config.bench.lab.empty();
+    const WindowProperties props { _config.title, _config.width, _config.height, !bBenchmark, bBenchmark };
     _window = _components.Create<Window>(props);
 
+    // Hidden, unthrottled and rendering into a target of the requested size
+    if (bBenchmark)
+    {
+        _config.presentMode = GraphicsContext::PresentMode::Immediate;
+        _config.frameLimit = 0;
+        if (_config.seed == 0) _config.seed = 1;
+        if (_config.api == RendererAPI::API::OpenGL)
+        {
+            _benchTarget = std::make_unique<Framebuffer>(static_cast<int>(_config.width), static_cast<int>(_config.height));
+        }
+        _bench = std::make_unique<Benchmark>(_config.bench, static_cast<int>(_config.width), static_cast<int>(_config.height));
+    }
+    _config.presentMode = _window->GetContext()->SetPresentMode(_config.presentMode);
+    _window->GetContext()->SetMaxFramesInFlight(_config.framesInFlight);
+    _pacer.SetLimit(_config.frameLimit);
+
     InitUI();
+    _gpuMemoryBaseline = GpuMemory::GetSnapshot();
     InitLabs();
 
     if (_config.wireFrameMode) RenderCommand::SetWireframeMode();
+
+    // From here on the context belongs to the render thread
+    if (_config.renderThread)
+    {
+        if (_config.api == RendererAPI::API::OpenGL)
+        {
+            RenderThread::Start(_window->GetContext());
+        }
+        else
+        {
+            Log::Warn("Application: Render thread is only available with OpenGL");
+        }
+    }
 }
 
 void Application::InitUI()
@@ -61,12 +147,14 @@ void Application::InitUI()
     style.WindowRounding = 3.0f;
     style.FrameRounding = 3.0f;
 
-    if ((_ui = UI::Create()))
+    // Headless has no window to draw or take input in, the context is still made for the labs' widgets
+    if (!_window->IsHeadless() && (_ui = UI::Create()))
     {
         _ui->Init(_window->GetNativeWindow());
     }
 
-    const auto font = io.Fonts->AddFontFromFileTTF("data/fonts/JetBrainsMonoNL-Light.ttf", 15.0f);
+    // Baked atlas is cached on disk and kept in memory across API switches
+    const auto font = FontCache::AddFont(io.Fonts, "data/fonts/JetBrainsMonoNL-Light.ttf", 15.0f);
     IM_ASSERT(font != nullptr); (void)font;
 }
 
@@ -84,12 +172,13 @@ void Application::InitLabs()
         _menu->RegisterLab<labb::LMirror>("Mirror", "mirror");
         _menu->RegisterLab<labb::LBatch>("Batch", "batch");
         _menu->RegisterLab<labb::LLoop>("Loop", "loop");
+        _menu->RegisterLab<labb::LSwarm>("Swarm", "swarm");
     }
 
-    // Create an initial lab if set to matching shortname
-    if (!_config.initLab.empty())
+    // Create an initial lab if set to matching shortname, a benchmark has nothing to run without it
+    if (!_config.initLab.empty() && !_menu->CreateLabIfExists(_config.initLab) && _bench)
     {
-        _menu->CreateLabIfExists(_config.initLab);
+        throw std::runtime_error("No lab to benchmark named '" + _config.initLab + "'");
     }
 }
 
@@ -97,24 +186,72 @@ void Application::Run()
 {
     double totalTimeElapsed { 0 };
 
+    // Frames since the set of components last changed, earlier ones are allowed to allocate
+    constexpr unsigned allocationWarmupFrames { 10 };
+    unsigned steadyFrames { 0 };
+    size_t componentCount { _components.GetCount() };
+
+    constexpr double benchDeltaTime { 1.0 / 60.0 };
+
     // Keep running until we should close and exit
     while (_window->IsRunning())
     {
-        // Update timers
-        const double timeElapsedNow = glfwGetTime();
-        const double deltaTime      = timeElapsedNow - totalTimeElapsed;
+        const Memory::AllocationScope frameAllocations;
+
+        Profiler::BeginFrame();
+        Memory::BeginFrame();
+        GK_PROFILE_SCOPE("Frame");
+
+        if (_bench) _bench->BeginFrame();
+
+        // Update timers, a benchmark steps the same amount every frame so runs are comparable
+        const double timeElapsedNow = static_cast<double>(Profiler::Now()) / 1e9;
+        const double deltaTime      = _bench ? benchDeltaTime : timeElapsedNow - totalTimeElapsed;
         totalTimeElapsed            = timeElapsedNow;
 
         // Renderer::BeginFrame();
 
-        TickEvent tickEvent { deltaTime };
-        EventManager::Get()->Broadcast(tickEvent);
+        // Window and input events
+        {
+            GK_PROFILE_SCOPE("Input");
+            Input::BeginFrame();
+            Input::Poll();
 
-        RenderEvent renderEvent;
-        EventManager::Get()->Broadcast(renderEvent);
+            // Events posted from other threads since the last frame
+            EventManager::Get()->DispatchPosted();
+        }
 
-        if (_ui && !_window->IsMinimized())
+        if (Input::WasKeyPressed(GLFW_KEY_F11))
         {
+            ToggleProfileCapture();
+        }
+
+        double alpha { 1.0 };
+        {
+            GK_PROFILE_SCOPE("Tick");
+            alpha = Tick(deltaTime);
+        }
+
+        // Sample input again as late as possible, labs read it while rendering
+        Input::Poll();
+
+        // With a render thread the labs record their draws here while it still submits the last frame
+        {
+            GK_PROFILE_SCOPE("Render");
+            RenderCommand::Submit(BeginFrameCommand { _benchTarget.get() });
+            {
+                GK_GPU_SCOPE("Lab");
+                RenderEvent renderEvent { alpha };
+                EventManager::Get()->Broadcast(renderEvent);
+            }
+
+            // Adjust resident texture mips from this frame's requests
+            RenderCommand::Submit(UpdateStreamingCommand { });
+        }
+
+        if (_ui && !_window->IsMinimized() && !_bench)
+        {
+            GK_PROFILE_SCOPE("UI");
             _ui->Begin();
 
             UIEvent uiEvent;
@@ -122,25 +259,120 @@ void Application::Run()
 
             // Render UI
             _ui->End();
+            RenderCommand::Submit(DrawUICommand { _ui.get() });
         }
 
         // Renderer::EndFrame();
-        _window->Update();
+        {
+            GK_PROFILE_SCOPE("Present");
+            _window->Update();
+        }
 
-        if (_components.Clean() && _components.GetCount() < 3)
+        // Destroying components releases GL objects, only sync with the render thread when there is something to remove
+        bool cleaned { false };
+        if (_components.HasRemovals())
+        {
+            GK_PROFILE_SCOPE("Clean");
+            RenderThread::Execute([this, &cleaned] { cleaned = _components.Clean(); });
+        }
+        if (cleaned && _components.GetCount() < 3)
         {
             _menu->ShowBigMenu();
+
+            // Back to no labs, everything they created should be gone
+            GpuMemory::CheckLeaks(_gpuMemoryBaseline);
+        }
+
+        // Wait out the rest of the frame when limited
+        _pacer.EndFrame();
+
+        if (_bench)
+        {
+            _bench->EndFrame();
+            if (_bench->IsDone())
+            {
+                _window->Close();
+                Grafik::ShouldExit = true;
+            }
+        }
+
+        if constexpr (Memory::IsTracking)
+        {
+            if (componentCount != _components.GetCount())
+            {
+                componentCount = _components.GetCount();
+                steadyFrames = 0;
+            }
+            else if (_config.checkAllocations && ++steadyFrames > allocationWarmupFrames && frameAllocations.GetCount() > 0)
+            {
+                Log::Error("Application: Steady frame made {} heap allocations ({} bytes)", frameAllocations.GetCount(), frameAllocations.GetBytes());
+            }
         }
     }
+
+    // Components and UI are torn down on this thread
+    RenderThread::Stop();
+
+    // Closed before the requested frames were captured
+    Profiler::EndCapture();
+
+    if (_bench && _bench->IsDone())
+    {
+        _bench->Finish(_benchTarget.get());
+    }
+}
+
+void Application::SetPresentMode(GraphicsContext::PresentMode mode)
+{
+    GraphicsContext* context = _window->GetContext();
+    RenderThread::Execute([context, &mode] { mode = context->SetPresentMode(mode); });
+    _config.presentMode = mode;
+}
+
+GraphicsContext::PresentMode Application::GetPresentMode() const
+{
+    return _config.presentMode;
 }
 
-void Application::OnEvent(Event& e)
+void Application::ToggleProfileCapture()
 {
-    EventDispatcher dispatcher { e };
-    // dispatcher.Dispatch<WindowSizeEvent>(GK_BIND_EVENT_HANDLER(OnWindowResize));
-    dispatcher.Dispatch<WindowCloseEvent>(GK_BIND_EVENT_HANDLER(OnWindowClose));
-    dispatcher.Dispatch<FramebufferSizeEvent>(GK_BIND_EVENT_HANDLER(OnFramebufferSize));
-    dispatcher.Dispatch<InitLabEvent>(GK_BIND_EVENT_HANDLER(OnInitLab));
+    if (!Profiler::EndCapture())
+    {
+        Profiler::BeginCapture();
+    }
+}
+
+double Application::Tick(double frameTime)
+{
+    // A hitch (breakpoint, window drag, load) must not turn into one huge step or a catch-up spiral
+    constexpr double maxFrameTime { 0.25 };
+    frameTime = std::min(frameTime, maxFrameTime);
+
+    if (_config.fixedTickRate == 0)
+    {
+        TickEvent tickEvent { frameTime };
+        EventManager::Get()->Broadcast(tickEvent);
+        return 1.0;
+    }
+
+    const double step = 1.0 / static_cast<double>(_config.fixedTickRate);
+    _tickAccumulator += frameTime;
+
+    unsigned steps { 0 };
+    while (_tickAccumulator >= step && steps < _config.maxTickSteps)
+    {
+        TickEvent tickEvent { step, true };
+        EventManager::Get()->Broadcast(tickEvent);
+        _tickAccumulator -= step;
+        steps++;
+    }
+
+    // Out of steps for this frame, drop the whole steps that are left so the simulation slows down instead
+    if (_tickAccumulator >= step)
+    {
+        _tickAccumulator = std::fmod(_tickAccumulator, step);
+    }
+    return _tickAccumulator / step;
 }
 
 void Application::OnWindowClose(WindowCloseEvent& e) const
@@ -170,7 +402,10 @@ void Application::OnFramebufferSize(const FramebufferSizeEvent& e) const
 
 void Application::OnInitLab(InitLabEvent& e)
 {
-    if (const auto lab = e.createLab())
+    // Labs create GL objects in their constructors
+    labb::LLab* lab { nullptr };
+    RenderThread::Execute([&lab, &e] { lab = e.createLab(); });
+    if (lab)
     {
         _components.Attach(lab);
         
@@ -192,6 +427,154 @@ void Application::CheckArgs(Config& config)
             config.initLab = config.args[i+1];
         }
 
+        // Texture streaming budget in MB
+        if (config.args.count > i+1 && strcmp(config.args[i], "-texbudget") == 0)
+        {
+            config.textureBudget = static_cast<unsigned>(std::max(1, atoi(config.args[i+1])));
+        }
+
+        // Fixed tick rate in Hz
+        if (config.args.count > i+1 && strcmp(config.args[i], "-fixed") == 0)
+        {
+            config.fixedTickRate = static_cast<unsigned>(std::max(0, atoi(config.args[i+1])));
+        }
+
+        // Fixed steps per frame before dropping time
+        if (config.args.count > i+1 && strcmp(config.args[i], "-maxsteps") == 0)
+        {
+            config.maxTickSteps = static_cast<unsigned>(std::max(1, atoi(config.args[i+1])));
+        }
+
+        // Submit and swap on a render thread
+        if (strcmp(config.args[i], "-renderthread") == 0)
+        {
+            config.renderThread = true;
+        }
+
+        // Presentation: on, off or adaptive
+        if (config.args.count > i+1 && strcmp(config.args[i], "-vsync") == 0)
+        {
+            if (strcmp(config.args[i+1], "off") == 0)
+            {
+                config.presentMode = GraphicsContext::PresentMode::Immediate;
+            }
+            else if (strcmp(config.args[i+1], "adaptive") == 0)
+            {
+                config.presentMode = GraphicsContext::PresentMode::Adaptive;
+            }
+            else
+            {
+                config.presentMode = GraphicsContext::PresentMode::VSync;
+            }
+        }
+
+        // Frame rate limit in Hz
+        if (config.args.count > i+1 && strcmp(config.args[i], "-fpslimit") == 0)
+        {
+            config.frameLimit = static_cast<unsigned>(std::max(0, atoi(config.args[i+1])));
+        }
+
+        // Frames the GPU may fall behind, lower is less latency
+        if (config.args.count > i+1 && strcmp(config.args[i], "-framesinflight") == 0)
+        {
+            config.framesInFlight = static_cast<unsigned>(std::clamp(atoi(config.args[i+1]), 0, 3));
+        }
+
+        // Capture a CPU profile of the first frames
+        if (config.args.count > i+1 && strcmp(config.args[i], "-profile") == 0)
+        {
+            config.profileFrames = static_cast<unsigned>(std::max(0, atoi(config.args[i+1])));
+        }
+
+        // Benchmark a lab headless, with its frame count, warmup frames and report path
+        if (config.args.count > i+1 && strcmp(config.args[i], "-bench") == 0)
+        {
+            config.bench.lab = config.args[i+1];
+            config.initLab = config.bench.lab;
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-frames") == 0)
+        {
+            config.bench.frames = static_cast<unsigned>(std::max(1, atoi(config.args[i+1])));
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-warmup") == 0)
+        {
+            config.bench.warmup = static_cast<unsigned>(std::max(0, atoi(config.args[i+1])));
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-benchout") == 0)
+        {
+            config.bench.output = config.args[i+1];
+        }
+
+        // Compare the last benchmark frame to a golden image, with per channel tolerance
+        if (config.args.count > i+1 && strcmp(config.args[i], "-golden") == 0)
+        {
+            config.bench.golden = config.args[i+1];
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-pixeltol") == 0)
+        {
+            config.bench.pixelTolerance = static_cast<unsigned>(std::clamp(atoi(config.args[i+1]), 0, 255));
+        }
+
+        // Compare benchmark counters to an earlier CSV report, and frame times to one from this machine, tolerances in percent
+        if (config.args.count > i+1 && strcmp(config.args[i], "-baseline") == 0)
+        {
+            config.bench.baseline = config.args[i+1];
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-timebaseline") == 0)
+        {
+            config.bench.timeBaseline = config.args[i+1];
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-timetol") == 0)
+        {
+            config.bench.timeTolerance = std::max(0.0, atof(config.args[i+1])) / 100.0;
+        }
+
+        if (config.args.count > i+1 && strcmp(config.args[i], "-countertol") == 0)
+        {
+            config.bench.counterTolerance = std::max(0.0, atof(config.args[i+1])) / 100.0;
+        }
+
+        // Record the golden image and baseline instead of comparing
+        if (strcmp(config.args[i], "-updategolden") == 0)
+        {
+            config.bench.updateGolden = true;
+        }
+
+        // Seed for labs with random content, benchmarks default to 1
+        if (config.args.count > i+1 && strcmp(config.args[i], "-seed") == 0)
+        {
+            config.seed = static_cast<unsigned>(strtoul(config.args[i+1], nullptr, 10));
+        }
+
+        // Window size as WxH
+        if (config.args.count > i+1 && strcmp(config.args[i], "-size") == 0)
+        {
+            unsigned width { 0 }, height { 0 };
+            if (sscanf(config.args[i+1], "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
+            {
+                config.width = width;
+                config.height = height;
+            }
+        }
+
+        // Report heap allocations in the frame loop
+        if (strcmp(config.args[i], "-checkallocs") == 0)
+        {
+            config.checkAllocations = true;
+        }
+
+        // Attribute heap allocations to profiler scopes
+        if (strcmp(config.args[i], "-trackallocs") == 0)
+        {
+            config.trackAllocations = true;
+        }
+
         // Override Rendering API
         if (Grafik::APIOverride > 0)
         {
@@ -209,5 +592,13 @@ void Application::CheckArgs(Config& config)
 
 Application::~Application()
 {
+    // The UI owns the ImGui context when there is one
+    if (!_ui && ImGui::GetCurrentContext())
+    {
+        ImGui::DestroyContext();
+    }
+
     EventManager::Get()->Reset();
+    SamplerCache::Clear();
+    GpuTimer::Clear();
 }
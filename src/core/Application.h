@@ -4,13 +4,18 @@
  * Copyright 2023 Martin Furuberg
  */
 #pragma once
+#include "core/Benchmark.h"
 #include "core/ComponentManager.h"
+#include "core/FramePacer.h"
 #include "events/EventManager.h"
 #include "events/ApplicationEvent.h"
+#include "renderer/GpuMemory.h"
+#include "renderer/GraphicsContext.h"
 #include "renderer/RendererAPI.h"
 #include "ui/UI.h"
 
 
+class Framebuffer;
 class Window;
 namespace labb { class LLabMenu; }
 
@@ -30,13 +35,25 @@ public:
     
     struct Config
     {
-        std::string         title           { };
-        unsigned            width           { 640 };
-        unsigned            height          { 480 };
-        RendererAPI::API    api             { RendererAPI::API::OpenGL };
-        std::string         initLab         { };
-        bool                wireFrameMode   { false };
-        Args                args            { };
+        std::string         title            { };
+        unsigned            width            { 640 };
+        unsigned            height           { 480 };
+        RendererAPI::API    api              { RendererAPI::API::OpenGL };
+        std::string         initLab          { };
+        bool                wireFrameMode    { false };
+        unsigned            textureBudget    { 256 };    // MB
+        bool                checkAllocations { false };  // debug builds: report heap use in steady frames
+        bool                trackAllocations { false };  // debug builds: attribute heap use to profiler scopes
+        unsigned            fixedTickRate    { 0 };      // Hz, 0 ticks once per frame
+        unsigned            maxTickSteps     { 5 };      // fixed steps per frame before time is dropped
+        bool                renderThread     { false };  // OpenGL: submit and swap on a separate thread
+        GraphicsContext::PresentMode presentMode { GraphicsContext::PresentMode::VSync };
+        unsigned            frameLimit       { 0 };      // Hz, 0 is unlimited
+        unsigned            framesInFlight   { 0 };      // OpenGL: frames the GPU may queue, 1-3, 0 leaves it to the driver
+        unsigned            profileFrames    { 0 };      // capture a CPU profile of the first frames, 0 is off
+        unsigned            seed             { 0 };      // labs' random content, 0 picks one per run
+        Benchmark::Settings bench            { };        // headless run of bench.lab, see Benchmark
+        Args                args             { };
     };
     
     Config _config;
@@ -44,9 +61,13 @@ public:
     Window* _window { };
     labb::LLabMenu* _menu { };
     std::unique_ptr<UI> _ui { };
+    std::unique_ptr<Benchmark> _bench { };
+    std::unique_ptr<Framebuffer> _benchTarget { };      // labs render offscreen while benchmarking
+    FramePacer _pacer { };
+    GpuMemory::Snapshot _gpuMemoryBaseline { };         // before any lab, compared when the last one closes
     inline static Application* _application { };
     
-    Application(Config config = Config());
+    Application(Config config);
     ~Application();
     
     Application(const Application&) = delete;
@@ -57,16 +78,28 @@ public:
     void Init();
     void Run();
 
-    void OnEvent(Event& event);
-
     static Application& Get() { return *_application; }
 
+    // Start a CPU profile capture, or end and write the running one
+    static void ToggleProfileCapture();
+
     [[nodiscard]] Window* GetWindow() const { return _window; }
 
+    // Applied on the thread that owns the context
+    void SetPresentMode(GraphicsContext::PresentMode mode);
+    [[nodiscard]] GraphicsContext::PresentMode GetPresentMode() const;
+
+    void SetFrameLimit(unsigned rate) { _pacer.SetLimit(rate); }
+    [[nodiscard]] const FramePacer& GetFramePacer() const { return _pacer; }
+
 private:
     void InitUI();
     void InitLabs();
 
+    // Broadcast the ticks for a frame, returns the interpolation alpha for rendering it
+    double Tick(double frameTime);
+    double _tickAccumulator { 0 };
+
     void OnWindowClose(WindowCloseEvent& e) const;
     void OnWindowResize(const WindowSizeEvent& e) const;
     void OnFramebufferSize(const FramebufferSizeEvent& e) const;
@@ -0,0 +1,529 @@
+﻿/**
+ * Grafik
+ * Benchmark
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Benchmark.h"
+
+#include "renderer/GpuTimer.h"
+#include "renderer/RendererAPI.h"
+#include "Framebuffer.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+
+namespace
+{
+    // Frame time changes below this are scheduler noise, even when they are large relative to a fast lab
+    constexpr double TimeSlackMs { 0.5 };
+
+    // Nearest rank on sorted values
+    double Percentile(const std::vector<double>& sorted, double percent)
+    {
+        if (sorted.empty()) return 0.0;
+
+        const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    void Add(RenderStats::Counters& total, const RenderStats::Counters& frame)
+    {
+        total.drawCalls         += frame.drawCalls;
+        total.instances         += frame.instances;
+        total.indices           += frame.indices;
+        total.programBinds      += frame.programBinds;
+        total.vertexArrayBinds  += frame.vertexArrayBinds;
+        total.textureBinds      += frame.textureBinds;
+        total.uniformUploads    += frame.uniformUploads;
+        total.clears            += frame.clears;
+        total.bufferBytes       += frame.bufferBytes;
+        total.textureBytes      += frame.textureBytes;
+    }
+
+    RenderStats::Counters Average(const RenderStats::Counters& total, uint32_t frames)
+    {
+        RenderStats::Counters average;
+        average.drawCalls           = total.drawCalls / frames;
+        average.instances           = total.instances / frames;
+        average.indices             = total.indices / frames;
+        average.programBinds        = total.programBinds / frames;
+        average.vertexArrayBinds    = total.vertexArrayBinds / frames;
+        average.textureBinds        = total.textureBinds / frames;
+        average.uniformUploads      = total.uniformUploads / frames;
+        average.clears              = total.clears / frames;
+        average.bufferBytes         = total.bufferBytes / frames;
+        average.textureBytes        = total.textureBytes / frames;
+        return average;
+    }
+
+    // Counter name and value per frame, in report order
+    std::vector<std::pair<const char*, uint64_t>> GetCounterValues(const RenderStats::Counters& counters)
+    {
+        return
+        {
+            { "drawCalls",          counters.drawCalls },
+            { "instances",          counters.instances },
+            { "indices",            counters.indices },
+            { "programBinds",       counters.programBinds },
+            { "vertexArrayBinds",   counters.vertexArrayBinds },
+            { "textureBinds",       counters.textureBinds },
+            { "uniformUploads",     counters.uniformUploads },
+            { "clears",             counters.clears },
+            { "bufferBytes",        counters.bufferBytes },
+            { "textureBytes",       counters.textureBytes },
+        };
+    }
+
+    // Binary PPM, top row first. Alpha is dropped, it isn't shown
+    bool WriteImage(const std::filesystem::path& path, int width, int height, const std::vector<unsigned char>& rgbaBottomUp)
+    {
+        std::error_code error;
+        if (path.has_parent_path())
+        {
+            std::filesystem::create_directories(path.parent_path(), error);
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+
+        out << "P6\n" << width << ' ' << height << "\n255\n";
+        std::vector<unsigned char> row(static_cast<size_t>(width) * 3);
+        for (int y = height - 1; y >= 0; y--)
+        {
+            const unsigned char* source = &rgbaBottomUp[static_cast<size_t>(y) * static_cast<size_t>(width) * 4];
+            for (int x = 0; x < width; x++)
+            {
+                row[x * 3 + 0] = source[x * 4 + 0];
+                row[x * 3 + 1] = source[x * 4 + 1];
+                row[x * 3 + 2] = source[x * 4 + 2];
+            }
+            out.write(reinterpret_cast<const char*>(row.data()), static_cast<std::streamsize>(row.size()));
+        }
+        out.close();
+        return static_cast<bool>(out);
+    }
+
+    bool ReadImage(const std::filesystem::path& path, int& width, int& height, std::vector<unsigned char>& rgb)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+
+        // Header tokens may be separated by comments
+        auto next = [&in](std::string& token)
+        {
+            while (in >> token && token[0] == '#')
+            {
+                in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            }
+            return static_cast<bool>(in);
+        };
+        std::string magic, w, h, maxValue;
+        if (!next(magic) || magic != "P6" || !next(w) || !next(h) || !next(maxValue) || maxValue != "255") return false;
+        in.get();
+
+        width = std::atoi(w.c_str());
+        height = std::atoi(h.c_str());
+        if (width <= 0 || height <= 0) return false;
+
+        rgb.resize(static_cast<size_t>(width) * static_cast<size_t>(height) * 3);
+        in.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        return static_cast<bool>(in);
+    }
+
+    // Metric and value per line of a CSV report
+    std::unordered_map<std::string, std::string> ReadReport(const std::filesystem::path& path)
+    {
+        std::unordered_map<std::string, std::string> values;
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            const size_t comma = line.find(',');
+            if (comma != std::string::npos)
+            {
+                values[line.substr(0, comma)] = line.substr(comma + 1);
+            }
+        }
+        return values;
+    }
+
+    bool GetValue(const std::unordered_map<std::string, std::string>& values, const char* name, double& value)
+    {
+        const auto entry = values.find(name);
+        if (entry == values.end()) return false;
+
+        value = std::strtod(entry->second.c_str(), nullptr);
+        return true;
+    }
+
+    std::filesystem::path WithSuffix(const std::filesystem::path& path, const char* suffix, const char* extension)
+    {
+        std::filesystem::path result = path;
+        result.replace_filename(path.stem().string() + suffix);
+        return result.replace_extension(extension);
+    }
+}
+
+Benchmark::Benchmark(Settings settings, int width, int height)
+    : _settings { std::move(settings) }, _width { width }, _height { height }
+{
+    if (_settings.output.empty())
+    {
+        _settings.output = "bench-" + _settings.lab + ".json";
+    }
+    _frameTimes.reserve(_settings.frames);
+}
+
+void Benchmark::BeginFrame()
+{
+    _frameStart = Profiler::Now();
+
+    if (_frame != _settings.warmup) return;
+
+    _allocationsAtStart = { Memory::GetAllocationCount(), Memory::GetAllocatedBytes() };
+
+    // Pass totals keep growing, only what is added from here on is measured
+    const auto lock = GpuTimer::Lock();
+    for (const GpuTimer::Scope& scope : GpuTimer::GetScopes())
+    {
+        _passesAtStart.push_back({ scope.name, scope.cpuTotal, scope.gpuTotal });
+        _passFramesAtStart.push_back(scope.frames);
+    }
+}
+
+void Benchmark::EndFrame()
+{
+    const int64_t frameEnd = Profiler::Now();
+    if (_frame++ < _settings.warmup) return;
+
+    _frameTimes.push_back(static_cast<double>(frameEnd - _frameStart) / 1e6);
+
+    // The frame rendered before this one, rendering runs ahead of the reports by one frame
+    {
+        const auto lock = RenderStats::Lock();
+        Add(_counterTotals, RenderStats::GetFrame());
+    }
+
+    // Before anything is torn down
+    if (IsDone())
+    {
+        _allocationsAtEnd = { Memory::GetAllocationCount(), Memory::GetAllocatedBytes() };
+        _gpuMemory = GpuMemory::GetSnapshot();
+    }
+}
+
+void Benchmark::Finish(const Framebuffer* target)
+{
+    Result result;
+    result.frames = static_cast<unsigned>(_frameTimes.size());
+    result.gpuMemory = _gpuMemory;
+    if (RendererAPI::GetAPI() == RendererAPI::API::OpenGL)
+    {
+        result.renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    }
+
+    if (!_frameTimes.empty())
+    {
+        std::vector<double> sorted = _frameTimes;
+        std::ranges::sort(sorted);
+        result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / static_cast<double>(sorted.size());
+        result.p50 = Percentile(sorted, 50.0);
+        result.p95 = Percentile(sorted, 95.0);
+        result.p99 = Percentile(sorted, 99.0);
+        result.max = sorted.back();
+
+        result.counters = Average(_counterTotals, result.frames);
+        result.allocations = static_cast<double>(_allocationsAtEnd.count - _allocationsAtStart.count) / result.frames;
+        result.allocatedBytes = static_cast<double>(_allocationsAtEnd.bytes - _allocationsAtStart.bytes) / result.frames;
+    }
+
+    {
+        const auto lock = GpuTimer::Lock();
+        for (const GpuTimer::Scope& scope : GpuTimer::GetScopes())
+        {
+            Pass pass { scope.name, scope.cpuTotal, scope.gpuTotal };
+            unsigned frames = scope.frames;
+
+            const auto start = std::ranges::find(_passesAtStart, pass.name, &Pass::name);
+            if (start != _passesAtStart.end())
+            {
+                pass.cpuTime -= start->cpuTime;
+                pass.gpuTime -= start->gpuTime;
+                frames -= _passFramesAtStart[static_cast<size_t>(start - _passesAtStart.begin())];
+            }
+            if (frames == 0) continue;
+
+            pass.cpuTime /= frames;
+            pass.gpuTime /= frames;
+            result.passes.push_back(std::move(pass));
+        }
+    }
+
+    Log::Info("Benchmark: {} frames of {}, mean {:.3f} ms, p50 {:.3f} ms, p95 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms",
+        result.frames, _settings.lab, result.mean, result.p50, result.p95, result.p99, result.max);
+    for (const Pass& pass : result.passes)
+    {
+        Log::Info("Benchmark: {:<20} CPU {:.3f} ms, GPU {:.3f} ms", pass.name, pass.cpuTime, pass.gpuTime);
+    }
+    if constexpr (Memory::IsTracking)
+    {
+        Log::Info("Benchmark: {:.1f} heap allocations, {:.0f} bytes per frame", result.allocations, result.allocatedBytes);
+    }
+
+    if (!Write(result, _settings.output))
+    {
+        throw std::runtime_error("Unable to write benchmark report to " + _settings.output);
+    }
+    Log::Info("Benchmark: Wrote {}", _settings.output);
+
+    // Record this run as the reference
+    if (_settings.updateGolden)
+    {
+        if (!_settings.golden.empty())
+        {
+            if (!target || !WriteImage(_settings.golden, target->GetWidth(), target->GetHeight(), target->ReadPixels()))
+            {
+                throw std::runtime_error("Unable to write golden image to " + _settings.golden);
+            }
+            Log::Info("Benchmark: Wrote {}", _settings.golden);
+        }
+        if (!_settings.baseline.empty())
+        {
+            // Times would only hold on this machine, they come from a time baseline of its own
+            if (!Write(result, _settings.baseline, false))
+            {
+                throw std::runtime_error("Unable to write baseline to " + _settings.baseline);
+            }
+            Log::Info("Benchmark: Wrote {}", _settings.baseline);
+        }
+        return;
+    }
+
+    std::vector<std::string> failures = CheckImage(target);
+    std::ranges::move(CheckBaseline(result), std::back_inserter(failures));
+    for (const std::string& failure : failures)
+    {
+        Log::Error("Benchmark: {}", failure);
+    }
+    if (!failures.empty())
+    {
+        throw std::runtime_error(std::to_string(failures.size()) + " benchmark check(s) of " + _settings.lab + " failed");
+    }
+}
+
+std::vector<std::string> Benchmark::CheckImage(const Framebuffer* target) const
+{
+    if (_settings.golden.empty()) return { };
+    if (!target) return { "No render target to compare, golden images need OpenGL" };
+
+    int width { 0 }, height { 0 };
+    std::vector<unsigned char> golden;
+    if (!ReadImage(_settings.golden, width, height, golden))
+    {
+        return { "Unable to read golden image " + _settings.golden + ", record one with -updategolden" };
+    }
+    if (width != target->GetWidth() || height != target->GetHeight())
+    {
+        return { "Golden image is " + std::to_string(width) + "x" + std::to_string(height) + ", the run was "
+            + std::to_string(target->GetWidth()) + "x" + std::to_string(target->GetHeight()) };
+    }
+
+    // The target's rows are bottom up, the image's top down
+    const std::vector<unsigned char> pixels = target->ReadPixels();
+    size_t differing { 0 };
+    int largest { 0 };
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* actual = &pixels[static_cast<size_t>(height - 1 - y) * static_cast<size_t>(width) * 4];
+        const unsigned char* expected = &golden[static_cast<size_t>(y) * static_cast<size_t>(width) * 3];
+        for (int x = 0; x < width; x++)
+        {
+            int difference { 0 };
+            for (int c = 0; c < 3; c++)
+            {
+                difference = std::max(difference, std::abs(actual[x * 4 + c] - expected[x * 3 + c]));
+            }
+            largest = std::max(largest, difference);
+            if (difference > static_cast<int>(_settings.pixelTolerance)) differing++;
+        }
+    }
+
+    const size_t count = static_cast<size_t>(width) * static_cast<size_t>(height);
+    Log::Info("Benchmark: {} of {} pixels differ by more than {}, largest difference {}", differing, count, _settings.pixelTolerance, largest);
+    if (static_cast<double>(differing) <= _settings.pixelFraction * static_cast<double>(count)) return { };
+
+    // Keep what was rendered next to the report to look at
+    const std::filesystem::path actualPath = WithSuffix(_settings.output, "-actual", ".ppm");
+    WriteImage(actualPath, width, height, pixels);
+    return { std::to_string(differing) + " pixels differ from " + _settings.golden + ", see " + actualPath.string() };
+}
+
+std::vector<std::string> Benchmark::CheckBaseline(const Result& result) const
+{
+    std::vector<std::string> failures;
+    char line[256];
+
+    // Counters don't depend on the machine and should only change on purpose
+    if (!_settings.baseline.empty())
+    {
+        const auto values = ReadReport(_settings.baseline);
+        if (values.empty())
+        {
+            failures.push_back("Unable to read baseline " + _settings.baseline + ", it should be a CSV report");
+        }
+        for (const auto& [name, value] : GetCounterValues(result.counters))
+        {
+            double expected { 0.0 };
+            if (GetValue(values, name, expected) && std::abs(static_cast<double>(value) - expected) > _settings.counterTolerance * expected)
+            {
+                std::snprintf(line, sizeof(line), "%s %llu, baseline %.0f", name, static_cast<unsigned long long>(value), expected);
+                failures.emplace_back(line);
+            }
+        }
+    }
+
+    // Frame times only hold on the machine and renderer they were recorded on
+    if (!_settings.timeBaseline.empty())
+    {
+        const auto values = ReadReport(_settings.timeBaseline);
+        const auto renderer = values.find("renderer");
+        if (values.empty())
+        {
+            failures.push_back("Unable to read time baseline " + _settings.timeBaseline + ", it should be a CSV report");
+        }
+        else if (renderer != values.end() && renderer->second != result.renderer)
+        {
+            Log::Warn("Benchmark: Time baseline was recorded on '{}', this run is on '{}', skipping frame times", renderer->second, result.renderer);
+        }
+        else
+        {
+            // Slower is a regression, faster is not
+            const std::pair<const char*, double> times[] = { { "frameMean", result.mean }, { "frameP50", result.p50 } };
+            for (const auto& [name, value] : times)
+            {
+                double expected { 0.0 };
+                if (GetValue(values, name, expected) && value > expected * (1.0 + _settings.timeTolerance) + TimeSlackMs)
+                {
+                    std::snprintf(line, sizeof(line), "%s %.3f ms, baseline %.3f ms (+%.1f%%)", name, value, expected, (value / expected - 1.0) * 100.0);
+                    failures.emplace_back(line);
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+bool Benchmark::Write(const Result& result, const std::string& file, bool bTimes) const
+{
+    std::error_code error;
+    const std::filesystem::path path { file };
+    if (path.has_parent_path())
+    {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) return false;
+
+    char line[256];
+    if (path.extension() == ".csv")
+    {
+        out << "metric,value\n";
+        std::snprintf(line, sizeof(line), "lab,%s\nwidth,%d\nheight,%d\nframes,%u\nwarmup,%u\n",
+            _settings.lab.c_str(), _width, _height, result.frames, _settings.warmup);
+        out << line;
+        out << "renderer," << result.renderer << '\n';
+        if (bTimes)
+        {
+            std::snprintf(line, sizeof(line), "frameMean,%.4f\nframeP50,%.4f\nframeP95,%.4f\nframeP99,%.4f\nframeMax,%.4f\n",
+                result.mean, result.p50, result.p95, result.p99, result.max);
+            out << line;
+            for (const Pass& pass : result.passes)
+            {
+                out << "cpu." << pass.name << ',' << pass.cpuTime << '\n';
+                out << "gpu." << pass.name << ',' << pass.gpuTime << '\n';
+            }
+        }
+        for (const auto& [name, value] : GetCounterValues(result.counters))
+        {
+            out << name << ',' << value << '\n';
+        }
+        // Builds without tracking never measured the heap, leave it out rather than claim zero
+        if constexpr (Memory::IsTracking)
+        {
+            std::snprintf(line, sizeof(line), "heapAllocations,%.2f\nheapBytes,%.0f\n", result.allocations, result.allocatedBytes);
+            out << line;
+        }
+        for (size_t i = 0; i < GpuMemory::ResourceCount; i++)
+        {
+            out << "gpuMemory." << GpuMemory::GetResourceString(static_cast<GpuMemory::Resource>(i)) << ','
+                << result.gpuMemory[i].bytes << '\n';
+        }
+    }
+    else
+    {
+        std::snprintf(line, sizeof(line), "{\n  \"lab\": \"%s\",\n  \"width\": %d,\n  \"height\": %d,\n  \"frames\": %u,\n  \"warmup\": %u,\n",
+            _settings.lab.c_str(), _width, _height, result.frames, _settings.warmup);
+        out << line;
+        out << "  \"renderer\": \"" << result.renderer << "\",\n";
+        if (bTimes)
+        {
+            std::snprintf(line, sizeof(line),
+                "  \"frameTime\": { \"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+                result.mean, result.p50, result.p95, result.p99, result.max);
+            out << line;
+
+            out << "  \"passes\": [";
+            for (size_t i = 0; i < result.passes.size(); i++)
+            {
+                const Pass& pass = result.passes[i];
+                std::snprintf(line, sizeof(line), "%s\n    { \"name\": \"%s\", \"cpu\": %.4f, \"gpu\": %.4f }",
+                    i ? "," : "", pass.name.c_str(), pass.cpuTime, pass.gpuTime);
+                out << line;
+            }
+            out << "\n  ],\n";
+        }
+        out << "  \"counters\": {";
+
+        const auto counters = GetCounterValues(result.counters);
+        for (size_t i = 0; i < counters.size(); i++)
+        {
+            out << (i ? "," : "") << "\n    \"" << counters[i].first << "\": " << counters[i].second;
+        }
+        out << "\n  },\n";
+
+        if constexpr (Memory::IsTracking)
+        {
+            std::snprintf(line, sizeof(line), "  \"heap\": { \"allocations\": %.2f, \"bytes\": %.0f },\n",
+                result.allocations, result.allocatedBytes);
+            out << line;
+        }
+        else
+        {
+            out << "  \"heap\": null,\n";
+        }
+        out << "  \"gpuMemory\": [";
+        for (size_t i = 0; i < GpuMemory::ResourceCount; i++)
+        {
+            const std::string_view name = GpuMemory::GetResourceString(static_cast<GpuMemory::Resource>(i));
+            std::snprintf(line, sizeof(line), "%s\n    { \"resource\": \"%.*s\", \"count\": %lld, \"bytes\": %lld }",
+                i ? "," : "", static_cast<int>(name.size()), name.data(),
+                static_cast<long long>(result.gpuMemory[i].count), static_cast<long long>(result.gpuMemory[i].bytes));
+            out << line;
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    out.close();
+    return static_cast<bool>(out);
+}
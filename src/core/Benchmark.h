@@ -0,0 +1,95 @@
+﻿/**
+ * Grafik
+ * Benchmark
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "core/Memory.h"
+#include "renderer/GpuMemory.h"
+#include "renderer/RenderStats.h"
+
+
+class Framebuffer;
+
+/**
+ * Headless run of a single lab for a fixed number of frames. Collects frame times after a warmup,
+ * the CPU/GPU time of every timed pass, the renderer counters, heap allocations (tracking builds) and
+ * GPU memory held at the end, and writes a JSON or CSV report.
+ * Optionally verifies the run: the last frame against a golden image, counters against a baseline, and
+ * frame times against the CSV report of an earlier run on the same machine. Any failed check makes Finish
+ * throw once the report is written.
+ */
+class Benchmark
+{
+public:
+    struct Settings
+    {
+        std::string     lab         { };        // lab shortname, empty runs normally
+        unsigned        frames      { 300 };    // measured frames
+        unsigned        warmup      { 60 };     // frames run before measuring
+        std::string     output      { };        // .csv writes CSV, anything else JSON
+
+        std::string     golden          { };        // reference image of the last frame (.ppm), empty skips it
+        bool            updateGolden    { false };  // write the golden image and baseline (no times) instead of comparing
+        unsigned        pixelTolerance  { 2 };      // per channel difference still counted as equal
+        double          pixelFraction   { 0.001 };  // share of pixels allowed to differ by more
+        std::string     baseline        { };        // CSV report of an earlier run, its counters are checked
+        std::string     timeBaseline    { };        // CSV report of an earlier run on this machine, its frame times are checked
+        double          timeTolerance   { 0.25 };   // allowed frame time increase, fraction of the time baseline
+        double          counterTolerance{ 0.0 };    // allowed counter change either way, fraction of the baseline
+    };
+
+    struct Pass
+    {
+        std::string name { };
+        double cpuTime { 0.0 };     // ms per frame
+        double gpuTime { 0.0 };
+    };
+
+    struct Result
+    {
+        unsigned frames { 0 };
+        double mean { 0.0 };        // frame time, ms
+        double p50 { 0.0 };
+        double p95 { 0.0 };
+        double p99 { 0.0 };
+        double max { 0.0 };
+        std::vector<Pass> passes { };
+        RenderStats::Counters counters { };     // per frame average
+        double allocations { 0.0 };             // heap, per frame
+        double allocatedBytes { 0.0 };
+        GpuMemory::Snapshot gpuMemory { };
+        std::string renderer { };
+    };
+
+    Benchmark(Settings settings, int width, int height);
+
+    void BeginFrame();
+    void EndFrame();
+
+    [[nodiscard]] bool IsDone() const { return _frame >= _settings.warmup + _settings.frames; }
+
+    // Call once done, computes the result, writes the report and runs the checks on what target holds
+    void Finish(const Framebuffer* target);
+
+private:
+    // Without times the report is a baseline that holds on any machine
+    [[nodiscard]] bool Write(const Result& result, const std::string& path, bool bTimes = true) const;
+
+    // Return the failures, empty when passed
+    [[nodiscard]] std::vector<std::string> CheckImage(const Framebuffer* target) const;
+    [[nodiscard]] std::vector<std::string> CheckBaseline(const Result& result) const;
+
+    Settings _settings;
+    int _width;
+    int _height;
+    unsigned _frame { 0 };
+    int64_t _frameStart { 0 };
+    std::vector<double> _frameTimes { };
+    std::vector<Pass> _passesAtStart { };       // GPU timer totals when measuring began
+    std::vector<unsigned> _passFramesAtStart { };
+    RenderStats::Counters _counterTotals { };
+    Memory::FrameAllocations _allocationsAtStart { };
+    Memory::FrameAllocations _allocationsAtEnd { };
+    GpuMemory::Snapshot _gpuMemory { };
+};
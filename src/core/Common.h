@@ -26,6 +26,11 @@ namespace Grafik
     {
         Log::Init(LoggingLevel);
     }
+
+    inline void Shutdown()
+    {
+        Log::Shutdown();
+    }
 }
 
 #define BIT(x) (1 << x)
@@ -1,6 +1,6 @@
 ﻿/**
  * Grafik
- * LayerManager
+ * ComponentManager
  * Copyright 2023 Martin Furuberg
  */
 #include "gpch.h"
@@ -9,42 +9,105 @@
 #include "events/EventManager.h"
 
 
-void ComponentManager::Attach(Component* comp)
+ComponentHandle ComponentManager::Attach(Component* comp)
 {
-    _comps.emplace_back(comp);
+    const ComponentHandle handle = Insert(std::unique_ptr<Component>(comp));
 
     const auto manager = EventManager::Get();
-    int& categoryMask = manager->addListener(comp, GK_BIND_EVENT_HANDLER_EXTERN(comp, OnEvent));
     comp->events = manager;
 
+    // Listen before OnAttach, so the category listener is called ahead of typed listeners added there.
+    // The mask is only known once OnAttach has chosen it
+    manager->addListener<&Component::OnEvent>(comp, Event::None);
+    int categoryMask { Event::None };
     comp->OnAttach(categoryMask);
+    manager->setCategoryMask(comp, categoryMask);
+    return handle;
 }
 
-void ComponentManager::Detach(Component* comp)
+ComponentHandle ComponentManager::Insert(std::unique_ptr<Component> comp)
 {
-    auto compare = [&comp](const std::unique_ptr<Component>& c) { return c.get() == comp; };
-    const auto result = std::ranges::find_if(_comps, compare);
-    if (result != _comps.end())
+    uint32_t index;
+    if (!_freeSlots.empty())
     {
-        const auto manager = EventManager::Get();
-        manager->removeListener(comp);
-        comp->OnDetach();
-        _comps.erase(result);
+        index = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(_slots.size());
+        _slots.emplace_back();
     }
+
+    Slot& slot = _slots[index];
+    slot.dense = static_cast<uint32_t>(_comps.size());
+    comp->_handle = { index, slot.generation };
+    _comps.push_back(std::move(comp));
+    return _comps.back()->_handle;
+}
+
+bool ComponentManager::Detach(Component* comp)
+{
+    if (!comp || comp->_detaching || !IsValid(comp->_handle)) return false;
+
+    // Handles go stale now, the component itself lives until Clean
+    comp->_detaching = true;
+    _slots[comp->_handle.index].generation++;
+    _pending.push_back(comp);
+    return true;
+}
+
+bool ComponentManager::IsValid(ComponentHandle handle) const
+{
+    return handle.index < _slots.size() && _slots[handle.index].generation == handle.generation;
+}
+
+Component* ComponentManager::Get(ComponentHandle handle) const
+{
+    return IsValid(handle) ? _comps[_slots[handle.index].dense].get() : nullptr;
 }
 
 bool ComponentManager::Clean()
 {
-    bool cleaned { false };
     for (const auto& component : _comps)
     {
-        if (component && !component->IsAlive())
+        if (!component->IsAlive())
         {
             Detach(component.get());
-            cleaned = true;
         }
     }
-    return cleaned;
+    if (_pending.empty()) return false;
+
+    // One pass over the listeners for the whole batch
+    _pendingListeners.assign(_pending.begin(), _pending.end());
+    EventManager::Get()->removeListeners(_pendingListeners);
+
+    for (Component* comp : _pending)
+    {
+        comp->OnDetach();
+        Remove(comp);
+    }
+    _pending.clear();
+    return true;
+}
+
+bool ComponentManager::HasRemovals() const
+{
+    return !_pending.empty() || std::ranges::any_of(_comps, [](const auto& component) { return !component->IsAlive(); });
+}
+
+void ComponentManager::Remove(Component* comp)
+{
+    const uint32_t index = comp->_handle.index;
+    const uint32_t dense = _slots[index].dense;
+    const uint32_t last = static_cast<uint32_t>(_comps.size() - 1);
+    if (dense != last)
+    {
+        _comps[dense] = std::move(_comps[last]);
+        _slots[_comps[dense]->_handle.index].dense = dense;
+    }
+    _comps.pop_back();
+    _freeSlots.push_back(index);
 }
 
 ComponentManager::~ComponentManager()
@@ -7,6 +7,11 @@
 #include "components/Component.h"
 
 
+/**
+ * Owns components in a dense array for iteration, with a slot table behind the handles.
+ * Detach only queues the component; Clean applies all queued removals at the end of the frame,
+ * removing their listeners in one pass and swap-and-popping them out of the array.
+ */
 class ComponentManager
 {
 public:
@@ -20,10 +25,20 @@ public:
 
     template <class T>
     T* Create(auto&& ... args);
-    void Attach(Component* comp);
-    void Detach(Component* comp);
+    ComponentHandle Attach(Component* comp);
+    bool Detach(Component* comp);
+    bool Detach(ComponentHandle handle) { return Detach(Get(handle)); }
 
+    // Queue components that closed themselves and apply every queued removal, true if any were removed
     bool Clean();
+    [[nodiscard]] bool HasRemovals() const;
+
+    [[nodiscard]] bool IsValid(ComponentHandle handle) const;
+
+    // nullptr if the handle is stale or not a T
+    [[nodiscard]] Component* Get(ComponentHandle handle) const;
+    template <class T>
+    [[nodiscard]] T* Get(ComponentHandle handle) const { return dynamic_cast<T*>(Get(handle)); }
 
     [[nodiscard]] size_t GetCount() const { return _comps.size(); } 
 
@@ -33,7 +48,20 @@ public:
     [[nodiscard]] std::vector<std::unique_ptr<Component>>::const_iterator end() const { return _comps.end(); }
 
 private:
+    struct Slot
+    {
+        uint32_t dense { 0 };       // position in _comps
+        uint32_t generation { 0 };
+    };
+
     std::vector<std::unique_ptr<Component>> _comps { };
+    std::vector<Slot> _slots { };
+    std::vector<uint32_t> _freeSlots { };
+    std::vector<Component*> _pending { };
+    std::vector<const void*> _pendingListeners { };
+
+    ComponentHandle Insert(std::unique_ptr<Component> comp);
+    void Remove(Component* comp);
 };
 
 template <class T>
@@ -41,13 +69,7 @@ T* ComponentManager::Create(auto&& ... args)
 {
     static_assert(std::is_base_of_v<Component, T>); // make sure it's a component
     
-    _comps.emplace_back(std::make_unique<T>(std::forward<decltype(args)>(args)...));
-    auto comp = static_cast<T*>(_comps.back().get());
-
-    const auto manager = EventManager::Get();
-    int& categoryMask = manager->addListener(comp, GK_BIND_EVENT_HANDLER_EXTERN(comp, OnEvent));
-    comp->events = manager;
-
-    comp->OnAttach(categoryMask);
+    auto comp = new T(std::forward<decltype(args)>(args)...);
+    Attach(comp);
     return comp;
-}
\ No newline at end of file
+}
@@ -0,0 +1,125 @@
+﻿/**
+ * Grafik
+ * FramePacer
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+#ifdef GK_WIN
+    #include <timeapi.h>
+#endif
+
+
+FramePacer::~FramePacer()
+{
+    SetLimit(0);
+}
+
+void FramePacer::SetLimit(unsigned rate)
+{
+    if (rate == _limit) return;
+
+#ifdef GK_WIN
+    // Default timer resolution is around 15 ms, too coarse to sleep through part of a frame
+    if (_limit == 0) timeBeginPeriod(1);
+    if (rate == 0) timeEndPeriod(1);
+#endif
+
+    _limit = rate;
+    _deadline = Clock::now();
+}
+
+void FramePacer::EndFrame()
+{
+    if (_limit > 0)
+    {
+        Wait();
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (_frames++ > 0)
+    {
+        _offset = (_offset + 1) % HistorySize;
+        _frameTimes[_offset] = std::chrono::duration<float, std::milli>(now - _lastFrame).count();
+    }
+    _lastFrame = now;
+}
+
+void FramePacer::Wait()
+{
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / _limit));
+    Clock::time_point deadline = _deadline + period;
+
+    // Too far behind to catch up, start over from now rather than running unlimited for a while
+    Clock::time_point now = Clock::now();
+    if (now > deadline + period)
+    {
+        deadline = now;
+    }
+
+    // Sleep while a sleep is unlikely to overshoot the deadline
+    const double sleepLength = _sleepMean + std::sqrt(_sleepM2 / static_cast<double>(_sleepCount));
+    while (static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count()) > sleepLength)
+    {
+        SleepOnce();
+        now = Clock::now();
+    }
+
+    // Spin the rest
+    while (Clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
+    _deadline = deadline;
+}
+
+void FramePacer::SleepOnce()
+{
+    const Clock::time_point start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    const double observed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+
+    // Running mean and variance of the observed sleep
+    _sleepCount++;
+    const double delta = observed - _sleepMean;
+    _sleepMean += delta / static_cast<double>(_sleepCount);
+    _sleepM2 += delta * (observed - _sleepMean);
+}
+
+double FramePacer::GetMean() const
+{
+    const unsigned count = std::min(_frames > 0 ? _frames - 1 : 0, HistorySize);
+    if (count == 0) return 0.0;
+
+    double total { 0.0 };
+    for (unsigned i = 0; i < count; i++)
+    {
+        total += _frameTimes[(_offset + HistorySize - i) % HistorySize];
+    }
+    return total / count;
+}
+
+double FramePacer::GetDeviation() const
+{
+    const unsigned count = std::min(_frames > 0 ? _frames - 1 : 0, HistorySize);
+    if (count < 2) return 0.0;
+
+    const double mean = GetMean();
+    double total { 0.0 };
+    for (unsigned i = 0; i < count; i++)
+    {
+        const double delta = _frameTimes[(_offset + HistorySize - i) % HistorySize] - mean;
+        total += delta * delta;
+    }
+    return std::sqrt(total / (count - 1));
+}
+
+double FramePacer::GetMax() const
+{
+    return *std::ranges::max_element(_frameTimes);
+}
@@ -0,0 +1,59 @@
+﻿/**
+ * Grafik
+ * FramePacer
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <chrono>
+
+
+/**
+ * Optional software frame limiter and frame time statistics. Waiting sleeps while the remaining time
+ * is comfortably above what a sleep has been observed to take, then spins to the deadline, so frames
+ * land on time without burning a core for the whole wait.
+ */
+class FramePacer
+{
+public:
+    static constexpr unsigned HistorySize { 120 };
+
+    FramePacer() = default;
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Frames per second, 0 runs unlimited
+    void SetLimit(unsigned rate);
+    [[nodiscard]] unsigned GetLimit() const { return _limit; }
+
+    // Call once per frame after presenting, waits out the rest of the frame when limited
+    void EndFrame();
+
+    // Over the last HistorySize frames, ms
+    [[nodiscard]] double GetMean() const;
+    [[nodiscard]] double GetDeviation() const;
+    [[nodiscard]] double GetMax() const;
+    [[nodiscard]] const std::array<float, HistorySize>& GetFrameTimes() const { return _frameTimes; }
+    [[nodiscard]] unsigned GetOffset() const { return _offset; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void Wait();
+    void SleepOnce();
+
+    unsigned _limit { 0 };
+    Clock::time_point _deadline { };
+    Clock::time_point _lastFrame { };
+
+    // Observed length of a 1 ms sleep, ns
+    double _sleepMean { 1e6 };
+    double _sleepM2 { 0.0 };
+    uint64_t _sleepCount { 1 };
+
+    std::array<float, HistorySize> _frameTimes { };     // ring, newest at _offset
+    unsigned _offset { 0 };
+    unsigned _frames { 0 };
+};
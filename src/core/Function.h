@@ -0,0 +1,139 @@
+﻿/**
+ * Grafik
+ * Function
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <new>
+
+
+template <typename Signature, size_t Size = 32>
+class InplaceFunction;
+
+/**
+ * Owning callable wrapper like std::function, but the callable always lives in a fixed inline buffer.
+ * Callables that don't fit fail to compile instead of falling back to the heap.
+ */
+template <typename R, typename... Args, size_t Size>
+class InplaceFunction<R(Args...), Size>
+{
+    enum class Operation { Copy, Move, Destroy };
+
+public:
+    InplaceFunction() = default;
+
+    template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, InplaceFunction> && std::is_invocable_r_v<R, std::remove_cvref_t<F>&, Args...>)
+    InplaceFunction(F&& callable)
+    {
+        using Callable = std::remove_cvref_t<F>;
+        static_assert(sizeof(Callable) <= Size, "Callable too large for InplaceFunction");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t));
+
+        new (_buffer) Callable(std::forward<F>(callable));
+        _invoke = [](void* object, Args&&... args) -> R
+        {
+            return std::invoke(*static_cast<Callable*>(object), std::forward<Args>(args)...);
+        };
+        _manage = [](Operation operation, void* dst, void* src)
+        {
+            switch (operation)
+            {
+                case Operation::Copy:       new (dst) Callable(*static_cast<const Callable*>(src)); break;
+                case Operation::Move:       new (dst) Callable(std::move(*static_cast<Callable*>(src))); break;
+                case Operation::Destroy:    static_cast<Callable*>(dst)->~Callable(); break;
+            }
+        };
+    }
+
+    InplaceFunction(const InplaceFunction& other)
+        : _invoke { other._invoke }, _manage { other._manage }
+    {
+        if (_manage) _manage(Operation::Copy, _buffer, const_cast<std::byte*>(other._buffer));
+    }
+
+    InplaceFunction(InplaceFunction&& other) noexcept
+        : _invoke { other._invoke }, _manage { other._manage }
+    {
+        if (_manage) _manage(Operation::Move, _buffer, other._buffer);
+    }
+
+    InplaceFunction& operator=(const InplaceFunction& other)
+    {
+        if (this != &other)
+        {
+            Reset();
+            _invoke = other._invoke;
+            _manage = other._manage;
+            if (_manage) _manage(Operation::Copy, _buffer, const_cast<std::byte*>(other._buffer));
+        }
+        return *this;
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            _invoke = other._invoke;
+            _manage = other._manage;
+            if (_manage) _manage(Operation::Move, _buffer, other._buffer);
+        }
+        return *this;
+    }
+
+    ~InplaceFunction() { Reset(); }
+
+    R operator()(Args... args) const
+    {
+        return _invoke(const_cast<std::byte*>(_buffer), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const { return _invoke != nullptr; }
+
+    void Reset()
+    {
+        if (_manage) _manage(Operation::Destroy, _buffer, nullptr);
+        _invoke = nullptr;
+        _manage = nullptr;
+    }
+
+private:
+    alignas(std::max_align_t) std::byte _buffer[Size];
+    R (*_invoke)(void*, Args&&...) { nullptr };
+    void (*_manage)(Operation, void*, void*) { nullptr };
+};
+
+template <typename Signature>
+class FunctionRef;
+
+/**
+ * Non-owning reference to a callable, two pointers wide. The callable must outlive the reference,
+ * which makes it suited for parameters that are only called during the call.
+ */
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)>
+{
+public:
+    template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, FunctionRef> && std::is_object_v<std::remove_reference_t<F>>
+            && std::is_invocable_r_v<R, F&, Args...>)
+    FunctionRef(F&& callable) noexcept
+        : _object { const_cast<void*>(static_cast<const void*>(std::addressof(callable))) }
+        , _invoke { [](void* object, Args&&... args) -> R
+            {
+                return std::invoke(*static_cast<std::remove_reference_t<F>*>(object), std::forward<Args>(args)...);
+            } } { }
+
+    R operator()(Args... args) const
+    {
+        return _invoke(_object, std::forward<Args>(args)...);
+    }
+
+private:
+    void* _object;
+    R (*_invoke)(void*, Args&&...);
+};
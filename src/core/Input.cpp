@@ -0,0 +1,253 @@
+﻿/**
+ * Grafik
+ * Input
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Input.h"
+
+#include "events/EventManager.h"
+
+#include <GLFW/glfw3.h>
+
+
+namespace
+{
+    enum class SampleType : uint8_t { Key, Char, Button, Move, Scroll };
+
+    struct Sample
+    {
+        SampleType type { SampleType::Key };
+        InputAction action { InputAction::Release };
+        int code { 0 };         // key, button or codepoint
+        int scancode { 0 };
+        int mods { 0 };
+        unsigned count { 1 };   // merged moves
+        double time { 0 };
+        double x { 0 }, y { 0 };                // position or scroll offset
+        double deltaX { 0 }, deltaY { 0 };
+    };
+
+    constexpr size_t KeyCount { 512 };
+    constexpr size_t ButtonCount { 8 };
+
+    std::array<Sample, Input::Capacity> samples { };
+    size_t head { 0 };
+    size_t count { 0 };
+
+    std::array<bool, KeyCount> keysDown { };
+    std::array<bool, KeyCount> keysPressed { };
+    std::array<bool, ButtonCount> buttonsDown { };
+    std::array<bool, ButtonCount> buttonsPressed { };
+
+    double cursorX { 0 }, cursorY { 0 };   // as last pushed, for move deltas
+    glm::vec2 mousePosition { 0.0f };
+    glm::vec2 mouseDelta { 0.0f };
+    glm::vec2 scrollDelta { 0.0f };
+    double lastSampleTime { 0 };
+    bool pumpEvents { true };
+
+    void Apply(const Sample& sample)
+    {
+        lastSampleTime = sample.time;
+        switch (sample.type)
+        {
+            case SampleType::Key:
+                if (sample.code >= 0 && static_cast<size_t>(sample.code) < KeyCount)
+                {
+                    keysDown[sample.code] = sample.action != InputAction::Release;
+                    keysPressed[sample.code] |= sample.action == InputAction::Press;
+                }
+                break;
+            case SampleType::Button:
+                if (sample.code >= 0 && static_cast<size_t>(sample.code) < ButtonCount)
+                {
+                    buttonsDown[sample.code] = sample.action != InputAction::Release;
+                    buttonsPressed[sample.code] |= sample.action == InputAction::Press;
+                }
+                break;
+            case SampleType::Move:
+                mousePosition = { static_cast<float>(sample.x), static_cast<float>(sample.y) };
+                mouseDelta += glm::vec2 { static_cast<float>(sample.deltaX), static_cast<float>(sample.deltaY) };
+                break;
+            case SampleType::Scroll:
+                scrollDelta += glm::vec2 { static_cast<float>(sample.x), static_cast<float>(sample.y) };
+                break;
+            case SampleType::Char:
+                break;
+        }
+    }
+
+    void Broadcast(const Sample& sample)
+    {
+        const auto events = EventManager::Get();
+        switch (sample.type)
+        {
+            case SampleType::Key:
+            {
+                KeyEvent event { sample.time, sample.code, sample.scancode, sample.action, sample.mods };
+                events->Broadcast(event);
+                break;
+            }
+            case SampleType::Char:
+            {
+                KeyCharEvent event { sample.time, static_cast<unsigned>(sample.code) };
+                events->Broadcast(event);
+                break;
+            }
+            case SampleType::Button:
+            {
+                MouseButtonEvent event { sample.time, sample.code, sample.action, sample.mods, sample.x, sample.y };
+                events->Broadcast(event);
+                break;
+            }
+            case SampleType::Move:
+            {
+                MouseMoveEvent event { sample.time, sample.x, sample.y, sample.deltaX, sample.deltaY, sample.count };
+                events->Broadcast(event);
+                break;
+            }
+            case SampleType::Scroll:
+            {
+                MouseScrollEvent event { sample.time, sample.x, sample.y };
+                events->Broadcast(event);
+                break;
+            }
+        }
+    }
+
+    void Flush()
+    {
+        // Handlers may cause more input to be pushed, only take what is here now
+        for (size_t remaining = count; remaining > 0; remaining--)
+        {
+            const Sample sample = samples[head];
+            head = (head + 1) % Input::Capacity;
+            count--;
+
+            Apply(sample);
+            Broadcast(sample);
+        }
+    }
+
+    void Push(const Sample& sample)
+    {
+        // Full, hand out what we have rather than lose a release
+        if (count == Input::Capacity)
+        {
+            Flush();
+        }
+
+        Sample& slot = samples[(head + count) % Input::Capacity];
+        slot = sample;
+        slot.time = glfwGetTime();
+        count++;
+    }
+}
+
+void Input::PushKey(int key, int scancode, int action, int mods)
+{
+    Push({ .type = SampleType::Key, .action = static_cast<InputAction>(action), .code = key, .scancode = scancode, .mods = mods });
+}
+
+void Input::PushChar(unsigned codepoint)
+{
+    Push({ .type = SampleType::Char, .code = static_cast<int>(codepoint) });
+}
+
+void Input::PushButton(int button, int action, int mods)
+{
+    Push({ .type = SampleType::Button, .action = static_cast<InputAction>(action), .code = button, .mods = mods, .x = cursorX, .y = cursorY });
+}
+
+void Input::PushMove(double x, double y)
+{
+    const double deltaX = x - cursorX;
+    const double deltaY = y - cursorY;
+    cursorX = x;
+    cursorY = y;
+
+    // Extend the newest sample if it is a move too
+    if (count > 0)
+    {
+        Sample& last = samples[(head + count - 1) % Capacity];
+        if (last.type == SampleType::Move)
+        {
+            last.time = glfwGetTime();
+            last.x = x;
+            last.y = y;
+            last.deltaX += deltaX;
+            last.deltaY += deltaY;
+            last.count++;
+            return;
+        }
+    }
+    Push({ .type = SampleType::Move, .x = x, .y = y, .deltaX = deltaX, .deltaY = deltaY });
+}
+
+void Input::PushScroll(double offsetX, double offsetY)
+{
+    Push({ .type = SampleType::Scroll, .x = offsetX, .y = offsetY });
+}
+
+void Input::BeginFrame()
+{
+    keysPressed.fill(false);
+    buttonsPressed.fill(false);
+    mouseDelta = glm::vec2 { 0.0f };
+    scrollDelta = glm::vec2 { 0.0f };
+}
+
+void Input::Poll()
+{
+    if (pumpEvents)
+    {
+        glfwPollEvents();
+    }
+    Flush();
+}
+
+void Input::SetPumpEvents(bool bPump)
+{
+    pumpEvents = bPump;
+}
+
+bool Input::IsKeyDown(int key)
+{
+    return key >= 0 && static_cast<size_t>(key) < KeyCount && keysDown[key];
+}
+
+bool Input::WasKeyPressed(int key)
+{
+    return key >= 0 && static_cast<size_t>(key) < KeyCount && keysPressed[key];
+}
+
+bool Input::IsButtonDown(int button)
+{
+    return button >= 0 && static_cast<size_t>(button) < ButtonCount && buttonsDown[button];
+}
+
+bool Input::WasButtonPressed(int button)
+{
+    return button >= 0 && static_cast<size_t>(button) < ButtonCount && buttonsPressed[button];
+}
+
+glm::vec2 Input::GetMousePosition()
+{
+    return mousePosition;
+}
+
+glm::vec2 Input::GetMouseDelta()
+{
+    return mouseDelta;
+}
+
+glm::vec2 Input::GetScrollDelta()
+{
+    return scrollDelta;
+}
+
+double Input::GetLastSampleTime()
+{
+    return lastSampleTime;
+}
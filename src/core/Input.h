@@ -0,0 +1,50 @@
+﻿/**
+ * Grafik
+ * Input
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "events/InputEvent.h"
+
+#include <glm/glm.hpp>
+
+
+/**
+ * Window system input, buffered as raw samples and handed out once per Poll, both as events and as
+ * polled state. Consecutive cursor moves are merged into one sample, so a fast mouse costs one
+ * event per poll instead of one per OS message. Everything here runs on the main thread.
+ */
+class Input
+{
+public:
+    static constexpr size_t Capacity { 256 };
+
+    // From the window callbacks
+    static void PushKey(int key, int scancode, int action, int mods);
+    static void PushChar(unsigned codepoint);
+    static void PushButton(int button, int action, int mods);
+    static void PushMove(double x, double y);
+    static void PushScroll(double offsetX, double offsetY);
+
+    // Start a new frame for the per-frame state (pressed, deltas)
+    static void BeginFrame();
+
+    // Pump the window system, then apply the buffered samples to the polled state and broadcast them.
+    // Call again right before rendering so the frame uses the newest input
+    static void Poll();
+
+    // Off when there is no window system to pump, headless windows
+    static void SetPumpEvents(bool bPump);
+
+    // Polled state, keys and buttons are GLFW codes
+    [[nodiscard]] static bool IsKeyDown(int key);
+    [[nodiscard]] static bool WasKeyPressed(int key);
+    [[nodiscard]] static bool IsButtonDown(int button);
+    [[nodiscard]] static bool WasButtonPressed(int button);
+    [[nodiscard]] static glm::vec2 GetMousePosition();
+    [[nodiscard]] static glm::vec2 GetMouseDelta();
+    [[nodiscard]] static glm::vec2 GetScrollDelta();
+
+    // Time of the newest sample seen by Poll, glfwGetTime() based
+    [[nodiscard]] static double GetLastSampleTime();
+};
@@ -0,0 +1,439 @@
+﻿/**
+ * Grafik
+ * JobSystem
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <mutex>
+#include <random>
+#include <thread>
+
+
+namespace
+{
+    struct Job
+    {
+        JobFunc func { };
+        std::atomic<uint32_t>* pending { nullptr };     // of the JobCounter, if any
+        std::atomic<bool> busy { false };               // queued or running, the slot can't be reused
+    };
+
+    /**
+     * Chase-Lev deque with a fixed capacity. The owner pushes and pops at the bottom,
+     * other threads steal from the top.
+     */
+    class WorkStealingQueue
+    {
+    public:
+        static constexpr int64_t Capacity { 4096 };
+
+        bool Push(Job* job)
+        {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed);
+            const int64_t top = _top.load(std::memory_order_acquire);
+            if (bottom - top >= Capacity) return false;
+
+            // Release publishes the job to thieves that acquire the bottom
+            _jobs[bottom & Mask].store(job, std::memory_order_relaxed);
+            _bottom.store(bottom + 1, std::memory_order_release);
+            return true;
+        }
+
+        Job* Pop()
+        {
+            const int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+            _bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = _top.load(std::memory_order_relaxed);
+
+            if (top > bottom)
+            {
+                // Empty
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Job* job = _jobs[bottom & Mask].load(std::memory_order_relaxed);
+            if (top == bottom)
+            {
+                // Last job, race the thieves for it
+                if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    job = nullptr;
+                }
+                _bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        Job* Steal()
+        {
+            int64_t top = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = _bottom.load(std::memory_order_acquire);
+            if (top >= bottom) return nullptr;
+
+            Job* job = _jobs[top & Mask].load(std::memory_order_relaxed);
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return nullptr;
+            }
+            return job;
+        }
+
+    private:
+        static constexpr int64_t Mask { Capacity - 1 };
+
+        alignas(64) std::atomic<int64_t> _top { 0 };
+        alignas(64) std::atomic<int64_t> _bottom { 0 };
+        std::array<std::atomic<Job*>, Capacity> _jobs { };
+    };
+
+    // Per thread deque and job storage. Jobs are taken round-robin from a ring,
+    // so a thread may have at most JobsPerThread unfinished jobs
+    struct ThreadContext
+    {
+        static constexpr uint32_t JobsPerThread { 4096 };
+
+        WorkStealingQueue queue { };
+        std::unique_ptr<Job[]> jobs { std::make_unique<Job[]>(JobsPerThread) };
+        uint32_t nextJob { 0 };
+        std::minstd_rand random { };
+
+        // nullptr while the next slot is still queued or running somewhere
+        Job* Allocate()
+        {
+            Job* job = &jobs[nextJob & (JobsPerThread - 1)];
+            if (job->busy.load(std::memory_order_acquire)) return nullptr;
+            job->busy.store(true, std::memory_order_relaxed);
+            nextJob++;
+            return job;
+        }
+    };
+
+    // Index 0 is the main thread, the last one takes jobs from threads outside the pool. Those push
+    // one at a time under the mutex, and only ever steal, so its deque still has a single owner
+    std::vector<std::unique_ptr<ThreadContext>> contexts { };
+    std::mutex externalMutex { };
+    std::vector<std::jthread> workers { };
+    std::atomic<bool> running { false };
+
+    // Bumped whenever work is pushed, idle workers sleep on it
+    std::atomic<uint32_t> workEpoch { 0 };
+    std::atomic<uint32_t> sleeping { 0 };
+
+    thread_local ThreadContext* threadContext { nullptr };
+
+    void Execute(Job* job)
+    {
+        {
+            GK_PROFILE_SCOPE("Job");
+            job->func();
+        }
+        // The owner may reuse the slot as soon as it's released, read everything first
+        std::atomic<uint32_t>* pending = job->pending;
+        job->func = JobFunc { };
+        job->busy.store(false, std::memory_order_release);
+        if (pending)
+        {
+            pending->fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    Job* FindJob(ThreadContext& context)
+    {
+        if (Job* job = context.queue.Pop()) return job;
+
+        // Start at a random victim so thieves spread out
+        const size_t count = contexts.size();
+        const size_t start = context.random() % count;
+        for (size_t i = 0; i < count; i++)
+        {
+            ThreadContext& victim = *contexts[(start + i) % count];
+            if (&victim == &context) continue;
+            if (Job* job = victim.queue.Steal()) return job;
+        }
+        return nullptr;
+    }
+
+    // For threads outside the pool, which have no deque of their own
+    Job* StealJob()
+    {
+        for (const auto& victim : contexts)
+        {
+            if (Job* job = victim->queue.Steal()) return job;
+        }
+        return nullptr;
+    }
+
+    void WorkerLoop(ThreadContext* context, unsigned index)
+    {
+        threadContext = context;
+
+        char name[32];
+        std::snprintf(name, sizeof(name), "Worker %u", index);
+        Profiler::SetThreadName(name);
+
+        constexpr unsigned spinCount { 64 };
+        unsigned idle { 0 };
+        while (running.load(std::memory_order_acquire))
+        {
+            const uint32_t epoch = workEpoch.load(std::memory_order_acquire);
+            if (Job* job = FindJob(*context))
+            {
+                Execute(job);
+                idle = 0;
+                continue;
+            }
+
+            if (++idle < spinCount)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Nothing pushed since the epoch was read, sleep until something is. Wake bumps the epoch
+            // and then reads sleeping, this bumps sleeping and then reads the epoch. Only seq_cst
+            // keeps both sides from reading the stale value and losing the wakeup
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            workEpoch.wait(epoch, std::memory_order_seq_cst);
+            sleeping.fetch_sub(1, std::memory_order_acq_rel);
+            idle = 0;
+        }
+    }
+}
+
+void JobSystem::Init(unsigned workerCount)
+{
+    if (IsRunning()) return;
+
+    if (workerCount == 0)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+    }
+    if (workerCount == 0) return;
+
+    contexts.clear();
+    for (unsigned i = 0; i <= workerCount + 1; i++)
+    {
+        auto& context = contexts.emplace_back(std::make_unique<ThreadContext>());
+        context->random.seed(i + 1);
+    }
+    threadContext = contexts.front().get();
+
+    running = true;
+    workers.reserve(workerCount);
+    for (unsigned i = 1; i <= workerCount; i++)
+    {
+        workers.emplace_back(WorkerLoop, contexts[i].get(), i);
+    }
+    _workerCount = workerCount;
+
+    Log::Debug("JobSystem: Started {} workers", workerCount);
+}
+
+void JobSystem::Shutdown()
+{
+    if (!IsRunning()) return;
+
+    running = false;
+    workEpoch.fetch_add(1, std::memory_order_release);
+    workEpoch.notify_all();
+    workers.clear();
+
+    // Someone may still wait on the counters of queued jobs, so run them rather than drop them.
+    // IsRunning holds until the end, jobs that submit or wait keep going through the deques
+    ThreadContext* context = threadContext;
+    while (Job* job = context ? FindJob(*context) : StealJob())
+    {
+        Execute(job);
+    }
+
+    contexts.clear();
+    threadContext = nullptr;
+    _workerCount = 0;
+}
+
+void JobSystem::Run(JobFunc job, JobCounter* counter)
+{
+    std::atomic<uint32_t>* pending { nullptr };
+    if (counter)
+    {
+        pending = &counter->_pending;
+        pending->fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Threads outside the pool share the external context
+    ThreadContext* context = threadContext;
+    std::unique_lock<std::mutex> lock;
+    if (!context && IsRunning())
+    {
+        lock = std::unique_lock { externalMutex };
+        context = contexts.back().get();
+    }
+
+    // Without workers, or with every slot taken, run it right here.
+    // The ring holds as many jobs as the deque, so a free slot means there's room to push
+    Job* slot = context ? context->Allocate() : nullptr;
+    if (slot)
+    {
+        slot->func = std::move(job);
+        slot->pending = pending;
+        if (context->queue.Push(slot))
+        {
+            if (lock) lock.unlock();
+            Wake(1);
+            return;
+        }
+    }
+
+    // Unlocked first, the job may submit more
+    if (lock) lock.unlock();
+    if (slot)
+    {
+        Execute(slot);
+        return;
+    }
+    Job inlineJob { std::move(job), pending };
+    Execute(&inlineJob);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    ThreadContext* context = threadContext;
+    while (!counter.IsDone())
+    {
+        if (IsRunning())
+        {
+            if (Job* job = context ? FindJob(*context) : StealJob())
+            {
+                Execute(job);
+                continue;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+size_t JobSystem::GetAutoGrain(size_t count)
+{
+    // A few chunks per thread evens out uneven work without drowning in tiny jobs
+    constexpr size_t chunksPerThread { 4 };
+    const size_t chunks = static_cast<size_t>(GetThreadCount()) * chunksPerThread;
+    return std::max<size_t>(1, (count + chunks - 1) / chunks);
+}
+
+void JobSystem::Wake(unsigned count)
+{
+    // Pairs with the sleeping worker, see WorkerLoop
+    workEpoch.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) == 0) return;
+
+    if (count == 1)
+    {
+        workEpoch.notify_one();
+    }
+    else
+    {
+        workEpoch.notify_all();
+    }
+}
+
+TaskGraph::TaskId TaskGraph::Add(std::string name, JobFunc func, std::initializer_list<TaskId> dependsOn)
+{
+    const auto id = static_cast<TaskId>(_tasks.size());
+    _tasks.push_back({ std::move(name), std::move(func), 0 });
+    for (const TaskId dependency : dependsOn)
+    {
+        AddDependency(id, dependency);
+    }
+    _dirty = true;
+    return id;
+}
+
+void TaskGraph::AddDependency(TaskId task, TaskId dependsOn)
+{
+    if (dependsOn >= task)
+    {
+        Log::Error("TaskGraph: {} can only depend on earlier tasks", _tasks[task].name);
+        return;
+    }
+    _edges.emplace_back(dependsOn, task);
+    _tasks[task].dependencyCount++;
+    _dirty = true;
+}
+
+void TaskGraph::Resolve()
+{
+    // Counting sort of the edges by dependency
+    _offsets.assign(_tasks.size() + 1, 0);
+    for (const auto& [from, to] : _edges)
+    {
+        _offsets[from + 1]++;
+    }
+    for (size_t i = 1; i < _offsets.size(); i++)
+    {
+        _offsets[i] += _offsets[i - 1];
+    }
+
+    _dependents.resize(_edges.size());
+    std::vector<uint32_t> fill(_offsets.begin(), _offsets.end() - 1);
+    for (const auto& [from, to] : _edges)
+    {
+        _dependents[fill[from]++] = to;
+    }
+
+    _remaining = std::make_unique<std::atomic<uint32_t>[]>(_tasks.size());
+    _dirty = false;
+}
+
+void TaskGraph::Run()
+{
+    if (_tasks.empty()) return;
+    if (_dirty)
+    {
+        Resolve();
+    }
+
+    for (size_t i = 0; i < _tasks.size(); i++)
+    {
+        _remaining[i].store(_tasks[i].dependencyCount, std::memory_order_relaxed);
+    }
+
+    for (TaskId i = 0; i < _tasks.size(); i++)
+    {
+        if (_tasks[i].dependencyCount == 0)
+        {
+            Submit(i);
+        }
+    }
+    JobSystem::Wait(_counter);
+}
+
+void TaskGraph::Submit(TaskId task)
+{
+    JobSystem::Run([this, task]
+    {
+        _tasks[task].func();
+
+        // Dependents are submitted before this job counts as done, so the graph can't look finished early
+        for (uint32_t i = _offsets[task]; i < _offsets[task + 1]; i++)
+        {
+            const TaskId dependent = _dependents[i];
+            if (_remaining[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Submit(dependent);
+            }
+        }
+    }, &_counter);
+}
+
+void TaskGraph::Clear()
+{
+    _tasks.clear();
+    _edges.clear();
+    _dirty = true;
+}
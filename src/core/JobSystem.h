@@ -0,0 +1,135 @@
+﻿/**
+ * Grafik
+ * JobSystem
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "core/Function.h"
+
+#include <atomic>
+
+
+using JobFunc = InplaceFunction<void(), 48>;
+
+/**
+ * Number of unfinished jobs submitted against it, doubles as the handle to wait on.
+ */
+class JobCounter
+{
+    std::atomic<uint32_t> _pending { 0 };
+
+public:
+    [[nodiscard]] bool IsDone() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+};
+
+/**
+ * One worker per hardware thread besides the main thread, each with a Chase-Lev work-stealing deque.
+ * Jobs are pushed to the submitting thread's deque, idle workers steal from the others.
+ * Other threads, like the render thread, submit through one shared deque behind a lock.
+ * Waiting threads run jobs instead of blocking. Jobs must not make GL calls.
+ */
+class JobSystem
+{
+public:
+    // 0 uses one worker per hardware thread besides the calling (main) thread
+    static void Init(unsigned workerCount = 0);
+    static void Shutdown();
+
+    static void Run(JobFunc job, JobCounter* counter = nullptr);
+    static void Wait(JobCounter& counter);
+
+    // fn(begin, end) over [0, count) in chunks, returns when all are done.
+    // A grain of 0 picks chunks so every thread gets a few
+    template <typename F>
+    static void ParallelFor(size_t count, F&& fn, size_t grain = 0);
+
+    [[nodiscard]] static unsigned GetWorkerCount() { return _workerCount; }
+    [[nodiscard]] static unsigned GetThreadCount() { return _workerCount + 1; }
+    [[nodiscard]] static bool IsRunning() { return _workerCount > 0; }
+
+    [[nodiscard]] static size_t GetAutoGrain(size_t count);
+
+private:
+    static void Wake(unsigned count);
+
+    inline static unsigned _workerCount { 0 };
+};
+
+template <typename F>
+void JobSystem::ParallelFor(size_t count, F&& fn, size_t grain)
+{
+    if (count == 0) return;
+    if (grain == 0)
+    {
+        grain = GetAutoGrain(count);
+    }
+
+    // Single chunk or no workers, nothing to gain from a job
+    if (grain >= count || !IsRunning())
+    {
+        fn(size_t { 0 }, count);
+        return;
+    }
+
+    JobCounter counter;
+    auto* body = &fn;
+    for (size_t begin = grain; begin < count; begin += grain)
+    {
+        const size_t end = std::min(begin + grain, count);
+        Run([body, begin, end] { (*body)(begin, end); }, &counter);
+    }
+
+    // First chunk on this thread, then help with the rest
+    fn(size_t { 0 }, grain);
+    Wait(counter);
+}
+
+/**
+ * Tasks with dependencies, built once and run each frame. A task is submitted once everything
+ * it depends on has finished; Run returns when the whole graph is done.
+ */
+class TaskGraph
+{
+public:
+    using TaskId = uint32_t;
+
+    TaskGraph() = default;
+
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph& operator=(const TaskGraph&) = delete;
+
+    // Dependencies must be tasks added earlier
+    TaskId Add(std::string name, JobFunc func, std::initializer_list<TaskId> dependsOn = { });
+    void AddDependency(TaskId task, TaskId dependsOn);
+
+    void Run();
+    void Clear();
+
+    [[nodiscard]] size_t GetCount() const { return _tasks.size(); }
+    [[nodiscard]] const std::string& GetName(TaskId task) const { return _tasks[task].name; }
+
+private:
+    struct Task
+    {
+        std::string name { };
+        JobFunc func { };
+        uint32_t dependencyCount { 0 };
+    };
+
+    std::vector<Task> _tasks { };
+    std::vector<std::pair<TaskId, TaskId>> _edges { };  // dependency, dependent
+
+    // Resolved from _edges when the graph changed, dependents of task i are _dependents[_offsets[i].._offsets[i+1]]
+    std::vector<uint32_t> _offsets { };
+    std::vector<TaskId> _dependents { };
+    std::unique_ptr<std::atomic<uint32_t>[]> _remaining { };
+    bool _dirty { true };
+
+    JobCounter _counter { };
+
+    void Resolve();
+    void Submit(TaskId task);
+};
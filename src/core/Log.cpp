@@ -9,8 +9,27 @@
 
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <thread>
+
+
+namespace
+{
+    std::thread worker { };
+    std::atomic<bool> running { false };
+    std::atomic<uint32_t> wakeups { 0 };    // bumped to wake the logger thread
+    std::atomic<uint64_t> queued { 0 };
+    std::atomic<uint64_t> written { 0 };
+    std::atomic<uint64_t> dropped { 0 };
+
+    void Wake()
+    {
+        wakeups.fetch_add(1, std::memory_order_release);
+        wakeups.notify_one();
+    }
+}
 
 std::shared_ptr<spdlog::logger> Log::_logger;
+MPSCQueue<Log::Record, Log::QueueSize> Log::_queue;
 
 void Log::Init(Level level)
 {
@@ -18,5 +37,112 @@ void Log::Init(Level level)
 
     _logger = spdlog::stdout_color_mt("Grafik");
     _logger->set_level(static_cast<spdlog::level::level_enum>(level));
+    _level.store(static_cast<int>(level), std::memory_order_relaxed);
+
+    running.store(true, std::memory_order_release);
+    worker = std::thread(Loop);
+}
+
+void Log::Shutdown()
+{
+    if (!worker.joinable()) return;
+
+    running.store(false, std::memory_order_release);
+    Wake();
+    worker.join();
+
+    // Anything queued while stopping, this thread is the consumer now
+    Drain();
+    _logger->flush();
+}
+
+void Log::Flush()
+{
+    if (!running.load(std::memory_order_acquire)) return;
+
+    const uint64_t target = queued.load(std::memory_order_acquire);
+    Wake();
+    while (written.load(std::memory_order_acquire) < target)
+    {
+        std::this_thread::yield();
+    }
+}
+
+void Log::Enqueue(Level level, Formatter&& format)
+{
+    if (!_logger) return;
+
+    const auto time = spdlog::log_clock::now();
+    if (!running.load(std::memory_order_acquire))
+    {
+        spdlog::memory_buf_t buffer;
+        format(buffer);
+        Sink(level, time, buffer);
+        return;
+    }
+
+    // Only moved from once there is room
+    Record record { level, time, std::move(format) };
+    while (!_queue.TryEmplace(std::move(record)))
+    {
+        // Warnings and worse are worth waiting for, the rest is dropped rather than stall the caller
+        if (level < Level::Warn)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Wake();
+        std::this_thread::yield();
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    Wake();
+}
+
+void Log::Loop()
+{
+    Profiler::SetThreadName("Log");
+    while (true)
+    {
+        const uint32_t seen = wakeups.load(std::memory_order_acquire);
+        Drain();
+        if (!running.load(std::memory_order_acquire)) break;
+
+        wakeups.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void Log::Drain()
+{
+    spdlog::memory_buf_t buffer;
+    while (_queue.TryConsume([&buffer](Record& record)
+    {
+        buffer.clear();
+        record.format(buffer);
+        Sink(record.level, record.time, buffer);
+    }))
+    {
+        written.fetch_add(1, std::memory_order_release);
+    }
+
+    if (const uint64_t lost = dropped.exchange(0, std::memory_order_relaxed))
+    {
+        buffer.clear();
+        fmt::format_to(fmt::appender(buffer), "Log: Queue full, dropped {} messages", lost);
+        Sink(Level::Warn, spdlog::log_clock::now(), buffer);
+    }
+}
+
+void Log::Sink(Level level, spdlog::log_clock::time_point time, const spdlog::memory_buf_t& text)
+{
+    // Stamped with when it was logged, not when it got written
+    const spdlog::details::log_msg message { time, { }, _logger->name(), static_cast<spdlog::level::level_enum>(level),
+        spdlog::string_view_t { text.data(), text.size() } };
+    for (const spdlog::sink_ptr& sink : _logger->sinks())
+    {
+        if (sink->should_log(message.level))
+        {
+            sink->log(message);
+        }
+    }
 }
 #endif
@@ -5,9 +5,24 @@
  */
 #pragma once
 #ifdef GK_LOGGING
+#include "core/Function.h"
+#include "core/MPSCQueue.h"
+
 #include <spdlog/spdlog.h>
 
+// Levels below this compile to nothing, one of the SPDLOG_LEVEL_ values
+#ifndef GK_LOG_LEVEL
+    #define GK_LOG_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
 
+/**
+ * Logging through spdlog's sinks on a logger thread. A call copies its arguments into a record on a
+ * lock-free queue and returns; formatting and writing happen on the logger thread. Strings are copied,
+ * everything else is kept by value. When the queue is full, debug and info messages are dropped
+ * rather than stall the caller and warnings and worse wait for room; critical messages also wait
+ * until they are written. Before Init and after Shutdown messages are written on the calling thread.
+ */
 class Log
 {
 public:
@@ -25,54 +40,139 @@ public:
     Log() = default;
 
     static void Init(Level level = Level::All);
+    // Writes what is queued and stops the logger thread
+    static void Shutdown();
+    // Waits until everything logged so far is written
+    static void Flush();
 
     static std::shared_ptr<spdlog::logger> Get() { return _logger; }
 
     template <typename... Args>
-    static void Msg(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Msg(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
     template <typename... Args>
-    static void Debug(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Debug(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
     template <typename... Args>
-    static void Info(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Info(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
     template <typename... Args>
-    static void Warn(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Warn(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
     template <typename... Args>
-    static void Error(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Error(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
     template <typename... Args>
-    static void Crit(spdlog::format_string_t<Args...> fmt, Args... args);
+    static void Crit(spdlog::format_string_t<Args...> fmt, Args&&... args);
 
 private:
+    static constexpr size_t RecordSize { 160 };     // bytes of captured arguments
+    static constexpr size_t QueueSize { 1024 };
+
+    using Formatter = InplaceFunction<void(spdlog::memory_buf_t&), RecordSize>;
+
+    struct Record
+    {
+        Level level;
+        spdlog::log_clock::time_point time;
+        Formatter format;
+    };
+
+    template <Level L, typename... Args>
+    static void Write(spdlog::format_string_t<Args...> fmt, Args&&... args);
+
+    // The caller's strings may not outlive the call
+    template <typename T>
+    static auto Capture(T&& arg);
+
+    static void Enqueue(Level level, Formatter&& format);
+    static void Loop();
+    static void Drain();
+    static void Sink(Level level, spdlog::log_clock::time_point time, const spdlog::memory_buf_t& text);
+
     static std::shared_ptr<spdlog::logger> _logger;
+    static MPSCQueue<Record, QueueSize> _queue;
+    inline static std::atomic<int> _level { static_cast<int>(Level::All) };
 };
 
+template <typename T>
+auto Log::Capture(T&& arg)
+{
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_array_v<std::remove_reference_t<T>>)
+    {
+        return std::string { arg };
+    }
+    else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*>)
+    {
+        return arg ? std::string { arg } : std::string { };
+    }
+    else if constexpr (std::is_same_v<Type, std::string_view>)
+    {
+        return std::string { arg };
+    }
+    else
+    {
+        return Type(std::forward<T>(arg));
+    }
+}
+
+template <Log::Level L, typename... Args>
+void Log::Write(spdlog::format_string_t<Args...> fmt, Args&&... args)
+{
+    if constexpr (static_cast<int>(L) >= GK_LOG_LEVEL)
+    {
+        if (static_cast<int>(L) < _level.load(std::memory_order_relaxed)) return;
+
+        auto format = [text = fmt::string_view { fmt }, ...captured = Capture(std::forward<Args>(args))](spdlog::memory_buf_t& out) mutable
+        {
+            fmt::vformat_to(fmt::appender(out), text, fmt::make_format_args(captured...));
+        };
+
+        if constexpr (sizeof(format) <= RecordSize)
+        {
+            Enqueue(L, std::move(format));
+        }
+        else
+        {
+            // Too much to copy into a record, format here and queue the text
+            spdlog::memory_buf_t buffer;
+            format(buffer);
+            Enqueue(L, [text = std::string { buffer.data(), buffer.size() }](spdlog::memory_buf_t& out)
+            {
+                out.append(text.data(), text.data() + text.size());
+            });
+        }
+    }
+}
+
 // Message/Trace
 template <typename... Args>
-void Log::Msg(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->trace(fmt, std::forward<Args>(args)...); }
+void Log::Msg(spdlog::format_string_t<Args...> fmt, Args&&... args) { Write<Level::All>(fmt, std::forward<Args>(args)...); }
 
 // Debug
 template <typename... Args>
-void Log::Debug(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->debug(fmt, std::forward<Args>(args)...); }
+void Log::Debug(spdlog::format_string_t<Args...> fmt, Args&&... args) { Write<Level::Debug>(fmt, std::forward<Args>(args)...); }
 
 // Info
 template <typename... Args>
-void Log::Info(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->info(fmt, std::forward<Args>(args)...); }
+void Log::Info(spdlog::format_string_t<Args...> fmt, Args&&... args) { Write<Level::Info>(fmt, std::forward<Args>(args)...); }
 
 // Warning
 template <typename... Args>
-void Log::Warn(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->warn(fmt, std::forward<Args>(args)...); }
+void Log::Warn(spdlog::format_string_t<Args...> fmt, Args&&... args) { Write<Level::Warn>(fmt, std::forward<Args>(args)...); }
 
 // Error
 template <typename... Args>
-void Log::Error(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->error(fmt, std::forward<Args>(args)...); }
+void Log::Error(spdlog::format_string_t<Args...> fmt, Args&&... args) { Write<Level::Err>(fmt, std::forward<Args>(args)...); }
 
-// Critical
+// Critical, written before returning
 template <typename... Args>
-void Log::Crit(spdlog::format_string_t<Args...> fmt, Args... args) { Get()->critical(fmt, std::forward<Args>(args)...); }
+void Log::Crit(spdlog::format_string_t<Args...> fmt, Args&&... args)
+{
+    Write<Level::Critical>(fmt, std::forward<Args>(args)...);
+    Flush();
+}
 
 #else
 #include "LogN.h"
@@ -23,6 +23,8 @@ public:
     Log() = default;
 
     static void Init(...) {}
+    static void Shutdown() {}
+    static void Flush() {}
 
     template <typename... Args>
     static void Msg(Args...);
@@ -0,0 +1,119 @@
+﻿/**
+ * Grafik
+ * MPSCQueue
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <new>
+
+
+/**
+ * Bounded lock-free queue for many producers and a single consumer (Vyukov).
+ * Each cell carries a sequence number telling producers and the consumer whose turn it is,
+ * items are constructed in place so pushing never allocates.
+ */
+template <typename T, size_t Capacity>
+class MPSCQueue
+{
+    static_assert(Capacity >= 2 && std::has_single_bit(Capacity), "Capacity must be a power of two");
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence { 0 };
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+public:
+    MPSCQueue()
+    {
+        for (size_t i = 0; i < Capacity; i++)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPSCQueue()
+    {
+        while (TryConsume([](T&) { })) { }
+    }
+
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+    // Any thread. Returns false when the queue is full
+    template <typename... Args>
+    bool TryEmplace(Args&&... args)
+    {
+        Cell* cell;
+        size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+        while (true)
+        {
+            cell = &_cells[position & Mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+            if (diff == 0)
+            {
+                // Cell is free for this position, claim it
+                if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                // Another producer got here first
+                position = _enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::forward<Args>(args)...);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Hands the front item to consumer and destroys it in place
+    template <typename F>
+    bool TryConsume(F&& consumer)
+    {
+        Cell& cell = _cells[_dequeuePosition & Mask];
+        if (cell.sequence.load(std::memory_order_acquire) != _dequeuePosition + 1)
+        {
+            // Empty, or the producer of the front item hasn't finished writing it
+            return false;
+        }
+
+        T* item = std::launder(reinterpret_cast<T*>(cell.storage));
+        consumer(*item);
+        item->~T();
+
+        cell.sequence.store(_dequeuePosition + Capacity, std::memory_order_release);
+        _dequeuePosition++;
+        return true;
+    }
+
+    bool TryPop(T& out)
+    {
+        return TryConsume([&out](T& item) { out = std::move(item); });
+    }
+
+    // Consumer thread only, producers may be adding meanwhile
+    [[nodiscard]] size_t GetSizeApprox() const
+    {
+        return _enqueuePosition.load(std::memory_order_relaxed) - _dequeuePosition;
+    }
+
+    static constexpr size_t GetCapacity() { return Capacity; }
+
+private:
+    static constexpr size_t Mask { Capacity - 1 };
+
+    std::array<Cell, Capacity> _cells { };
+
+    // Producers and consumer on separate cache lines
+    alignas(64) std::atomic<size_t> _enqueuePosition { 0 };
+    alignas(64) size_t _dequeuePosition { 0 };
+};
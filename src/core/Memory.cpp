@@ -0,0 +1,198 @@
+﻿/**
+ * Grafik
+ * Memory
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+namespace
+{
+    std::atomic<size_t> allocationCount { 0 };
+    std::atomic<size_t> allocatedBytes { 0 };
+    thread_local size_t threadAllocationCount { 0 };
+    thread_local size_t threadAllocatedBytes { 0 };
+
+    // Open addressed on the scope name pointer, names are never removed
+    struct ScopeSlot
+    {
+        std::atomic<const char*> name { nullptr };
+        std::atomic<size_t> count { 0 };
+        std::atomic<size_t> bytes { 0 };
+    };
+
+    constexpr size_t scopeSlotCount { 256 };
+    std::array<ScopeSlot, scopeSlotCount> scopeSlots { };
+    std::atomic<bool> scopeTracking { false };
+    const char* const unscoped { "(no scope)" };
+
+    std::array<Memory::FrameAllocations, Memory::HistorySize> frameHistory { };
+    unsigned frameOffset { 0 };
+    unsigned frames { 0 };
+    Memory::FrameAllocations frameStart { };
+    std::vector<Memory::ScopeAllocations> frameScopes { };
+}
+
+size_t Memory::GetAllocationCount() { return allocationCount.load(std::memory_order_relaxed); }
+size_t Memory::GetAllocatedBytes() { return allocatedBytes.load(std::memory_order_relaxed); }
+size_t Memory::GetThreadAllocationCount() { return threadAllocationCount; }
+size_t Memory::GetThreadAllocatedBytes() { return threadAllocatedBytes; }
+
+void Memory::BeginFrame()
+{
+    if constexpr (IsTracking)
+    {
+        // Reserved up front so collecting never allocates after the first frame
+        if (frameScopes.capacity() < scopeSlotCount)
+        {
+            frameScopes.reserve(scopeSlotCount);
+        }
+
+        frameScopes.clear();
+        for (ScopeSlot& slot : scopeSlots)
+        {
+            const char* name = slot.name.load(std::memory_order_acquire);
+            if (!name) continue;
+
+            const size_t count = slot.count.exchange(0, std::memory_order_relaxed);
+            const size_t bytes = slot.bytes.exchange(0, std::memory_order_relaxed);
+            if (count > 0)
+            {
+                frameScopes.push_back({ name, count, bytes });
+            }
+        }
+        std::ranges::sort(frameScopes, std::greater { }, &ScopeAllocations::bytes);
+    }
+
+    const FrameAllocations now { GetAllocationCount(), GetAllocatedBytes() };
+    if (frames++ > 0)
+    {
+        frameOffset = (frameOffset + 1) % HistorySize;
+        frameHistory[frameOffset] = { now.count - frameStart.count, now.bytes - frameStart.bytes };
+    }
+    frameStart = now;
+}
+
+const Memory::FrameAllocations& Memory::GetFrame(unsigned framesAgo)
+{
+    return frameHistory[(frameOffset + HistorySize - framesAgo % HistorySize) % HistorySize];
+}
+
+unsigned Memory::GetFrameCount()
+{
+    return std::min(frames > 0 ? frames - 1 : 0, HistorySize);
+}
+
+void Memory::SetScopeTracking(bool enabled)
+{
+    scopeTracking.store(enabled && IsTracking, std::memory_order_relaxed);
+}
+
+bool Memory::IsScopeTracking()
+{
+    return scopeTracking.load(std::memory_order_relaxed);
+}
+
+const std::vector<Memory::ScopeAllocations>& Memory::GetFrameScopes()
+{
+    return frameScopes;
+}
+
+#ifdef GK_DEBUG
+
+namespace
+{
+    void Attribute(size_t size)
+    {
+        const char* name = Profiler::GetScope();
+        if (!name) name = unscoped;
+
+        size_t slot = (reinterpret_cast<uintptr_t>(name) >> 3) % scopeSlotCount;
+        for (size_t probe = 0; probe < scopeSlotCount; probe++, slot = (slot + 1) % scopeSlotCount)
+        {
+            const char* current = scopeSlots[slot].name.load(std::memory_order_acquire);
+            if (!current && scopeSlots[slot].name.compare_exchange_strong(current, name, std::memory_order_acq_rel))
+            {
+                current = name;
+            }
+            // A failed exchange leaves the name another thread claimed the slot with
+            if (current != name) continue;
+
+            scopeSlots[slot].count.fetch_add(1, std::memory_order_relaxed);
+            scopeSlots[slot].bytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+        // Table full, the allocation still shows in the frame totals
+    }
+
+    void Count(size_t size)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        threadAllocationCount++;
+        threadAllocatedBytes += size;
+
+        if (scopeTracking.load(std::memory_order_relaxed))
+        {
+            Attribute(size);
+        }
+    }
+
+    void* Allocate(size_t size)
+    {
+        Count(size);
+        while (true)
+        {
+            if (void* memory = std::malloc(size ? size : 1)) return memory;
+            
+            const std::new_handler handler = std::get_new_handler();
+            if (!handler) throw std::bad_alloc();
+            handler();
+        }
+    }
+
+    void* AllocateAligned(size_t size, std::align_val_t alignment)
+    {
+        Count(size);
+        const auto align = static_cast<size_t>(alignment);
+#   ifdef _MSC_VER
+        void* memory = _aligned_malloc(size ? size : 1, align);
+#   else
+        void* memory = std::aligned_alloc(align, (size + align - 1) / align * align);
+#   endif
+        if (!memory) throw std::bad_alloc();
+        return memory;
+    }
+
+    void FreeAligned(void* memory)
+    {
+#   ifdef _MSC_VER
+        _aligned_free(memory);
+#   else
+        std::free(memory);
+#   endif
+    }
+}
+
+// The standard nothrow forms forward to these
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocateAligned(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+
+#endif
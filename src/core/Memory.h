@@ -0,0 +1,67 @@
+﻿/**
+ * Grafik
+ * Memory
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+
+/**
+ * Heap allocation counters. Debug builds replace the global operator new to count,
+ * other builds compile the counters to zero. Counts can also be attributed to the innermost
+ * profiler scope of the allocating thread, see SetScopeTracking.
+ */
+namespace Memory
+{
+#ifdef GK_DEBUG
+    constexpr bool IsTracking { true };
+#else
+    constexpr bool IsTracking { false };
+#endif
+
+    // Process wide, since start
+    [[nodiscard]] size_t GetAllocationCount();
+    [[nodiscard]] size_t GetAllocatedBytes();
+
+    // This thread, since start
+    [[nodiscard]] size_t GetThreadAllocationCount();
+    [[nodiscard]] size_t GetThreadAllocatedBytes();
+
+    // Counts allocations made on this thread while in scope
+    class AllocationScope
+    {
+        size_t _start { GetThreadAllocationCount() };
+        size_t _startBytes { GetThreadAllocatedBytes() };
+
+    public:
+        [[nodiscard]] size_t GetCount() const { return GetThreadAllocationCount() - _start; }
+        [[nodiscard]] size_t GetBytes() const { return GetThreadAllocatedBytes() - _startBytes; }
+    };
+
+    struct FrameAllocations
+    {
+        size_t count { 0 };
+        size_t bytes { 0 };
+    };
+
+    struct ScopeAllocations
+    {
+        const char* name { nullptr };
+        size_t count { 0 };
+        size_t bytes { 0 };
+    };
+
+    constexpr unsigned HistorySize { 120 };
+
+    // Main thread, once per frame. Closes the frame that ended, process wide
+    void BeginFrame();
+    // Completed frame, 0 is the latest and up to GetFrameCount()-1 back
+    [[nodiscard]] const FrameAllocations& GetFrame(unsigned framesAgo = 0);
+    [[nodiscard]] unsigned GetFrameCount();
+
+    // Attribute allocations to profiler scopes, costs a table lookup per allocation while on
+    void SetScopeTracking(bool enabled);
+    [[nodiscard]] bool IsScopeTracking();
+    // Scopes that allocated in the frame that ended, most bytes first. Main thread
+    [[nodiscard]] const std::vector<ScopeAllocations>& GetFrameScopes();
+}
@@ -23,7 +23,6 @@
 // Linux
 #elif defined(__linux__)
     #define GK_LINUX
-    #error "Linux is not supported!"
 
 // Unknown
 #else
@@ -0,0 +1,240 @@
+﻿/**
+ * Grafik
+ * Profiler
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+
+namespace
+{
+    struct ProfileEvent
+    {
+        const char* name;
+        int64_t start;
+        int64_t duration;
+    };
+
+    /**
+     * Events of one thread. Only the owner writes, it publishes each event by bumping the count,
+     * so the writer of a trace can read up to the count without stopping anyone.
+     */
+    struct ThreadBuffer
+    {
+        static constexpr uint32_t Capacity { 1 << 16 };
+
+        std::unique_ptr<ProfileEvent[]> events { };
+        std::atomic<uint32_t> count { 0 };
+        std::atomic<uint32_t> dropped { 0 };
+        std::atomic<uint32_t> generation { 0 };     // capture the events belong to
+        std::atomic<bool> owned { true };
+        uint32_t id { 0 };
+        std::string name { };                       // guarded by registryMutex
+    };
+
+    const auto clockStart = std::chrono::steady_clock::now();
+
+    std::mutex registryMutex { };
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers { };
+    std::atomic<uint32_t> captureGeneration { 0 };
+
+    // Main thread only
+    unsigned captureFrames { 0 };
+    unsigned capturedFrames { 0 };
+
+    // Hands the buffer back when the thread ends
+    struct ThreadSlot
+    {
+        ThreadBuffer* buffer { nullptr };
+
+        ~ThreadSlot()
+        {
+            if (buffer)
+            {
+                buffer->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+    thread_local ThreadSlot threadSlot { };
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (threadSlot.buffer) return *threadSlot.buffer;
+
+        const std::lock_guard lock { registryMutex };
+        const uint32_t generation = captureGeneration.load(std::memory_order_relaxed);
+        for (const auto& buffer : buffers)
+        {
+            // Reuse the buffer of a finished thread once it isn't part of the running capture
+            if (!buffer->owned.load(std::memory_order_acquire) && buffer->generation.load(std::memory_order_relaxed) != generation)
+            {
+                buffer->owned.store(true, std::memory_order_relaxed);
+                buffer->name.clear();
+                threadSlot.buffer = buffer.get();
+                return *buffer;
+            }
+        }
+
+        const auto& buffer = buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->id = static_cast<uint32_t>(buffers.size());
+        threadSlot.buffer = buffer.get();
+        return *buffer;
+    }
+
+    void AppendEscaped(std::string& out, const char* text)
+    {
+        for (; *text; ++text)
+        {
+            if (*text == '"' || *text == '\\')
+            {
+                out += '\\';
+            }
+            out += *text;
+        }
+    }
+}
+
+void Profiler::BeginCapture(unsigned frames)
+{
+    const std::lock_guard lock { registryMutex };
+    if (IsCapturing()) return;
+
+    // Buffers from older captures reset themselves on their next event
+    captureGeneration.fetch_add(1, std::memory_order_release);
+    captureFrames = frames;
+    capturedFrames = 0;
+    _capturing.store(true, std::memory_order_relaxed);
+
+    Log::Debug("Profiler: Capture started");
+}
+
+bool Profiler::EndCapture(std::string path)
+{
+    const std::lock_guard lock { registryMutex };
+    if (!_capturing.exchange(false, std::memory_order_relaxed)) return false;
+
+    if (path.empty())
+    {
+        path = "traces/grafik-" + std::to_string(static_cast<long long>(std::time(nullptr))) + ".json";
+    }
+    std::error_code error;
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+    {
+        std::filesystem::create_directories(parent, error);
+    }
+
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+    {
+        Log::Error("Profiler: Unable to write {}", path);
+        return false;
+    }
+
+    const uint32_t generation = captureGeneration.load(std::memory_order_relaxed);
+    std::string text;
+    text.reserve(256);
+    char line[160];
+    size_t eventCount { 0 };
+    uint32_t droppedCount { 0 };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"Grafik"}})";
+    for (const auto& buffer : buffers)
+    {
+        if (buffer->generation.load(std::memory_order_acquire) != generation) continue;
+
+        if (!buffer->name.empty())
+        {
+            text = R"(,
+{"name":"thread_name","ph":"M","pid":1,"tid":)" + std::to_string(buffer->id) + R"(,"args":{"name":")";
+            AppendEscaped(text, buffer->name.c_str());
+            text += "\"}}";
+            out << text;
+        }
+
+        const uint32_t count = buffer->count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const ProfileEvent& event = buffer->events[i];
+            text = ",\n{\"name\":\"";
+            AppendEscaped(text, event.name);
+            std::snprintf(line, sizeof(line), R"(","ph":"X","ts":%.3f,"dur":%.3f,"pid":1,"tid":%u})",
+                static_cast<double>(event.start) / 1000.0, static_cast<double>(event.duration) / 1000.0, buffer->id);
+            text += line;
+            out << text;
+        }
+        eventCount += count;
+        droppedCount += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    out << "\n]}\n";
+    out.close();
+
+    if (!out)
+    {
+        Log::Error("Profiler: Failed writing {}", path);
+        return false;
+    }
+    if (droppedCount > 0)
+    {
+        Log::Warn("Profiler: {} events did not fit in the thread buffers", droppedCount);
+    }
+    Log::Info("Profiler: Wrote {} events to {}", eventCount, path);
+    return true;
+}
+
+void Profiler::BeginFrame()
+{
+    if (!IsCapturing() || captureFrames == 0) return;
+
+    if (++capturedFrames > captureFrames)
+    {
+        EndCapture();
+    }
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    const std::lock_guard lock { registryMutex };
+    buffer.name = name;
+}
+
+int64_t Profiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clockStart).count();
+}
+
+void Profiler::Record(const char* name, int64_t start, int64_t end)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    // First event of a new capture on this thread
+    const uint32_t generation = captureGeneration.load(std::memory_order_acquire);
+    if (buffer.generation.load(std::memory_order_relaxed) != generation)
+    {
+        if (!buffer.events)
+        {
+            buffer.events = std::make_unique_for_overwrite<ProfileEvent[]>(ThreadBuffer::Capacity);
+        }
+        buffer.count.store(0, std::memory_order_relaxed);
+        buffer.dropped.store(0, std::memory_order_relaxed);
+        buffer.generation.store(generation, std::memory_order_release);
+    }
+
+    const uint32_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= ThreadBuffer::Capacity)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer.events[index] = { name, start, end - start };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
@@ -0,0 +1,79 @@
+﻿/**
+ * Grafik
+ * Profiler
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+
+/**
+ * Scoped CPU timings for frame attribution. Each thread records into its own buffer without locking,
+ * and only while a capture is running. A capture is written as Chrome trace JSON, which loads in
+ * chrome://tracing and ui.perfetto.dev. Scope names must be string literals, they are kept as pointers.
+ */
+class Profiler
+{
+public:
+    // 0 frames runs until EndCapture
+    static void BeginCapture(unsigned frames = 0);
+
+    // Stop and write the capture, an empty path writes to traces/ with a timestamp
+    static bool EndCapture(std::string path = { });
+
+    // Marks the start of a frame, ends a capture once its frames are done
+    static void BeginFrame();
+
+    [[nodiscard]] static bool IsCapturing() { return _capturing.load(std::memory_order_relaxed); }
+
+    // Label for this thread in the trace
+    static void SetThreadName(const char* name);
+
+    // Nanoseconds since the profiler was loaded
+    [[nodiscard]] static int64_t Now();
+    static void Record(const char* name, int64_t start, int64_t end);
+
+    // Innermost open scope on this thread, nullptr outside of any
+    [[nodiscard]] static const char* GetScope() { return _scope; }
+    static const char* EnterScope(const char* name) { return std::exchange(_scope, name); }
+    static void LeaveScope(const char* parent) { _scope = parent; }
+
+private:
+    inline static std::atomic<bool> _capturing { false };
+    inline static thread_local const char* _scope { nullptr };
+};
+
+class ProfileScope
+{
+    const char* _name;
+    const char* _parent;
+    int64_t _start;
+
+public:
+    explicit ProfileScope(const char* name)
+        : _name { name }, _parent { Profiler::EnterScope(name) }, _start { Profiler::IsCapturing() ? Profiler::Now() : -1 } { }
+
+    ~ProfileScope()
+    {
+        if (_start >= 0)
+        {
+            Profiler::Record(_name, _start, Profiler::Now());
+        }
+        Profiler::LeaveScope(_parent);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#ifdef GK_DISTR
+    #define GK_PROFILE_SCOPE(name)
+    #define GK_PROFILE_FUNCTION()
+#else
+    #define GK_PROFILE_JOIN_(a, b) a##b
+    #define GK_PROFILE_JOIN(a, b) GK_PROFILE_JOIN_(a, b)
+    #define GK_PROFILE_SCOPE(name) const ProfileScope GK_PROFILE_JOIN(profileScope, __LINE__) { name }
+    #define GK_PROFILE_FUNCTION() GK_PROFILE_SCOPE(__FUNCTION__)
+#endif
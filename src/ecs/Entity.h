@@ -0,0 +1,48 @@
+﻿/**
+ * Grafik
+ * ECS: Entity
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+
+namespace ecs
+{
+    /**
+     * Handle to an entity. The generation is bumped whenever an index is recycled,
+     * so handles to destroyed entities stop resolving instead of aliasing new ones.
+     */
+    struct Entity
+    {
+        static constexpr uint32_t InvalidIndex { std::numeric_limits<uint32_t>::max() };
+
+        uint32_t index { InvalidIndex };
+        uint32_t generation { 0 };
+
+        [[nodiscard]] bool IsValid() const { return index != InvalidIndex; }
+
+        bool operator==(const Entity&) const = default;
+    };
+
+    constexpr Entity NullEntity { };
+
+    // Small sequential id per component type, indexes the registry's pools and system access masks
+    inline size_t NextComponentId()
+    {
+        static std::atomic<size_t> next { 0 };
+        return next++;
+    }
+
+    template <typename T>
+    size_t GetComponentId()
+    {
+        static const size_t id = NextComponentId();
+        return id;
+    }
+
+    constexpr size_t MaxComponentTypes { 64 };
+}
@@ -0,0 +1,100 @@
+﻿/**
+ * Grafik
+ * ECS: Pool
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "ecs/Entity.h"
+
+
+namespace ecs
+{
+    class PoolBase
+    {
+    public:
+        virtual ~PoolBase() = default;
+
+        virtual bool Remove(Entity entity) = 0;
+        [[nodiscard]] virtual bool Contains(Entity entity) const = 0;
+        [[nodiscard]] virtual size_t GetSize() const = 0;
+        [[nodiscard]] virtual const std::vector<Entity>& GetEntities() const = 0;
+    };
+
+    /**
+     * Sparse set of one component type. Components are packed densely in insertion order
+     * (swap-and-pop on removal), the sparse array maps an entity index to its dense slot.
+     */
+    template <typename T>
+    class Pool final : public PoolBase
+    {
+        static constexpr uint32_t Absent { std::numeric_limits<uint32_t>::max() };
+
+        std::vector<uint32_t> _sparse { };
+        std::vector<Entity> _entities { };
+        std::vector<T> _components { };
+
+    public:
+        template <typename... Args>
+        T& Emplace(Entity entity, Args&&... args)
+        {
+            if (entity.index >= _sparse.size())
+            {
+                _sparse.resize(entity.index + 1, Absent);
+            }
+
+            // Replace in place if the entity already has one
+            if (const uint32_t slot = _sparse[entity.index]; slot != Absent)
+            {
+                _entities[slot] = entity;
+                return _components[slot] = T { std::forward<Args>(args)... };
+            }
+
+            _sparse[entity.index] = static_cast<uint32_t>(_entities.size());
+            _entities.push_back(entity);
+            return _components.emplace_back(T { std::forward<Args>(args)... });
+        }
+
+        bool Remove(Entity entity) override
+        {
+            if (!Contains(entity)) return false;
+
+            const uint32_t slot = _sparse[entity.index];
+            const uint32_t last = static_cast<uint32_t>(_entities.size() - 1);
+            if (slot != last)
+            {
+                _entities[slot] = _entities[last];
+                _components[slot] = std::move(_components[last]);
+                _sparse[_entities[slot].index] = slot;
+            }
+            _entities.pop_back();
+            _components.pop_back();
+            _sparse[entity.index] = Absent;
+            return true;
+        }
+
+        [[nodiscard]] bool Contains(Entity entity) const override
+        {
+            return entity.index < _sparse.size() && _sparse[entity.index] != Absent && _entities[_sparse[entity.index]] == entity;
+        }
+
+        [[nodiscard]] T* TryGet(Entity entity)
+        {
+            return Contains(entity) ? &_components[_sparse[entity.index]] : nullptr;
+        }
+
+        // Unchecked, the entity must be in the pool
+        [[nodiscard]] T& Get(Entity entity) { return _components[_sparse[entity.index]]; }
+
+        [[nodiscard]] size_t GetSize() const override { return _entities.size(); }
+        [[nodiscard]] const std::vector<Entity>& GetEntities() const override { return _entities; }
+
+        [[nodiscard]] T* GetData() { return _components.data(); }
+        [[nodiscard]] const T* GetData() const { return _components.data(); }
+
+        void Reserve(size_t count)
+        {
+            _entities.reserve(count);
+            _components.reserve(count);
+        }
+    };
+}
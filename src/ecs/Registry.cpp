@@ -0,0 +1,53 @@
+﻿/**
+ * Grafik
+ * ECS: Registry
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Registry.h"
+
+
+namespace ecs
+{
+    Entity Registry::Create()
+    {
+        _alive++;
+        if (!_freeIndices.empty())
+        {
+            const uint32_t index = _freeIndices.back();
+            _freeIndices.pop_back();
+            return { index, _generations[index] };
+        }
+
+        _generations.push_back(0);
+        return { static_cast<uint32_t>(_generations.size() - 1), 0 };
+    }
+
+    void Registry::Destroy(Entity entity)
+    {
+        if (!IsAlive(entity)) return;
+
+        for (const auto& pool : _pools)
+        {
+            if (pool) pool->Remove(entity);
+        }
+
+        // Old handles to this index no longer match
+        _generations[entity.index]++;
+        _freeIndices.push_back(entity.index);
+        _alive--;
+    }
+
+    void Registry::Clear()
+    {
+        _pools.clear();
+        _generations.clear();
+        _freeIndices.clear();
+        _alive = 0;
+    }
+
+    bool Registry::IsAlive(Entity entity) const
+    {
+        return entity.index < _generations.size() && _generations[entity.index] == entity.generation;
+    }
+}
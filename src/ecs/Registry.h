@@ -0,0 +1,74 @@
+﻿/**
+ * Grafik
+ * ECS: Registry
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "ecs/Pool.h"
+#include "ecs/View.h"
+
+
+namespace ecs
+{
+    /**
+     * Owns entities and one sparse set pool per component type.
+     */
+    class Registry
+    {
+    public:
+        Registry() = default;
+
+        Registry(const Registry&) = delete;
+        Registry& operator=(const Registry&) = delete;
+
+        Entity Create();
+        void Destroy(Entity entity);
+        void Clear();
+
+        [[nodiscard]] bool IsAlive(Entity entity) const;
+        [[nodiscard]] size_t GetCount() const { return _alive; }
+
+        template <typename T, typename... Args>
+        T& Emplace(Entity entity, Args&&... args) { return GetPool<T>().Emplace(entity, std::forward<Args>(args)...); }
+
+        template <typename T>
+        bool Remove(Entity entity) { return GetPool<T>().Remove(entity); }
+
+        template <typename T>
+        [[nodiscard]] bool Has(Entity entity) { return GetPool<T>().Contains(entity); }
+
+        template <typename T>
+        [[nodiscard]] T* TryGet(Entity entity) { return GetPool<T>().TryGet(entity); }
+
+        template <typename T>
+        [[nodiscard]] T& Get(Entity entity) { return GetPool<T>().Get(entity); }
+
+        template <typename... Ts>
+        [[nodiscard]] View<Ts...> GetView() { return View<Ts...> { &GetPool<Ts>()... }; }
+
+        template <typename T>
+        Pool<T>& GetPool();
+
+    private:
+        std::vector<uint32_t> _generations { };
+        std::vector<uint32_t> _freeIndices { };
+        size_t _alive { 0 };
+
+        std::vector<std::unique_ptr<PoolBase>> _pools { };
+    };
+
+    template <typename T>
+    Pool<T>& Registry::GetPool()
+    {
+        const size_t id = GetComponentId<T>();
+        if (id >= _pools.size())
+        {
+            _pools.resize(id + 1);
+        }
+        if (!_pools[id])
+        {
+            _pools[id] = std::make_unique<Pool<T>>();
+        }
+        return static_cast<Pool<T>&>(*_pools[id]);
+    }
+}
@@ -0,0 +1,66 @@
+﻿/**
+ * Grafik
+ * ECS: Scheduler
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Scheduler.h"
+
+
+namespace ecs
+{
+    void Scheduler::AddSystem(std::string name, ComponentMask reads, ComponentMask writes, SystemFunc func, void (*preparePools)(Registry&))
+    {
+        size_t stage { 0 };
+        std::vector<size_t> dependsOn;
+        for (size_t i = 0; i < _systems.size(); i++)
+        {
+            const System& other = _systems[i];
+            const bool conflicts = (writes & (other.reads | other.writes)).any() || (other.writes & reads).any();
+            if (conflicts)
+            {
+                dependsOn.push_back(i);
+                stage = std::max(stage, other.stage + 1);
+            }
+        }
+
+        if (stage >= _stages.size())
+        {
+            _stages.resize(stage + 1);
+        }
+        _stages[stage].push_back(_systems.size());
+        _systems.push_back({ std::move(name), reads, writes, std::move(func), preparePools, std::move(dependsOn), stage });
+        _graphDirty = true;
+    }
+
+    void Scheduler::BuildGraph()
+    {
+        _graph.Clear();
+        for (size_t i = 0; i < _systems.size(); i++)
+        {
+            const auto task = _graph.Add(_systems[i].name, [this, i] { _systems[i].func(*_registry, _deltaTime); });
+            for (const size_t dependency : _systems[i].dependsOn)
+            {
+                _graph.AddDependency(task, static_cast<TaskGraph::TaskId>(dependency));
+            }
+        }
+        _graphDirty = false;
+    }
+
+    void Scheduler::Run(Registry& registry, double deltaTime)
+    {
+        for (const System& system : _systems)
+        {
+            system.preparePools(registry);
+        }
+
+        if (_graphDirty)
+        {
+            BuildGraph();
+        }
+
+        _registry = &registry;
+        _deltaTime = deltaTime;
+        _graph.Run();
+    }
+}
@@ -0,0 +1,77 @@
+﻿/**
+ * Grafik
+ * ECS: Scheduler
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "ecs/Registry.h"
+#include "core/Function.h"
+#include "core/JobSystem.h"
+
+#include <bitset>
+
+
+namespace ecs
+{
+    template <typename... Ts> struct Read { };
+    template <typename... Ts> struct Write { };
+
+    using ComponentMask = std::bitset<MaxComponentTypes>;
+
+    /**
+     * Runs systems as a task graph on the job system. A system waits for every earlier system it
+     * conflicts with (one writes what the other reads or writes), the rest run in parallel.
+     * Stages group systems by dependency depth, for display.
+     */
+    class Scheduler
+    {
+    public:
+        using SystemFunc = InplaceFunction<void(Registry&, double), 48>;
+
+        struct System
+        {
+            std::string name { };
+            ComponentMask reads { };
+            ComponentMask writes { };
+            SystemFunc func { };
+            void (*preparePools)(Registry&) { nullptr };
+            std::vector<size_t> dependsOn { };
+            size_t stage { 0 };
+        };
+
+        template <typename... R, typename... W>
+        void Add(std::string name, Read<R...>, Write<W...>, SystemFunc func)
+        {
+            // Pools are created up front, never by systems racing each other
+            auto preparePools = [](Registry& registry) { (registry.GetPool<R>(), ...); (registry.GetPool<W>(), ...); };
+            AddSystem(std::move(name), MaskOf<R...>(), MaskOf<W...>(), std::move(func), preparePools);
+        }
+
+        // Systems may change component values only, not create or destroy entities or components
+        void Run(Registry& registry, double deltaTime);
+
+        [[nodiscard]] const std::vector<System>& GetSystems() const { return _systems; }
+        [[nodiscard]] size_t GetStageCount() const { return _stages.size(); }
+
+    private:
+        std::vector<System> _systems { };
+        std::vector<std::vector<size_t>> _stages { };
+
+        TaskGraph _graph { };
+        bool _graphDirty { true };
+        Registry* _registry { nullptr };
+        double _deltaTime { 0 };
+
+        void BuildGraph();
+
+        void AddSystem(std::string name, ComponentMask reads, ComponentMask writes, SystemFunc func, void (*preparePools)(Registry&));
+
+        template <typename... Ts>
+        static ComponentMask MaskOf()
+        {
+            ComponentMask mask;
+            (mask.set(GetComponentId<Ts>()), ...);
+            return mask;
+        }
+    };
+}
@@ -0,0 +1,71 @@
+﻿/**
+ * Grafik
+ * ECS: View
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "ecs/Pool.h"
+
+#include <algorithm>
+#include <tuple>
+
+
+namespace ecs
+{
+    /**
+     * Entities having all of Ts. Iteration walks the smallest pool linearly and looks the
+     * rest up through their sparse arrays; a single component view is a plain array walk.
+     * Components may be modified during iteration, entities and components must not be added or removed.
+     */
+    template <typename... Ts>
+    class View
+    {
+        static_assert(sizeof...(Ts) > 0);
+
+        std::tuple<Pool<Ts>*...> _pools;
+        const PoolBase* _driver { nullptr };
+
+    public:
+        explicit View(Pool<Ts>*... pools)
+            : _pools { pools... }
+        {
+            _driver = std::min({ static_cast<const PoolBase*>(pools)... },
+                [](const PoolBase* a, const PoolBase* b) { return a->GetSize() < b->GetSize(); });
+        }
+
+        // Upper bound of matches, and the index range accepted by Each
+        [[nodiscard]] size_t GetSize() const { return _driver->GetSize(); }
+
+        // fn(Entity, Ts&...) for every match
+        template <typename F>
+        void Each(F&& fn) { Each(0, GetSize(), std::forward<F>(fn)); }
+
+        // Same, limited to [begin, end) of the driving pool so work can be split across threads
+        template <typename F>
+        void Each(size_t begin, size_t end, F&& fn)
+        {
+            const std::vector<Entity>& entities = _driver->GetEntities();
+            end = std::min(end, entities.size());
+
+            if constexpr (sizeof...(Ts) == 1)
+            {
+                auto* data = std::get<0>(_pools)->GetData();
+                for (size_t i = begin; i < end; i++)
+                {
+                    fn(entities[i], data[i]);
+                }
+            }
+            else
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    const Entity entity = entities[i];
+                    if ((std::get<Pool<Ts>*>(_pools)->Contains(entity) && ...))
+                    {
+                        fn(entity, std::get<Pool<Ts>*>(_pools)->Get(entity)...);
+                    }
+                }
+            }
+        }
+    };
+}
@@ -21,11 +21,9 @@ public:
     [[nodiscard]] unsigned GetWidth() const { return _width; }
     [[nodiscard]] unsigned GetHeight() const { return _height; }
 
-    [[nodiscard]] std::string ToString() const override
+    std::string_view Format(std::span<char> buffer) const override
     {
-        std::stringstream stream;
-        stream << GetName() << " (" << _width << ", " << _height << ")";
-        return stream.str();
+        return FormatTo(buffer, "%s (%u, %u)", GetName(), _width, _height);
     }
 
 private:
@@ -47,7 +45,8 @@ private:
     bool _restart { false };
 };
 
-using LabFactoryFunc = std::function<labb::LLab*()>;
+// Lab factories are captureless lambdas, the inline buffer never allocates
+using LabFactoryFunc = InplaceFunction<labb::LLab*()>;
 
 class InitLabEvent : public Event
 {
@@ -64,32 +63,45 @@ public:
 class TickEvent : public Event
 {
 public:
-    TickEvent(double dt)
-        : _deltaTime { dt } { }
+    TickEvent(double dt, bool fixedStep = false)
+        : _deltaTime { dt }, _fixedStep { fixedStep } { }
 
     [[nodiscard]] double GetDeltaTime() const { return _deltaTime; }
+    [[nodiscard]] bool IsFixedStep() const { return _fixedStep; }
     
     GK_EVENT_CLASS_TYPE(Tick)
     GK_EVENT_CLASS_CATEGORY(Application)
 
-    [[nodiscard]] std::string ToString() const override
+    std::string_view Format(std::span<char> buffer) const override
     {
-        std::stringstream stream;
-        stream << GetName() << " (" << _deltaTime << ")";
-        return stream.str();
+        return FormatTo(buffer, "%s (%g%s)", GetName(), _deltaTime, _fixedStep ? ", fixed" : "");
     }
 
 private:
     double _deltaTime { };
+    bool _fixedStep { false };
 };
 
 class RenderEvent : public Event
 {
 public:
-    RenderEvent() = default;
+    RenderEvent(double alpha = 1.0)
+        : _alpha { alpha } { }
+
+    // Fraction of a fixed step elapsed since the last tick, for interpolating between the
+    // previous and current tick state. Always 1 when ticking once per frame
+    [[nodiscard]] double GetAlpha() const { return _alpha; }
 
     GK_EVENT_CLASS_TYPE(Render)
     GK_EVENT_CLASS_CATEGORY(Application)
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (%g)", GetName(), _alpha);
+    }
+
+private:
+    double _alpha { 1.0 };
 };
 
 class FramebufferSizeEvent : public Event
@@ -104,11 +116,9 @@ public:
     [[nodiscard]] unsigned GetWidth() const { return _width; }
     [[nodiscard]] unsigned GetHeight() const { return _height; }
 
-    [[nodiscard]] std::string ToString() const override
+    std::string_view Format(std::span<char> buffer) const override
     {
-        std::stringstream stream;
-        stream << GetName() << " (" << _width << ", " << _height << ")";
-        return stream.str();
+        return FormatTo(buffer, "%s (%u, %u)", GetName(), _width, _height);
     }
 
 private:
@@ -4,6 +4,12 @@
  * Copyright 2023 Martin Furuberg
  */
 #pragma once
+#include "core/Function.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <span>
+#include <string_view>
 
 
 #define GK_BIND_EVENT_HANDLER_EXTERN(obj,h) [obj](auto&& ... args) -> decltype(auto) { (obj)->h(std::forward<decltype(args)>(args)...); }
@@ -27,9 +33,12 @@ public:
         WindowSize, WindowMinimize, WindowClose,
         Tick, Render, FramebufferSize, UI,
         Key, KeyChar,
-        MouseButton, MouseMove, MouseScroll
+        MouseButton, MouseMove, MouseScroll,
+        Count
     };
 
+    static constexpr size_t TypeCount { static_cast<size_t>(Type::Count) };
+
     enum Category : unsigned
     {
         None = 0,
@@ -45,7 +54,9 @@ public:
     [[nodiscard]] virtual const char* GetName() const = 0;
     [[nodiscard]] virtual Type GetEventType() const = 0;
     [[nodiscard]] virtual int GetCategories() const = 0;
-    [[nodiscard]] virtual std::string ToString() const { return GetName(); }
+
+    // Debug text written into the caller's buffer, truncated if it doesn't fit
+    virtual std::string_view Format(std::span<char> buffer) const { return FormatTo(buffer, "%s", GetName()); }
 
     [[nodiscard]] bool IsCategory(Category category) const { return GetCategories() & category; }
     
@@ -53,6 +64,14 @@ public:
     [[nodiscard]] bool IsHandled() const { return _bHandled; }
 
 protected:
+    template <typename... Args>
+    static std::string_view FormatTo(std::span<char> buffer, const char* format, Args... args)
+    {
+        if (buffer.empty()) return { };
+        const int length = std::snprintf(buffer.data(), buffer.size(), format, args...);
+        return { buffer.data(), length > 0 ? std::min(static_cast<size_t>(length), buffer.size() - 1) : 0 };
+    }
+
     bool _bHandled { false };
     friend class EventDispatcher;
 };
@@ -60,15 +79,16 @@ protected:
 class EventDispatcher
 {
     Event& _event;
+    const Event::Type _type;
 
 public:
     EventDispatcher(Event& event)
-        : _event { event } { }
+        : _event { event }, _type { event.GetEventType() } { }
 
-    template <typename T, typename H>
-    void Dispatch(const H& handler)
+    template <typename T>
+    void Dispatch(FunctionRef<void(T&)> handler)
     {
-        if (!_event._bHandled && _event.GetEventType() == T::GetStaticType())
+        if (!_event._bHandled && _type == T::GetStaticType())
         {
             handler(static_cast<T&>(_event));
         }
@@ -77,6 +97,7 @@ public:
 
 inline std::ostream& operator<<(std::ostream& os, const Event& e)
 {
-    os << e.ToString();
+    char buffer[128];
+    os << e.Format(buffer);
     return os;
 }
@@ -6,50 +6,173 @@
 #include "gpch.h"
 #include "EventManager.h"
 
+#include "events/ApplicationEvent.h"
+#include "events/InputEvent.h"
+
+// Every event can be posted, not just the ones that are today
+static_assert(PostedEvent::Fits<WindowSizeEvent> && PostedEvent::Fits<WindowCloseEvent> && PostedEvent::Fits<InitLabEvent>
+    && PostedEvent::Fits<TickEvent> && PostedEvent::Fits<RenderEvent> && PostedEvent::Fits<FramebufferSizeEvent>
+    && PostedEvent::Fits<UIEvent>, "Application event too large to post");
+static_assert(PostedEvent::Fits<KeyEvent> && PostedEvent::Fits<KeyCharEvent> && PostedEvent::Fits<MouseButtonEvent>
+    && PostedEvent::Fits<MouseMoveEvent> && PostedEvent::Fits<MouseScrollEvent>, "Input event too large to post");
 
 EventManager* EventManager::Get()
 {
-    std::lock_guard lock(_mutex);
-    if (!_manager)
-    {
-        _manager = new EventManager();
-    }
-    return _manager;
+    // Thread safe initialization, no lock on later calls
+    static EventManager manager;
+    return &manager;
 }
 
-int& EventManager::addListener(const void* object, const EventCallbackFunc& func, int categoryMask)
+void EventManager::AddListener(const EventListener& listener)
 {
-    const auto& listener = _listeners.emplace_back(std::make_unique<EventHandle>(object, func, categoryMask));
-    return listener->categoryMask;
+    _listeners.push_back(listener);
+    Changed(false);
+}
+
+bool EventManager::setCategoryMask(const void* object, int categoryMask)
+{
+    const auto listener = std::ranges::find_if(_listeners, [object](const EventListener& l)
+    {
+        return l.object == object && l.type == Event::Type::None;
+    });
+    if (listener == _listeners.end()) return false;
+
+    if (listener->categoryMask != categoryMask)
+    {
+        listener->categoryMask = categoryMask;
+        Changed(true);
+    }
+    return true;
 }
 
 bool EventManager::removeListener(const void* object)
 {
-    auto listenerObject = [&object](const std::unique_ptr<EventHandle>& cl) { return cl->object == object; };
-    const auto match = std::ranges::find_if(_listeners, listenerObject);
-    if (match != _listeners.end())
+    if (std::erase_if(_listeners, [object](const EventListener& listener) { return listener.object == object; }))
     {
-        _listeners.erase(match);
+        Changed(true);
         return true;
     }
     return false;
 }
 
-void EventManager::Broadcast(Event& event) const
+size_t EventManager::removeListeners(std::span<const void* const> objects)
 {
-    for (size_t i = 0; i < _listeners.size(); i++)
+    if (objects.empty()) return 0;
+
+    // Few objects are searched linearly, larger batches through a sorted copy
+    auto matches = [objects](const void* object) { return std::ranges::find(objects, object) != objects.end(); };
+    size_t removed;
+    if (objects.size() <= 8)
     {
-        if (event.IsHandled()) break;
+        removed = std::erase_if(_listeners, [&](const EventListener& listener) { return matches(listener.object); });
+    }
+    else
+    {
+        _sortedObjects.assign(objects.begin(), objects.end());
+        std::ranges::sort(_sortedObjects);
+        removed = std::erase_if(_listeners, [this](const EventListener& listener)
+        {
+            return std::ranges::binary_search(_sortedObjects, listener.object);
+        });
+    }
+
+    if (removed)
+    {
+        Changed(true);
+    }
+    return removed;
+}
+
+void EventManager::Changed(bool bRemoved)
+{
+    _dirty.fill(true);
+    if (bRemoved)
+    {
+        _removals++;
+    }
+}
+
+void EventManager::Resolve(Event::Type type, int categories, std::vector<EventListener>& table) const
+{
+    // Categories are fixed per event type, so the first event of a type decides its table
+    table.clear();
+    for (const EventListener& listener : _listeners)
+    {
+        if (listener.type == type || (listener.type == Event::Type::None && listener.categoryMask & categories))
+        {
+            table.push_back(listener);
+        }
+    }
+}
+
+bool EventManager::IsListening(const EventListener& listener) const
+{
+    return std::ranges::any_of(_listeners, [&listener](const EventListener& l)
+    {
+        return l.object == listener.object && l.func == listener.func && l.type == listener.type && l.categoryMask == listener.categoryMask;
+    });
+}
 
-        const auto& listener = _listeners[i];
-        if (listener && listener->categoryMask & event.GetCategories())
+void EventManager::Broadcast(Event& event) const
+{
+    GK_PROFILE_SCOPE(event.GetName());
+
+    const auto type = event.GetEventType();
+    const auto index = static_cast<size_t>(type);
+
+    // The tables stay as they are while any broadcast walks them. A nested broadcast after listeners
+    // changed resolves into its own copy, the shared table catches up on the next outermost one
+    std::vector<EventListener> nested;
+    const std::vector<EventListener>* table = &_tables[index];
+    if (_dirty[index])
+    {
+        if (_broadcastDepth == 0)
+        {
+            Resolve(type, event.GetCategories(), _tables[index]);
+            _dirty[index] = false;
+        }
+        else
         {
-            listener->func(event);
+            Resolve(type, event.GetCategories(), nested);
+            table = &nested;
         }
     }
+
+    // Listeners added by a handler are called from the next broadcast, removed ones aren't called again
+    _broadcastDepth++;
+    const uint64_t removals = _removals;
+    for (const EventListener& listener : *table)
+    {
+        if (event.IsHandled()) break;
+        if (_removals != removals && !IsListening(listener)) continue;
+
+        listener.func(listener.context, event);
+    }
+    _broadcastDepth--;
+}
+
+size_t EventManager::DispatchPosted()
+{
+    // Bounded, so handlers that keep posting can't hold the frame here
+    size_t count { 0 };
+    while (count < PostQueueSize && _posted.TryConsume([this](const PostedEvent& posted) { Broadcast(posted.Get()); }))
+    {
+        count++;
+    }
+    return count;
 }
 
 void EventManager::Reset()
 {
+    // Posted events may refer to objects that are going away
+    while (_posted.TryConsume([](PostedEvent&) { })) { }
+
     _listeners.clear();
+    Changed(true);
+    if (_broadcastDepth > 0) return;
+
+    for (auto& table : _tables)
+    {
+        table.clear();
+    }
 }
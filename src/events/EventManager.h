@@ -5,21 +5,63 @@
  */
 #pragma once
 #include "events/Event.h"
+#include "core/MPSCQueue.h"
 
-#include <mutex>
+#include <span>
 
 
-using EventCallbackFunc = std::function<void(Event&)>;
+// Plain function pointer with the listener object as context, no std::function
+using EventCallbackFunc = void(*)(void* context, Event& event);
 
-struct EventHandle
+struct EventListener
 {
     const void* object { nullptr };
-    const EventCallbackFunc func { };
+    void* context { nullptr };
+    EventCallbackFunc func { nullptr };
+    Event::Type type { Event::Type::None };     // single type, or None to use the category mask
     int categoryMask { Event::None };
+};
+
+/**
+ * Event stored by value in a fixed inline buffer, so it can travel through the post queue without allocating.
+ */
+class PostedEvent
+{
+public:
+    static constexpr size_t BufferSize { 128 };
+
+    template <typename E>
+    static constexpr bool Fits { sizeof(E) <= BufferSize && alignof(E) <= alignof(std::max_align_t) };
+
+    template <typename E>
+    explicit PostedEvent(E&& event)
+    {
+        using EventType = std::remove_cvref_t<E>;
+        static_assert(std::is_base_of_v<Event, EventType>);
+        static_assert(Fits<EventType>, "Event too large to post");
+
+        _event = new (_buffer) EventType(std::forward<E>(event));
+        _destroy = [](Event* e) { static_cast<EventType*>(e)->~EventType(); };
+    }
 
-    bool operator==(const EventHandle& handle) const { return object == handle.object; }
+    ~PostedEvent() { _destroy(_event); }
+
+    PostedEvent(const PostedEvent&) = delete;
+    PostedEvent& operator=(const PostedEvent&) = delete;
+
+    [[nodiscard]] Event& Get() const { return *_event; }
+
+private:
+    alignas(std::max_align_t) std::byte _buffer[BufferSize];
+    Event* _event { nullptr };
+    void (*_destroy)(Event*) { nullptr };
 };
 
+/**
+ * Listeners are kept in registration order and resolved into one contiguous table per event type,
+ * so a broadcast only walks the listeners interested in that type.
+ * Broadcast is synchronous on the calling thread; other threads Post events for the main loop to dispatch.
+ */
 class EventManager
 {
 protected:
@@ -31,15 +73,71 @@ public:
 
     static EventManager* Get();
 
-    int& addListener(const void* object, const EventCallbackFunc& func, int categoryMask = 0);
+    // Listen to every event in the categories with Method(Event&). A mask of None listens to nothing
+    // until setCategoryMask, but holds the listener's place in the call order
+    template <auto Method, typename T>
+    void addListener(T* object, int categoryMask);
+
+    // Change the mask of the object's category listener without moving it
+    bool setCategoryMask(const void* object, int categoryMask);
+
+    // Listen to a single event type with Method(E&)
+    template <typename E, auto Method, typename T>
+    void addListener(T* object);
+
     bool removeListener(const void* object);
 
+    // Remove every listener of any of the objects in a single pass
+    size_t removeListeners(std::span<const void* const> objects);
+
     void Broadcast(Event& event) const;
 
+    // Any thread. Queued by value and broadcast on the main thread by DispatchPosted,
+    // returns false when the queue is full
+    template <typename E>
+    [[nodiscard]] bool Post(E&& event) { return _posted.TryEmplace(std::forward<E>(event)); }
+
+    // Main thread. Broadcast what was posted, returns the number of events
+    size_t DispatchPosted();
+
     void Reset();
-    
+
+    [[nodiscard]] size_t GetListenerCount() const { return _listeners.size(); }
+
 private:
-    std::vector<std::unique_ptr<EventHandle>> _listeners { };
-    inline static EventManager* _manager { nullptr };
-    inline static std::mutex _mutex { };
+    void AddListener(const EventListener& listener);
+    void Resolve(Event::Type type, int categories, std::vector<EventListener>& table) const;
+    [[nodiscard]] bool IsListening(const EventListener& listener) const;
+    void Changed(bool bRemoved);
+
+    std::vector<EventListener> _listeners { };
+    mutable std::array<std::vector<EventListener>, Event::TypeCount> _tables { };
+    mutable std::array<bool, Event::TypeCount> _dirty { };
+    std::vector<const void*> _sortedObjects { };
+
+    // Broadcasts in progress, and listeners removed or changed so far, so a broadcast can
+    // leave its table alone while it's walked and skip listeners removed under it
+    mutable int _broadcastDepth { 0 };
+    uint64_t _removals { 0 };
+
+    static constexpr size_t PostQueueSize { 1024 };
+    MPSCQueue<PostedEvent, PostQueueSize> _posted { };
 };
+
+template <auto Method, typename T>
+void EventManager::addListener(T* object, int categoryMask)
+{
+    AddListener({ object, const_cast<std::remove_const_t<T>*>(object),
+        [](void* context, Event& event) { (static_cast<T*>(context)->*Method)(event); },
+        Event::Type::None, categoryMask });
+}
+
+template <typename E, auto Method, typename T>
+void EventManager::addListener(T* object)
+{
+    static_assert(std::is_base_of_v<Event, E>);
+    
+    AddListener({ object, const_cast<std::remove_const_t<T>*>(object),
+        [](void* context, Event& event) { (static_cast<T*>(context)->*Method)(static_cast<E&>(event)); },
+        E::GetStaticType(), Event::None });
+}
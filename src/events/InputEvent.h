@@ -0,0 +1,155 @@
+﻿/**
+ * Grafik
+ * Event: Input
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "events/Event.h"
+
+
+// Key, button and modifier values are GLFW's
+enum class InputAction : int
+{
+    Release = 0,
+    Press   = 1,
+    Repeat  = 2
+};
+
+class InputEvent : public Event
+{
+public:
+    // glfwGetTime() when the sample was taken
+    [[nodiscard]] double GetTimestamp() const { return _timestamp; }
+
+protected:
+    InputEvent(double timestamp)
+        : _timestamp { timestamp } { }
+
+    double _timestamp { 0 };
+};
+
+class KeyEvent : public InputEvent
+{
+public:
+    KeyEvent(double timestamp, int key, int scancode, InputAction action, int mods)
+        : InputEvent { timestamp }, _key { key }, _scancode { scancode }, _action { action }, _mods { mods } { }
+
+    GK_EVENT_CLASS_TYPE(Key)
+    GK_EVENT_CLASS_CATEGORY(Input | Keyboard)
+
+    [[nodiscard]] int GetKey() const { return _key; }
+    [[nodiscard]] int GetScancode() const { return _scancode; }
+    [[nodiscard]] InputAction GetAction() const { return _action; }
+    [[nodiscard]] int GetMods() const { return _mods; }
+    [[nodiscard]] bool IsPress() const { return _action == InputAction::Press; }
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (%d, %d, %d)", GetName(), _key, static_cast<int>(_action), _mods);
+    }
+
+private:
+    int _key { 0 };
+    int _scancode { 0 };
+    InputAction _action { InputAction::Release };
+    int _mods { 0 };
+};
+
+class KeyCharEvent : public InputEvent
+{
+public:
+    KeyCharEvent(double timestamp, unsigned codepoint)
+        : InputEvent { timestamp }, _codepoint { codepoint } { }
+
+    GK_EVENT_CLASS_TYPE(KeyChar)
+    GK_EVENT_CLASS_CATEGORY(Input | Keyboard)
+
+    [[nodiscard]] unsigned GetCodepoint() const { return _codepoint; }
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (U+%04X)", GetName(), _codepoint);
+    }
+
+private:
+    unsigned _codepoint { 0 };
+};
+
+class MouseButtonEvent : public InputEvent
+{
+public:
+    MouseButtonEvent(double timestamp, int button, InputAction action, int mods, double x, double y)
+        : InputEvent { timestamp }, _button { button }, _action { action }, _mods { mods }, _x { x }, _y { y } { }
+
+    GK_EVENT_CLASS_TYPE(MouseButton)
+    GK_EVENT_CLASS_CATEGORY(Input | Mouse | MouseButton)
+
+    [[nodiscard]] int GetButton() const { return _button; }
+    [[nodiscard]] InputAction GetAction() const { return _action; }
+    [[nodiscard]] int GetMods() const { return _mods; }
+    [[nodiscard]] bool IsPress() const { return _action == InputAction::Press; }
+    [[nodiscard]] double GetX() const { return _x; }
+    [[nodiscard]] double GetY() const { return _y; }
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (%d, %d at %g, %g)", GetName(), _button, static_cast<int>(_action), _x, _y);
+    }
+
+private:
+    int _button { 0 };
+    InputAction _action { InputAction::Release };
+    int _mods { 0 };
+    double _x { 0 }, _y { 0 };
+};
+
+/**
+ * Cursor position after a burst of moves. Moves between two other samples are merged into one
+ * event, the delta covers all of them.
+ */
+class MouseMoveEvent : public InputEvent
+{
+public:
+    MouseMoveEvent(double timestamp, double x, double y, double deltaX, double deltaY, unsigned samples)
+        : InputEvent { timestamp }, _x { x }, _y { y }, _deltaX { deltaX }, _deltaY { deltaY }, _samples { samples } { }
+
+    GK_EVENT_CLASS_TYPE(MouseMove)
+    GK_EVENT_CLASS_CATEGORY(Input | Mouse)
+
+    [[nodiscard]] double GetX() const { return _x; }
+    [[nodiscard]] double GetY() const { return _y; }
+    [[nodiscard]] double GetDeltaX() const { return _deltaX; }
+    [[nodiscard]] double GetDeltaY() const { return _deltaY; }
+    [[nodiscard]] unsigned GetSampleCount() const { return _samples; }
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (%g, %g, %u samples)", GetName(), _x, _y, _samples);
+    }
+
+private:
+    double _x { 0 }, _y { 0 };
+    double _deltaX { 0 }, _deltaY { 0 };
+    unsigned _samples { 1 };
+};
+
+class MouseScrollEvent : public InputEvent
+{
+public:
+    MouseScrollEvent(double timestamp, double offsetX, double offsetY)
+        : InputEvent { timestamp }, _offsetX { offsetX }, _offsetY { offsetY } { }
+
+    GK_EVENT_CLASS_TYPE(MouseScroll)
+    GK_EVENT_CLASS_CATEGORY(Input | Mouse)
+
+    [[nodiscard]] double GetOffsetX() const { return _offsetX; }
+    [[nodiscard]] double GetOffsetY() const { return _offsetY; }
+
+    std::string_view Format(std::span<char> buffer) const override
+    {
+        return FormatTo(buffer, "%s (%g, %g)", GetName(), _offsetX, _offsetY);
+    }
+
+private:
+    double _offsetX { 0 }, _offsetY { 0 };
+};
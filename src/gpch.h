@@ -28,4 +28,5 @@
 #endif
 
 #include "core/Log.h"
+#include "core/Profiler.h"
 #include "core/Common.h"
@@ -6,11 +6,15 @@
 #include "gpch.h"
 #include "Batch.h"
 
+#include "core/Input.h"
 #include "renderer/Renderer.h"
 #include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
 #include "ElementBuffer.h"
+#include "TextureStreamer.h"
 #include "VertexBufferLayout.h"
 
+#include <GLFW/glfw3.h>
 #include <imgui/imgui.h>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
@@ -25,10 +29,10 @@ namespace labb
         int width, height;
         if (!Renderer::GetFramebufferSize(width, height))
         {
-            std::cout << "Error reading framebuffer size" << std::endl;
+            Log::Error("Batch: Error reading framebuffer size");
         }
 
-        RandomizeSeed();
+        _seed = GetSeed();
 
         // Define layout
         VertexBufferLayout layout;
@@ -45,22 +49,10 @@ namespace labb
 
         // Generate element/index buffer and bind to VAO
         unsigned indices[batchIndicesCount];
-        unsigned offset { 0 };
-        for (size_t i = 0; i < batchIndicesCount; i += 6)
-        {
-            indices[i+0] = offset + 0;
-            indices[i+1] = offset + 1;
-            indices[i+2] = offset + 2;
-            
-            indices[i+3] = offset + 2;
-            indices[i+4] = offset + 3;
-            indices[i+5] = offset + 0;
-
-            offset += 4;
-        }
+        MakeQuadIndices(indices);
         
-        const ElementBuffer ebo(indices, batchIndicesCount);
-        _vao.AddElementBuffer(ebo);
+        _ebo.emplace(indices, batchIndicesCount);
+        _vao.AddElementBuffer(*_ebo);
         
         // Define matrices
         _projection = glm::perspective(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 15.0f);
@@ -71,11 +63,12 @@ namespace labb
         {
             // Load textures and bind to texture unit
             _texture0.emplace(true);
-            _texture1.emplace("data/textures/metal_plates.png");
-            _texture2.emplace("data/textures/ground_base.jpg");
-            if (_texture0->Bind(0) && _texture1->Bind(1) && _texture2->Bind(2))
+            _texture1.emplace("data/textures/metal_plates.png", SamplerState { }, true);
+            _texture2.emplace("data/textures/ground_base.jpg", SamplerState { }, true);
+            MakeTiles();
+            if (_texture0->Bind(0) && _texture1->Bind(1) && _texture2->Bind(2) && _atlas->Bind(0, 3))
             {
-                _shader->SetUniform1iv("u_Textures", { 0, 1, 2 });
+                _shader->SetUniform1iv("u_Textures", { 0, 1, 2, 3 });
             }
         }
 
@@ -85,34 +78,64 @@ namespace labb
         VertexBuffer::Unbind();
     }
 
+    void LBatch::OnAttach(int& eventMask)
+    {
+        LLab::OnAttach(eventMask);
+        events->addListener<MouseScrollEvent, &LBatch::OnMouseScroll>(this);
+    }
+
+    void LBatch::OnMouseScroll(MouseScrollEvent& e)
+    {
+        if (ImGui::GetIO().WantCaptureMouse) return;
+        
+        _cameraPosition.z = std::clamp(_cameraPosition.z + static_cast<float>(e.GetOffsetY()) * 0.5f, -10.0f, -1.0f);
+    }
+
     void LBatch::OnTick(TickEvent& e)
     {
+        GK_PROFILE_FUNCTION();
+
+        _previousCycle = _cycle;
         if (_bSpin)
         {
             _cycle = fmod(_cycle + static_cast<double>(_speed) * e.GetDeltaTime(), 360.0);
         }
+    }
+
+    void LBatch::OnRender(RenderEvent& e)
+    {
+        GK_PROFILE_FUNCTION();
+
+        // Between the last two ticks, unless the cycle just wrapped
+        double cycle = _cycle;
+        if (std::abs(_cycle - _previousCycle) < 180.0)
+        {
+            cycle = _previousCycle + (_cycle - _previousCycle) * e.GetAlpha();
+        }
         _model = glm::mat4(1.0f);
-        _model = rotate(_model, static_cast<float>(_cycle * glm::radians(180.0)), glm::vec3(0.0f, 1.0f, 0.0f));
+        _model = rotate(_model, static_cast<float>(cycle * glm::radians(180.0)), glm::vec3(0.0f, 1.0f, 0.0f));
 
+        // Pan with the right mouse button, read here rather than in tick for the newest position
+        if (Input::IsButtonDown(GLFW_MOUSE_BUTTON_RIGHT) && !ImGui::GetIO().WantCaptureMouse)
+        {
+            const glm::vec2 delta = Input::GetMouseDelta() * (-_cameraPosition.z * 0.002f);
+            _cameraPosition.x = std::clamp(_cameraPosition.x + delta.x, -5.0f, 5.0f);
+            _cameraPosition.y = std::clamp(_cameraPosition.y - delta.y, -5.0f, 5.0f);
+        }
         _view = glm::translate(glm::mat4(1.0f), _cameraPosition);
         
         _mvp = _projection * _view * _model;
-    }
 
-    void LBatch::OnRender(RenderEvent&)
-    {
         RenderCommand::SetClearColor({ 1.0f, 1.0f, 1.0f });
         RenderCommand::ClearBuffer();
 
-        _draws = 0;
-        
         if (!_shader->Bind())
         {
             RenderError("Shader error!");
             return;
         }
 
-        if (!_texture0->Bind(0) || !_texture1->Bind(1) || !_texture2->Bind(2))
+        if (!_texture0->Bind(0) || !_texture1->Bind(1) || !_texture2->Bind(2) || !_atlas->Bind(0, 3))
         {
             RenderError("Failed to load texture!");
             return;
@@ -129,6 +152,11 @@ namespace labb
 
         // Calc values for grid
         constexpr float size { 0.1f };
+
+        // Report quad size on screen for texture streaming
+        const float screenSize = TextureStreamer::GetScreenSize(_mvp, glm::vec3(0.0f), size);
+        _texture1->RequestScreenSize(screenSize);
+        _texture2->RequestScreenSize(screenSize);
         const float startX { -size * static_cast<float>(cols) * 0.5f };
         const float startY {  size * static_cast<float>(rows) * 0.5f };
 
@@ -139,7 +167,8 @@ namespace labb
         size_t n{0}, curY{0}, curX{0};
         while (n < static_cast<size_t>(_quads))
         {
-            const float texId = static_cast<float>(randomTextureId());
+            const int texture = randomTextureId();
+            const float texId = static_cast<float>(texture);
             const float x = startX + static_cast<float>(curX) * size + size * 0.5f;
             const float y = startY - static_cast<float>(curY) * size - size * 0.5f;
             const float z = texId * _breakAmount - _breakAmount;
@@ -148,7 +177,16 @@ namespace labb
             color.g = 1.0f - static_cast<float>(curX) / static_cast<float>(cols);
             color.b = static_cast<float>(curX) / static_cast<float>(cols);
 
-            vertexPtr = MakeQuad(vertexPtr, x, y, z, size, size, texId, color);
+            // Last texture is the atlas, pick one of its tiles
+            if (texture == 3 && !_tiles.empty())
+            {
+                const AtlasRegion* tile = _atlas->Get(_tiles[n % _tiles.size()]);
+                vertexPtr = MakeQuad(vertexPtr, x, y, z, size, size, texId, color, tile->uvMin, tile->uvMax);
+            }
+            else
+            {
+                vertexPtr = MakeQuad(vertexPtr, x, y, z, size, size, texId, color);
+            }
 
             curY++;
             if (curY == rows)
@@ -159,14 +197,12 @@ namespace labb
             n++;
         }
 
-        _vbo.Bind();
-        glBufferSubData(GL_ARRAY_BUFFER, 0, batchVerticesCount * sizeof(Vertex), _vertices);
+        _vbo.SetData(_vertices, batchVerticesCount * sizeof(Vertex));
 
         _shader->SetUniformMat4f("u_MVP", _mvp);
 
         _vao.Bind();
         Renderer::Render(_vao, _shader, 0, _quads * 6 - 1);
-        _draws++;
     }
 
     void LBatch::OnUI(UIEvent& e)
@@ -190,7 +226,10 @@ namespace labb
             static_cast<double>(ImGui::GetIO().Framerate));
         ImGui::Text("Quads: %d", _quads);
         ImGui::SameLine(0, 20.0f);
-        ImGui::Text("Draw calls: %d", _draws);
+        {
+            const auto lock = RenderStats::Lock();
+            ImGui::Text("Draw calls: %u", RenderStats::GetFrame().drawCalls);
+        }
         ImGui::Separator();
         ImGui::DragFloat("=", &_speed, 0.005f, -2.0f, 2.0f, "%.3f");
         ImGui::SameLine();
@@ -208,29 +247,30 @@ namespace labb
         ImGui::End();
     }
 
-    Vertex* LBatch::MakeQuad(Vertex* vertexPtr, float x, float y, float z, float width /*= 1.0f*/, float height /*= 1.0f*/, float texId /*= 0.0f*/, glm::vec4 color /*1, 1, 1, 1*/)
+    Vertex* LBatch::MakeQuad(Vertex* vertexPtr, float x, float y, float z, float width /*= 1.0f*/, float height /*= 1.0f*/, float texId /*= 0.0f*/, glm::vec4 color /*1, 1, 1, 1*/,
+        glm::vec2 uvMin /*= 0, 0*/, glm::vec2 uvMax /*= 1, 1*/)
     {
         vertexPtr->Position = { x-width*0.5f, y+height*0.5f, z };
         vertexPtr->Color = color;
-        vertexPtr->TexCoords = { 0.0f, 1.0f };
+        vertexPtr->TexCoords = { uvMin.x, uvMax.y };
         vertexPtr->TexId = texId;
         vertexPtr++;
 
         vertexPtr->Position = { x+width*0.5f, y+height*0.5f, z };
         vertexPtr->Color = color;
-        vertexPtr->TexCoords = { 1.0f, 1.0f };
+        vertexPtr->TexCoords = { uvMax.x, uvMax.y };
         vertexPtr->TexId = texId;
         vertexPtr++;
 
         vertexPtr->Position = { x+width*0.5f, y-height*0.5f, z };
         vertexPtr->Color = color;
-        vertexPtr->TexCoords = { 1.0f, 0.0f };
+        vertexPtr->TexCoords = { uvMax.x, uvMin.y };
         vertexPtr->TexId = texId;
         vertexPtr++;
 
         vertexPtr->Position = { x-width*0.5f, y-height*0.5f, z };
         vertexPtr->Color = color;
-        vertexPtr->TexCoords = { 0.0f, 0.0f };
+        vertexPtr->TexCoords = { uvMin.x, uvMin.y };
         vertexPtr->TexId = texId;
         vertexPtr++;
 
@@ -242,6 +282,57 @@ namespace labb
         _seed = static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count());
     }
 
+    void LBatch::MakeTiles()
+    {
+        // One page holds every tile, so the atlas takes a single texture unit
+        TextureAtlas::Settings settings;
+        settings.pageSize = 256;
+        settings.padding = 2;
+        _atlas.emplace(settings);
+
+        // Checkers, stripes and rings in a few sizes and colors
+        constexpr glm::vec3 colors[] { { 1.0f, 0.8f, 0.2f }, { 0.2f, 0.7f, 1.0f }, { 1.0f, 0.3f, 0.5f }, { 0.4f, 1.0f, 0.4f } };
+        constexpr int sizes[] { 32, 48, 64 };
+        std::vector<unsigned char> pixels;
+        for (int i = 0; i < 12; i++)
+        {
+            const int tileSize = sizes[i % std::size(sizes)];
+            const glm::vec3 color = colors[i % std::size(colors)];
+            pixels.resize(static_cast<size_t>(tileSize) * tileSize * 4);
+            for (int y = 0; y < tileSize; y++)
+            {
+                for (int x = 0; x < tileSize; x++)
+                {
+                    bool bInk;
+                    switch (i % 3)
+                    {
+                        case 0: bInk = ((x / 8) + (y / 8)) % 2 == 0; break;
+                        case 1: bInk = ((x + y) / 6) % 2 == 0; break;
+                        default:
+                        {
+                            const float dx = static_cast<float>(x - tileSize / 2);
+                            const float dy = static_cast<float>(y - tileSize / 2);
+                            bInk = static_cast<int>(std::sqrt(dx * dx + dy * dy) / 5.0f) % 2 == 0;
+                        }
+                    }
+                    const glm::vec3 texel = bInk ? color : color * 0.25f;
+                    unsigned char* out = &pixels[(static_cast<size_t>(y) * tileSize + x) * 4];
+                    out[0] = static_cast<unsigned char>(texel.r * 255.0f);
+                    out[1] = static_cast<unsigned char>(texel.g * 255.0f);
+                    out[2] = static_cast<unsigned char>(texel.b * 255.0f);
+                    out[3] = 255;
+                }
+            }
+
+            const TextureAtlas::Handle tile = _atlas->Insert(pixels.data(), tileSize, tileSize);
+            if (tile != TextureAtlas::InvalidHandle && _atlas->Get(tile)->page == 0)
+            {
+                _tiles.push_back(tile);
+            }
+        }
+        _atlas->Flush();
+    }
+
     LBatch::~LBatch()
     {
         delete[] _vertices;
@@ -5,12 +5,15 @@
  */
 #pragma once
 #include "Lab.h"
+#include "events/InputEvent.h"
 
 #include "DataTexture.h"
+#include "ElementBuffer.h"
 #include "VertexArray.h"
 #include "VertexBuffer.h"
 #include "renderer/Shader.h"
 #include "Texture.h"
+#include "TextureAtlas.h"
 
 #include <random>
 
@@ -26,36 +29,43 @@ namespace labb
         float       _speed          { 0.2f };
         float       _breakAmount    { 0.0f };
         double      _cycle          { 0 };
+        double      _previousCycle  { 0 };
         glm::vec3   _cameraPosition { 0.0f, 0.0f, -7.5f };
         bool        _bSpin          { false };
         int         _quads          { 5928 };
-        int         _draws          { 0 };
     
     public:
         LBatch();
         ~LBatch() override;
 
+        void OnAttach(int& eventMask) override;
         void OnTick(TickEvent& e) override;
         void OnRender(RenderEvent& e) override;
         void OnUI(UIEvent& e) override;
 
     protected:
         static Vertex* MakeQuad(Vertex* vertexPtr, float x, float y, float z, float width = 1.0f, float height = 1.0f,
-            float texId = 0.0f, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+            float texId = 0.0f, glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+            glm::vec2 uvMin = { 0.0f, 0.0f }, glm::vec2 uvMax = { 1.0f, 1.0f });
 
     private:
         VertexArray _vao {};
         VertexBuffer _vbo { nullptr, sizeof(Vertex) * batchVerticesCount, true };
+        std::optional<ElementBuffer> _ebo;
         std::shared_ptr<Shader> _shader { Shader::Create( "data/shaders/batch.vert", "data/shaders/batch.frag" ) };
         std::optional<DataTexture> _texture0;
         std::optional<Texture> _texture1;
         std::optional<Texture> _texture2;
 
+        // Small tiles packed into one atlas page, drawn in the same call as the rest
+        std::optional<TextureAtlas> _atlas;
+        std::vector<TextureAtlas::Handle> _tiles {};
+
         Vertex* _vertices { nullptr };
 
         unsigned _seed {};
         std::default_random_engine randomEngine {};
-        std::uniform_int_distribution<int> randomizer { 0, 2 };
+        std::uniform_int_distribution<int> randomizer { 0, 3 };
 
         // Matrices
         glm::mat4 _projection { 1.0f };
@@ -64,5 +74,7 @@ namespace labb
         glm::mat4 _mvp { 1.0f };
 
         void RandomizeSeed();
+        void MakeTiles();
+        void OnMouseScroll(MouseScrollEvent& e);
     };
 }
@@ -18,6 +18,8 @@ namespace labb
 
     void LClearColor::OnRender(RenderEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         RenderCommand::SetClearColor(_color);
         RenderCommand::ClearBuffer();
     }
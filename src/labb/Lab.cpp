@@ -6,6 +6,7 @@
 #include "gpch.h"
 #include "Lab.h"
 
+#include "core/Application.h"
 #include "renderer/RenderCommand.h"
 #include "renderer/Shader.h"
 
@@ -14,20 +15,35 @@
 
 #include <imgui/imgui.h>
 
+#include <chrono>
+
 
 namespace labb
 {
-    void LLab::OnAttach(int& eventMask)
+    void MakeQuadIndices(std::span<unsigned> indices)
     {
-        eventMask = Event::Application;
+        unsigned offset { 0 };
+        for (size_t i = 0; i + 6 <= indices.size(); i += 6)
+        {
+            indices[i+0] = offset + 0;
+            indices[i+1] = offset + 1;
+            indices[i+2] = offset + 2;
+            
+            indices[i+3] = offset + 2;
+            indices[i+4] = offset + 3;
+            indices[i+5] = offset + 0;
+
+            offset += 4;
+        }
     }
-    
-    void LLab::OnEvent(Event& e)
+
+    void LLab::OnAttach(int& eventMask)
     {
-        EventDispatcher dispatcher { e };
-        dispatcher.Dispatch<TickEvent>(GK_BIND_EVENT_HANDLER(OnTick));
-        dispatcher.Dispatch<RenderEvent>(GK_BIND_EVENT_HANDLER(OnRender));
-        dispatcher.Dispatch<UIEvent>(GK_BIND_EVENT_HANDLER(OnUI));
+        // Per frame events go straight to their handler, nothing left for the category mask
+        eventMask = Event::None;
+        events->addListener<TickEvent, &LLab::OnTick>(this);
+        events->addListener<RenderEvent, &LLab::OnRender>(this);
+        events->addListener<UIEvent, &LLab::OnUI>(this);
     }
 
     void LLab::OnTick(TickEvent&)
@@ -66,6 +82,15 @@ namespace labb
         }
     }
 
+    unsigned LLab::GetSeed()
+    {
+        if (const unsigned seed = Application::Get()._config.seed)
+        {
+            return seed;
+        }
+        return static_cast<unsigned>(std::chrono::system_clock::now().time_since_epoch().count());
+    }
+
     LLab::~LLab()
     {
         Shader::Unbind();
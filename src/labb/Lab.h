@@ -9,6 +9,8 @@
 
 #include <glm/glm.hpp>
 
+#include <span>
+
 
 namespace labb
 {
@@ -20,6 +22,9 @@ namespace labb
         float       TexId       { 0.0f };
     };
 
+    // Two triangles per quad of four vertices, fills the whole span
+    void MakeQuadIndices(std::span<unsigned> indices);
+
     class LLab : public Component
     {
     public:
@@ -27,7 +32,6 @@ namespace labb
 
         void OnAttach(int& eventMask) override;
         void OnDetach() override { }
-        void OnEvent(Event& /*event*/) override;
 
         virtual void OnTick(TickEvent& e);
         virtual void OnRender(RenderEvent& e);
@@ -36,6 +40,9 @@ namespace labb
     protected:
         void RenderError(const std::string_view& error);
 
+        // Seed for random content, fixed when the application was given one so runs can be compared
+        static unsigned GetSeed();
+
     private:
         bool _bHasError { false };
         std::string _errorString { };
@@ -12,7 +12,12 @@
 
 #include <ranges>
 
+#include "components/Window.h"
+#include "core/Memory.h"
+#include "renderer/GpuMemory.h"
+#include "renderer/GpuTimer.h"
 #include "renderer/Renderer.h"
+#include "renderer/RenderStats.h"
 
 
 namespace labb
@@ -38,6 +43,9 @@ namespace labb
 
         // Draw selection window
         if (_bBigMenu) BeginBigMenu();
+        if (_bTimings) BeginTimingsWindow();
+        if (_bStats) BeginStatsWindow();
+        if (_bMemory) BeginMemoryWindow();
     }
 
     void LLabMenu::BeginLabMenu()
@@ -80,6 +88,53 @@ namespace labb
             }
             ImGui::EndMenu();
         }
+        if (ImGui::BeginMenu("Present"))
+        {
+            Application& app = Application::Get();
+            for (const auto mode : GraphicsContext::PresentModes)
+            {
+                if (ImGui::MenuItem(std::string(GraphicsContext::GetPresentModeString(mode)).c_str(),
+                    nullptr, app.GetPresentMode() == mode))
+                {
+                    app.SetPresentMode(mode);
+                }
+            }
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Frame Limit"))
+        {
+            Application& app = Application::Get();
+            for (const unsigned rate : { 0u, 30u, 60u, 120u, 144u })
+            {
+                const std::string label = rate ? std::to_string(rate) + " Hz" : "Off";
+                if (ImGui::MenuItem(label.c_str(), nullptr, app.GetFramePacer().GetLimit() == rate))
+                {
+                    app.SetFrameLimit(rate);
+                }
+            }
+            ImGui::EndMenu();
+        }
+        if (ImGui::BeginMenu("Frames In Flight"))
+        {
+            GraphicsContext* context = Application::Get().GetWindow()->GetContext();
+            for (unsigned frames = 0; frames <= GraphicsContext::MaxFramesInFlight; frames++)
+            {
+                const std::string label = frames ? std::to_string(frames) : "Driver";
+                if (ImGui::MenuItem(label.c_str(), nullptr, context->GetMaxFramesInFlight() == frames))
+                {
+                    context->SetMaxFramesInFlight(frames);
+                }
+            }
+            ImGui::EndMenu();
+        }
+        ImGui::MenuItem("Pass Timings", nullptr, &_bTimings);
+        ImGui::MenuItem("Frame Stats", nullptr, &_bStats);
+        ImGui::MenuItem("Memory", nullptr, &_bMemory);
+        ImGui::Separator();
+        if (ImGui::MenuItem("Capture Profile", "F11", Profiler::IsCapturing()))
+        {
+            Application::ToggleProfileCapture();
+        }
     }
 
     void LLabMenu::BeginBigMenu()
@@ -118,7 +173,247 @@ namespace labb
         ImGui::PopStyleVar(4);
     }
 
-    void LLabMenu::CreateLabIfExists(const std::string& labShortName)
+    void LLabMenu::BeginTimingsWindow()
+    {
+        constexpr float padding { 15.f };
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos({ viewport->WorkPos.x + padding, viewport->WorkPos.y + viewport->WorkSize.y - padding },
+            ImGuiCond_Always, { 0.0f, 1.0f });
+        ImGui::SetNextWindowBgAlpha(0.75f);
+
+        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings;
+        if (ImGui::Begin("Pass Timings", &_bTimings, flags))
+        {
+            // Passes that stopped running, such as those of a closed lab, drop out after a moment
+            constexpr unsigned staleFrames { 30 };
+
+            const auto lock = GpuTimer::Lock();
+            if (ImGui::BeginTable("timings", 4, ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("Pass");
+                ImGui::TableSetupColumn("CPU ms");
+                ImGui::TableSetupColumn("GPU ms");
+                ImGui::TableSetupColumn("CPU / GPU history");
+                ImGui::TableHeadersRow();
+
+                for (const GpuTimer::Scope& scope : GpuTimer::GetScopes())
+                {
+                    if (scope.lastFrame + staleFrames < GpuTimer::GetFrame()) continue;
+
+                    float cpuTotal { 0.0f }, gpuTotal { 0.0f };
+                    for (unsigned i = 0; i < GpuTimer::HistorySize; i++)
+                    {
+                        cpuTotal += scope.cpuTimes[i];
+                        gpuTotal += scope.gpuTimes[i];
+                    }
+                    constexpr float count { static_cast<float>(GpuTimer::HistorySize) };
+                    const int oldest = static_cast<int>((scope.offset + 1) % GpuTimer::HistorySize);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%*s%s", static_cast<int>(scope.depth) * 2, "", scope.name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", static_cast<double>(cpuTotal / count));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", static_cast<double>(gpuTotal / count));
+                    ImGui::TableNextColumn();
+                    ImGui::PushID(scope.name);
+                    ImGui::PlotLines("##cpu", scope.cpuTimes.data(), static_cast<int>(GpuTimer::HistorySize), oldest,
+                        nullptr, 0.0f, FLT_MAX, ImVec2(100.0f, 20.0f));
+                    ImGui::SameLine();
+                    ImGui::PlotLines("##gpu", scope.gpuTimes.data(), static_cast<int>(GpuTimer::HistorySize), oldest,
+                        nullptr, 0.0f, FLT_MAX, ImVec2(100.0f, 20.0f));
+                    ImGui::PopID();
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+    void LLabMenu::BeginStatsWindow()
+    {
+        constexpr float padding { 15.f };
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos({ viewport->WorkPos.x + viewport->WorkSize.x - padding, viewport->WorkPos.y + viewport->WorkSize.y - padding },
+            ImGuiCond_Always, { 1.0f, 1.0f });
+        ImGui::SetNextWindowBgAlpha(0.75f);
+
+        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings;
+        if (ImGui::Begin("Frame Stats", &_bStats, flags))
+        {
+            const auto lock = RenderStats::Lock();
+            const unsigned frames = RenderStats::GetFrameCount();
+
+            if (ImGui::BeginTable("stats", 4, ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("Counter");
+                ImGui::TableSetupColumn("Last");
+                ImGui::TableSetupColumn("Avg");
+                ImGui::TableSetupColumn("Peak");
+                ImGui::TableHeadersRow();
+
+                auto row = [frames](const char* label, auto getValue)
+                {
+                    uint64_t total { 0 }, peak { 0 };
+                    for (unsigned i = 0; i < frames; i++)
+                    {
+                        const uint64_t value = getValue(RenderStats::GetFrame(i));
+                        total += value;
+                        peak = std::max(peak, value);
+                    }
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(label);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(getValue(RenderStats::GetFrame())));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.1f", frames ? static_cast<double>(total) / frames : 0.0);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(peak));
+                };
+                using Counters = RenderStats::Counters;
+                row("Draw calls",       [](const Counters& c) -> uint64_t { return c.drawCalls; });
+                row("Instances",        [](const Counters& c) -> uint64_t { return c.instances; });
+                row("Indices",          [](const Counters& c) -> uint64_t { return c.indices; });
+                row("Program binds",    [](const Counters& c) -> uint64_t { return c.programBinds; });
+                row("VAO binds",        [](const Counters& c) -> uint64_t { return c.vertexArrayBinds; });
+                row("Texture binds",    [](const Counters& c) -> uint64_t { return c.textureBinds; });
+                row("Uniform uploads",  [](const Counters& c) -> uint64_t { return c.uniformUploads; });
+                row("Clears",           [](const Counters& c) -> uint64_t { return c.clears; });
+                row("Buffer bytes",     [](const Counters& c) -> uint64_t { return c.bufferBytes; });
+                row("Texture bytes",    [](const Counters& c) -> uint64_t { return c.textureBytes; });
+                ImGui::EndTable();
+            }
+
+            // Oldest first
+            std::array<float, RenderStats::HistorySize> drawCalls { };
+            for (unsigned i = 0; i < frames; i++)
+            {
+                drawCalls[frames - 1 - i] = static_cast<float>(RenderStats::GetFrame(i).drawCalls);
+            }
+            ImGui::PlotLines("Draw calls", drawCalls.data(), static_cast<int>(frames), 0, nullptr, 0.0f, FLT_MAX, ImVec2(200.0f, 40.0f));
+
+            // Frame pacing as seen by the main loop
+            const FramePacer& pacer = Application::Get().GetFramePacer();
+            ImGui::Separator();
+            ImGui::Text("Frame time %.2f ms +- %.2f, max %.2f", pacer.GetMean(), pacer.GetDeviation(), pacer.GetMax());
+            const std::array<float, FramePacer::HistorySize>& frameTimes = pacer.GetFrameTimes();
+            ImGui::PlotLines("Frame ms", frameTimes.data(), static_cast<int>(frameTimes.size()), static_cast<int>((pacer.GetOffset() + 1) % FramePacer::HistorySize),
+                nullptr, 0.0f, FLT_MAX, ImVec2(200.0f, 40.0f));
+
+            const GraphicsContext* context = Application::Get().GetWindow()->GetContext();
+            ImGui::Text("GPU queue %u frames, waited %.2f ms", context->GetQueueDepth(), context->GetFenceWait());
+        }
+        ImGui::End();
+    }
+
+    void LLabMenu::BeginMemoryWindow()
+    {
+        constexpr float padding { 15.f };
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos({ viewport->WorkPos.x + viewport->WorkSize.x - padding, viewport->WorkPos.y + padding },
+            ImGuiCond_Always, { 1.0f, 0.0f });
+        ImGui::SetNextWindowBgAlpha(0.75f);
+
+        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings;
+        if (ImGui::Begin("Memory", &_bMemory, flags))
+        {
+            if constexpr (Memory::IsTracking)
+            {
+                const unsigned frames = Memory::GetFrameCount();
+                size_t totalCount { 0 }, totalBytes { 0 }, peakCount { 0 }, peakBytes { 0 };
+                std::array<float, Memory::HistorySize> counts { };
+                for (unsigned i = 0; i < frames; i++)
+                {
+                    const Memory::FrameAllocations& frame = Memory::GetFrame(i);
+                    totalCount += frame.count;
+                    totalBytes += frame.bytes;
+                    peakCount = std::max(peakCount, frame.count);
+                    peakBytes = std::max(peakBytes, frame.bytes);
+                    counts[frames - 1 - i] = static_cast<float>(frame.count);
+                }
+
+                if (ImGui::BeginTable("heap", 4, ImGuiTableFlags_SizingFixedFit))
+                {
+                    ImGui::TableSetupColumn("Heap / frame");
+                    ImGui::TableSetupColumn("Last");
+                    ImGui::TableSetupColumn("Avg");
+                    ImGui::TableSetupColumn("Peak");
+                    ImGui::TableHeadersRow();
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted("Allocations");
+                    ImGui::TableNextColumn(); ImGui::Text("%zu", Memory::GetFrame().count);
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", frames ? static_cast<double>(totalCount) / frames : 0.0);
+                    ImGui::TableNextColumn(); ImGui::Text("%zu", peakCount);
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted("Bytes");
+                    ImGui::TableNextColumn(); ImGui::Text("%zu", Memory::GetFrame().bytes);
+                    ImGui::TableNextColumn(); ImGui::Text("%.0f", frames ? static_cast<double>(totalBytes) / frames : 0.0);
+                    ImGui::TableNextColumn(); ImGui::Text("%zu", peakBytes);
+                    ImGui::EndTable();
+                }
+                ImGui::PlotLines("Allocations", counts.data(), static_cast<int>(frames), 0, nullptr, 0.0f, FLT_MAX, ImVec2(200.0f, 40.0f));
+
+                bool bScopes = Memory::IsScopeTracking();
+                if (ImGui::Checkbox("By profiler scope", &bScopes))
+                {
+                    Memory::SetScopeTracking(bScopes);
+                }
+                if (bScopes && ImGui::BeginTable("scopes", 3, ImGuiTableFlags_SizingFixedFit))
+                {
+                    ImGui::TableSetupColumn("Scope");
+                    ImGui::TableSetupColumn("Allocs");
+                    ImGui::TableSetupColumn("Bytes");
+                    ImGui::TableHeadersRow();
+
+                    constexpr size_t maxRows { 10 };
+                    const std::vector<Memory::ScopeAllocations>& scopes = Memory::GetFrameScopes();
+                    for (size_t i = 0; i < std::min(scopes.size(), maxRows); i++)
+                    {
+                        ImGui::TableNextRow();
+                        ImGui::TableNextColumn(); ImGui::TextUnformatted(scopes[i].name);
+                        ImGui::TableNextColumn(); ImGui::Text("%zu", scopes[i].count);
+                        ImGui::TableNextColumn(); ImGui::Text("%zu", scopes[i].bytes);
+                    }
+                    ImGui::EndTable();
+                }
+            }
+            else
+            {
+                ImGui::TextUnformatted("Heap tracking is only in debug builds");
+            }
+
+            ImGui::Separator();
+            if (ImGui::BeginTable("gpu", 3, ImGuiTableFlags_SizingFixedFit))
+            {
+                ImGui::TableSetupColumn("GPU memory");
+                ImGui::TableSetupColumn("Count");
+                ImGui::TableSetupColumn("KiB");
+                ImGui::TableHeadersRow();
+
+                auto row = [](std::string_view label, const GpuMemory::Usage& usage)
+                {
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn(); ImGui::TextUnformatted(label.data(), label.data() + label.size());
+                    ImGui::TableNextColumn(); ImGui::Text("%lld", static_cast<long long>(usage.count));
+                    ImGui::TableNextColumn(); ImGui::Text("%.1f", static_cast<double>(usage.bytes) / 1024.0);
+                };
+                for (size_t i = 0; i < GpuMemory::ResourceCount; i++)
+                {
+                    const auto resource = static_cast<GpuMemory::Resource>(i);
+                    row(GpuMemory::GetResourceString(resource), GpuMemory::Get(resource));
+                }
+                row("Total", GpuMemory::GetTotal());
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+    }
+
+    bool LLabMenu::CreateLabIfExists(const std::string& labShortName)
     {
         auto matchesShortName = [labShortName](auto& labItem)
         {
@@ -130,6 +425,8 @@ namespace labb
         {
             InitLabEvent event { labItem->second.createInstance };
             EventManager::Get()->Broadcast(event);
+            return true;
         }
+        return false;
     }
 }
@@ -12,13 +12,16 @@ namespace labb
     struct LLabMenuItem
     {
         std::string name;
-        std::function<LLab*()> createInstance;
+        LabFactoryFunc createInstance;
     };
 
     class LLabMenu : public LLab
     {
         std::vector<std::pair<std::string, LLabMenuItem>> _labs;
         bool _bBigMenu { true };
+        bool _bTimings { false };
+        bool _bStats { false };
+        bool _bMemory { false };
 
     public:
         LLabMenu() = default;
@@ -28,6 +31,9 @@ namespace labb
         void BeginLabMenu();
         void BeginRendererMenu();
         void BeginBigMenu();
+        void BeginTimingsWindow();
+        void BeginStatsWindow();
+        void BeginMemoryWindow();
 
         template<typename T>
         void RegisterLab(const std::string& name, const std::string& shortName)
@@ -44,7 +50,8 @@ namespace labb
             });
         }
 
-        void CreateLabIfExists(const std::string& labShortName);
+        // Returns false when no lab is registered with the shortname
+        bool CreateLabIfExists(const std::string& labShortName);
 
         void ShowBigMenu() { _bBigMenu = true; }
         void HideBigMenu() { _bBigMenu = false; }
@@ -6,9 +6,11 @@
 #include "gpch.h"
 #include "Loop.h"
 
+#include "renderer/GpuTimer.h"
 #include "renderer/Renderer.h"
 #include "renderer/RenderCommand.h"
 #include "ElementBuffer.h"
+#include "TextureStreamer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
@@ -26,7 +28,7 @@ namespace labb
         int width, height;
         if (!Renderer::GetFramebufferSize(width, height))
         {
-            std::cout << "Error reading framebuffer size" << std::endl;
+            Log::Error("Loop: Error reading framebuffer size");
         }
 
         RenderCommand::SetClearColor(_bgColor);
@@ -34,7 +36,7 @@ namespace labb
         // Make array of vertices
         auto vertices = MakeCylinder({ 0.0f, 0.0f }, 2.0f, 1.0f, loopSegments);
 
-        const VertexBuffer vbo { vertices.data(), sizeof(Vertex) * loopVerticesCount };
+        _vbo.emplace(vertices.data(), sizeof(Vertex) * loopVerticesCount);
         
         // Define layout
         VertexBufferLayout layout;
@@ -44,26 +46,14 @@ namespace labb
         layout.Push<float>(1); // texture id attribute
         
         // Add vertex buffer with attributes to VAO
-        _vao.AddVertexBuffer(vbo, layout);
+        _vao.AddVertexBuffer(*_vbo, layout);
 
         // Generate element/index buffer and bind to VAO
         unsigned indices[loopIndicesCount];
-        unsigned offset { 0 };
-        for (size_t i = 0; i < loopIndicesCount; i += 6)
-        {
-            indices[i+0] = offset + 0;
-            indices[i+1] = offset + 1;
-            indices[i+2] = offset + 2;
-            
-            indices[i+3] = offset + 2;
-            indices[i+4] = offset + 3;
-            indices[i+5] = offset + 0;
-
-            offset += 4;
-        }
+        MakeQuadIndices(indices);
         
-        const ElementBuffer ebo(indices, loopIndicesCount);
-        _vao.AddElementBuffer(ebo);
+        _ebo.emplace(indices, loopIndicesCount);
+        _vao.AddElementBuffer(*_ebo);
         
         // Define matrices
         const float aspectRatio = static_cast<float>(width) / static_cast<float>(height);
@@ -90,6 +80,8 @@ namespace labb
 
     void LLoop::OnTick(TickEvent& e)
     {
+        GK_PROFILE_FUNCTION();
+
         if (_bSpin)
         {
             _cycle = fmod(_cycle + static_cast<double>(_speed) * e.GetDeltaTime(), 360.0);
@@ -106,6 +98,8 @@ namespace labb
 
     void LLoop::OnRender(RenderEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         RenderCommand::SetClearColor(_bgColor);
         RenderCommand::ClearBuffer();
 
@@ -121,20 +115,38 @@ namespace labb
             return;
         }
 
+        // Texture width wraps half the circumference
+        const float screenSize = TextureStreamer::GetScreenSize(_mvp, glm::vec3(0.0f), std::numbers::pi_v<float> * 2.0f);
+        _texture0.RequestScreenSize(screenSize);
+        _texture1.RequestScreenSize(screenSize);
+        _texture2.RequestScreenSize(screenSize);
+
         _shader->SetUniformMat4f("u_MVP", _mvp);
         _shader->SetUniform1i("u_TexId", _texId);
         _shader->SetUniformVec4f("u_Color", _fgColor);
 
         _vao.Bind();
         // Z-sorting fix: Use either culling + draw 2x or disable depth test
-        glEnable(GL_CULL_FACE);
-        // glDepthMask(GL_FALSE);
-        glCullFace(GL_BACK);
-        Renderer::Render(_vao, _shader);
-        glCullFace(GL_FRONT);
-        Renderer::Render(_vao, _shader);
-        glDisable(GL_CULL_FACE);
-        // glDepthMask(GL_TRUE);
+        RenderCommand::Submit([]
+        {
+            glEnable(GL_CULL_FACE);
+            // glDepthMask(GL_FALSE);
+            glCullFace(GL_BACK);
+        });
+        {
+            GK_GPU_SCOPE("Front faces");
+            Renderer::Render(_vao, _shader);
+        }
+        RenderCommand::Submit([] { glCullFace(GL_FRONT); });
+        {
+            GK_GPU_SCOPE("Back faces");
+            Renderer::Render(_vao, _shader);
+        }
+        RenderCommand::Submit([]
+        {
+            glDisable(GL_CULL_FACE);
+            // glDepthMask(GL_TRUE);
+        });
     }
 
     void LLoop::OnUI(UIEvent& e)
@@ -180,10 +192,10 @@ namespace labb
 
         for (int i = 0; i < segments; i++)
         {
-            const float curX { origin.x + sin(glm::radians(degree)) * radius };
-            const float nextX { origin.x + sin(glm::radians(degree + segStep)) * radius };
-            const float curZ { origin.y + cos(glm::radians(degree)) * radius };
-            const float nextZ { origin.y + cos(glm::radians(degree + segStep)) * radius };
+            const float curX { origin.x + std::sin(glm::radians(degree)) * radius };
+            const float nextX { origin.x + std::sin(glm::radians(degree + segStep)) * radius };
+            const float curZ { origin.y + std::cos(glm::radians(degree)) * radius };
+            const float nextZ { origin.y + std::cos(glm::radians(degree + segStep)) * radius };
             
             // v1
             current->Position = { curX, length * 0.5f, curZ };
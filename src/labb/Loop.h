@@ -7,8 +7,10 @@
 #include "Lab.h"
 
 #include "DataTexture.h"
+#include "ElementBuffer.h"
 #include "renderer/Shader.h"
 #include "VertexArray.h"
+#include "VertexBuffer.h"
 
 
 namespace labb
@@ -40,10 +42,12 @@ namespace labb
 
     private:
         VertexArray _vao {};
+        std::optional<VertexBuffer> _vbo;
+        std::optional<ElementBuffer> _ebo;
         std::shared_ptr<Shader> _shader { Shader::Create( "data/shaders/loop.vert", "data/shaders/loop.frag" ) };
-        Texture _texture0 { "data/textures/loop_alpha_inv.png" };
-        Texture _texture1 { "data/textures/loop_alpha.png" };
-        Texture _texture2 { "data/textures/loop.png" };
+        Texture _texture0 { "data/textures/loop_alpha_inv.png", { }, true };
+        Texture _texture1 { "data/textures/loop_alpha.png", { }, true };
+        Texture _texture2 { "data/textures/loop.png", { }, true };
 
         // Matrices
         glm::mat4 _projection { 1.0f };
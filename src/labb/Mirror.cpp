@@ -6,9 +6,11 @@
 #include "gpch.h"
 #include "Mirror.h"
 
+#include "renderer/GpuTimer.h"
 #include "renderer/Renderer.h"
 #include "renderer/RenderCommand.h"
 #include "ElementBuffer.h"
+#include "TextureStreamer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
@@ -24,7 +26,7 @@ namespace labb
         int width, height;
         if (!Renderer::GetFramebufferSize(width, height))
         {
-            std::cout << "Error reading framebuffer size" << std::endl;
+            Log::Error("Mirror: Error reading framebuffer size");
         }
 
         // Data for triangle
@@ -91,7 +93,7 @@ namespace labb
         _vao.emplace();
 
         // Generate vertex buffer for static draw
-        const VertexBuffer vbo(vertices, sizeof(vertices));
+        _vbo.emplace(vertices, sizeof(vertices));
         
         // Define layout
         VertexBufferLayout layout;
@@ -101,11 +103,11 @@ namespace labb
         layout.Push<float>(1); // texture id attribute, 1 float
 
         // Add vertex buffer with attributes to VAO
-        _vao->AddVertexBuffer(vbo, layout);
+        _vao->AddVertexBuffer(*_vbo, layout);
 
         // Generate element/index buffer and bind to VAO
-        const ElementBuffer ebo(indices, 42);
-        _vao->AddElementBuffer(ebo);
+        _ebo.emplace(indices, 42);
+        _vao->AddElementBuffer(*_ebo);
         
         // Define matrices
         _projection = glm::perspective(45.0f, static_cast<float>(width) / static_cast<float>(height), 1.0f, 10.0f);
@@ -117,8 +119,8 @@ namespace labb
         if (_shader->Bind())
         {
             // Load textures and bind to texture unit
-            _texture1.emplace("data/textures/metal_plates.png");
-            _texture2.emplace("data/textures/ground_base.jpg");
+            _texture1.emplace("data/textures/metal_plates.png", SamplerState { }, true);
+            _texture2.emplace("data/textures/ground_base.jpg", SamplerState { }, true);
             if (_texture1->Bind(0) && _texture2->Bind(1))
             {
                 _shader->SetUniform1iv("u_Textures", { 0, 1 });
@@ -133,6 +135,8 @@ namespace labb
 
     void LMirror::OnTick(TickEvent& e)
     {
+        GK_PROFILE_FUNCTION();
+
         if (_bSpin)
         {
             _cycle = fmod(_cycle + static_cast<double>(_speed) * e.GetDeltaTime(), 360.0);
@@ -147,6 +151,8 @@ namespace labb
 
     void LMirror::OnRender(RenderEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         RenderCommand::SetClearColor({ 0.7f, 0.9f, 0.8f });
         RenderCommand::ClearBuffer();
 
@@ -162,32 +168,51 @@ namespace labb
             return;
         }
 
+        // Report cube face and floor size on screen for texture streaming
+        _texture1->RequestScreenSize(TextureStreamer::GetScreenSize(_mvp, glm::vec3(0.0f), 1.0f));
+        _texture2->RequestScreenSize(TextureStreamer::GetScreenSize(_mvp, glm::vec3(0.0f, -1.0f, 0.0f), 2.0f));
+
         _shader->SetUniformMat4f("u_MVP", _mvp);
         _shader->SetUniform1f("u_ReflectDarken", 1.0f);
         _shader->SetUniform1f("u_ColorAlpha", _colorAlpha);
         _vao->Bind();
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);
+        RenderCommand::Submit([]
+        {
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+        });
 
         // Draw cube
-        Renderer::Render(*_vao, _shader, 0, 35);
+        {
+            GK_GPU_SCOPE("Cube");
+            Renderer::Render(*_vao, _shader, 0, 35);
+        }
 
-        glEnable(GL_STENCIL_TEST); // Start stencil testing
+        RenderCommand::Submit([]
+        {
+            glEnable(GL_STENCIL_TEST); // Start stencil testing
 
-        // Draw plane
-        glStencilFunc(GL_ALWAYS, 1, 0xFF); // Set all bits to 1
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE); // Replace bit value to 1, if dp+st test pass
-        glStencilMask(0xFF); // Write to stencil buffer
-        glDepthMask(false); // Ignore depth buffer
-        glClear(GL_STENCIL_BUFFER_BIT); // Clear default value 0 in buffer
+            // Draw plane
+            glStencilFunc(GL_ALWAYS, 1, 0xFF); // Set all bits to 1
+            glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE); // Replace bit value to 1, if dp+st test pass
+            glStencilMask(0xFF); // Write to stencil buffer
+            glDepthMask(false); // Ignore depth buffer
+            glClear(GL_STENCIL_BUFFER_BIT); // Clear default value 0 in buffer
+        });
 
-        Renderer::Render(*_vao, _shader, 36, 41);
+        {
+            GK_GPU_SCOPE("Floor stencil");
+            Renderer::Render(*_vao, _shader, 36, 41);
+        }
 
         // Draw mirrored cube
-        glStencilFunc(GL_EQUAL, 1, 0xFF); // Set test to value == 1
-        glStencilMask(0x00); // No draw in stencil buffer
-        glDepthMask(true); // Write to depth buffer
+        RenderCommand::Submit([]
+        {
+            glStencilFunc(GL_EQUAL, 1, 0xFF); // Set test to value == 1
+            glStencilMask(0x00); // No draw in stencil buffer
+            glDepthMask(true); // Write to depth buffer
+        });
 
         const glm::mat4 _modelTrans = translate(_model, glm::vec3(0, -2.0, 0));
         _model = glm::scale(_modelTrans, glm::vec3(1, -1, 1));
@@ -195,11 +220,17 @@ namespace labb
         _shader->SetUniformMat4f("u_MVP", _mvp);
         _shader->SetUniform1f("u_ReflectDarken", 1-_reflectDarken);
 
-        glCullFace(GL_BACK);
-        Renderer::Render(*_vao, _shader, 0, 35);
+        RenderCommand::Submit([] { glCullFace(GL_BACK); });
+        {
+            GK_GPU_SCOPE("Reflection");
+            Renderer::Render(*_vao, _shader, 0, 35);
+        }
 
-        glDisable(GL_STENCIL_TEST); // End stencil testing
-        glDisable(GL_CULL_FACE);
+        RenderCommand::Submit([]
+        {
+            glDisable(GL_STENCIL_TEST); // End stencil testing
+            glDisable(GL_CULL_FACE);
+        });
     }
 
     void LMirror::OnUI(UIEvent& e)
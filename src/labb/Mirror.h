@@ -6,7 +6,9 @@
 #pragma once
 #include "Lab.h"
 
+#include "ElementBuffer.h"
 #include "VertexArray.h"
+#include "VertexBuffer.h"
 #include "renderer/Shader.h"
 #include "Texture.h"
 
@@ -31,6 +33,8 @@ namespace labb
 
     private:
         std::optional<VertexArray> _vao;
+        std::optional<VertexBuffer> _vbo;
+        std::optional<ElementBuffer> _ebo;
         std::shared_ptr<Shader> _shader { nullptr };
         std::optional<Texture> _texture1;
         std::optional<Texture> _texture2;
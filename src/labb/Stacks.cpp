@@ -9,6 +9,7 @@
 #include "renderer/Renderer.h"
 #include "renderer/RenderCommand.h"
 #include "ElementBuffer.h"
+#include "TextureStreamer.h"
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 
@@ -24,7 +25,7 @@ namespace labb
         int width, height;
         if (!Renderer::GetFramebufferSize(width, height))
         {
-            std::cout << "Error reading framebuffer size" << std::endl;
+            Log::Error("Stacks: Error reading framebuffer size");
         }
 
         // Data for triangle
@@ -47,7 +48,7 @@ namespace labb
         _vao.emplace();
 
         // Generate vertex buffer for static draw
-        const VertexBuffer vbo(vertices, sizeof(vertices));
+        _vbo.emplace(vertices, sizeof(vertices));
         
         // Define layout
         VertexBufferLayout layout;
@@ -55,11 +56,11 @@ namespace labb
         layout.Push<float>(2); // uv attribute, 2 floats
         
         // Add vertex buffer with attributes to VAO
-        _vao->AddVertexBuffer(vbo, layout);
+        _vao->AddVertexBuffer(*_vbo, layout);
         
         // Generate element/index buffer and bind to VAO
-        const ElementBuffer ebo(indices, 6);
-        _vao->AddElementBuffer(ebo);
+        _ebo.emplace(indices, 6);
+        _vao->AddElementBuffer(*_ebo);
         
         // Define matrices
         _projection = glm::perspective(65.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 100.0f);
@@ -69,7 +70,7 @@ namespace labb
         if (_shader->Bind())
         {
             // Load texture and bind to texture unit
-            _texture.emplace("data/textures/metal_plates.png");
+            _texture.emplace("data/textures/metal_plates.png", SamplerState { }, true);
             if (constexpr int unit=0; _texture->Bind(unit))
             {
                 _shader->SetUniform1i("u_Texture", unit);
@@ -84,6 +85,8 @@ namespace labb
 
     void LStacks::OnTick(TickEvent& e)
     {
+        GK_PROFILE_FUNCTION();
+
         LLab::OnTick(e);
 
         if (_bDoCycle)
@@ -94,11 +97,13 @@ namespace labb
 
     void LStacks::OnRender(RenderEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         RenderCommand::SetClearColor({ 0.0f, 0.0f, 0.0f });
         RenderCommand::ClearBuffer();
 
         // Looks nicer without intersecting triangles 
-        glDisable(GL_DEPTH_TEST);
+        RenderCommand::Submit([] { glDisable(GL_DEPTH_TEST); });
 
         if (!_shader->Bind())
         {
@@ -125,22 +130,23 @@ namespace labb
 
             if (_bCycleColor)
             {
-                _color.r = 0.5f + cos(rad) * 0.5f;
-                _color.g = 0.5f + sin(rad) * 0.5f;
-                _color.b = 0.5f + sin(rad + std::numbers::pi_v<float>) * 0.5f;
+                _color.r = 0.5f + std::cos(rad) * 0.5f;
+                _color.g = 0.5f + std::sin(rad) * 0.5f;
+                _color.b = 0.5f + std::sin(rad + std::numbers::pi_v<float>) * 0.5f;
             }
 
             _model = translate(glm::mat4(1.0f), t);
-            _model = rotate(_model, std::numbers::pi_v<float> * 0.2f * sin(rad), glm::vec3(0.0f, 1.0f, 0.0f));
+            _model = rotate(_model, std::numbers::pi_v<float> * 0.2f * std::sin(rad), glm::vec3(0.0f, 1.0f, 0.0f));
             _model = rotate(_model, std::numbers::pi_v<float> * 2.0f * glm::fract(static_cast<float>(_cycle)*2.0f/360.0f), glm::vec3(0.0f, 0.0f, 1.0f));
             _model = scale(_model, glm::vec3(0.7f));
             _mvp = _projection * _view * _model;
+            _texture->RequestScreenSize(TextureStreamer::GetScreenSize(_mvp, glm::vec3(0.0f), 1.0f));
             _shader->SetUniformMat4f("u_MVP", _mvp);
             _shader->SetUniformVec4f("u_Color", _color);
             Renderer::Render(*_vao, _shader);
         }
 
-        glEnable(GL_DEPTH_TEST);
+        RenderCommand::Submit([] { glEnable(GL_DEPTH_TEST); });
     }
 
     void LStacks::OnUI(UIEvent& e)
@@ -0,0 +1,241 @@
+﻿/**
+ * Grafik
+ * Lab: Swarm
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "Swarm.h"
+
+#include "renderer/Renderer.h"
+#include "renderer/RenderCommand.h"
+#include "ElementBuffer.h"
+#include "VertexBufferLayout.h"
+
+#include <imgui/imgui.h>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+
+
+namespace labb
+{
+    LSwarm::LSwarm()
+    {
+        int width, height;
+        if (!Renderer::GetFramebufferSize(width, height))
+        {
+            Log::Error("Error reading framebuffer size");
+        }
+
+        // Define layout
+        VertexBufferLayout layout;
+        layout.Push<glm::vec3>(1); // position attribute
+        layout.Push<glm::vec4>(1); // color attribute
+        layout.Push<glm::vec2>(1); // uv attribute
+        layout.Push<float>(1); // texture id attribute
+        _vao.AddVertexBuffer(_vbo, layout);
+
+        _vertices = std::make_unique_for_overwrite<Vertex[]>(swarmCapacity * 4);
+
+        // Generate element/index buffer and bind to VAO
+        std::vector<unsigned> indices(swarmCapacity * 6);
+        unsigned offset { 0 };
+        for (size_t i = 0; i < indices.size(); i += 6)
+        {
+            indices[i+0] = offset + 0;
+            indices[i+1] = offset + 1;
+            indices[i+2] = offset + 2;
+
+            indices[i+3] = offset + 2;
+            indices[i+4] = offset + 3;
+            indices[i+5] = offset + 0;
+
+            offset += 4;
+        }
+        _ebo.emplace(indices.data(), static_cast<int>(indices.size()));
+        _vao.AddElementBuffer(*_ebo);
+
+        _projection = glm::perspective(45.0f, static_cast<float>(width) / static_cast<float>(height), 0.1f, 15.0f);
+
+        // Every quad samples a single white texel, color comes from Tint
+        if (_shader->Bind())
+        {
+            _texture.emplace(true);
+            if (_texture->Bind(0))
+            {
+                _shader->SetUniform1iv("u_Textures", { 0, 0, 0 });
+            }
+        }
+
+        // Steer runs first, Move and Tint only read velocity and write different components so they run side by side.
+        // Each system also splits its entities across the job system
+        _scheduler.Add("Steer", ecs::Read<Position>{}, ecs::Write<Velocity>{}, [this](ecs::Registry& registry, double deltaTime)
+        {
+            const float dt = static_cast<float>(deltaTime);
+            const glm::vec3 target = _target;
+            const float attraction = _attraction;
+            const float maxSpeed = _maxSpeed;
+            auto view = registry.GetView<Position, Velocity>();
+            JobSystem::ParallelFor(view.GetSize(), [&](size_t begin, size_t end)
+            {
+                view.Each(begin, end, [=](ecs::Entity, const Position& position, Velocity& velocity)
+                {
+                    const glm::vec3 toTarget = target - position.value;
+                    const float distance = glm::length(toTarget) + 0.001f;
+                    const glm::vec3 swirl { -toTarget.y, toTarget.x, 0.0f };
+                    velocity.value += (toTarget / distance * attraction + swirl * 0.5f) * dt;
+                    const float speed = glm::length(velocity.value);
+                    if (speed > maxSpeed)
+                    {
+                        velocity.value *= maxSpeed / speed;
+                    }
+                });
+            });
+        });
+
+        _scheduler.Add("Move", ecs::Read<Velocity>{}, ecs::Write<Position>{}, [](ecs::Registry& registry, double deltaTime)
+        {
+            const float dt = static_cast<float>(deltaTime);
+            auto view = registry.GetView<Position, Velocity>();
+            JobSystem::ParallelFor(view.GetSize(), [&](size_t begin, size_t end)
+            {
+                view.Each(begin, end, [=](ecs::Entity, Position& position, const Velocity& velocity)
+                {
+                    position.value += velocity.value * dt;
+                });
+            });
+        });
+
+        _scheduler.Add("Tint", ecs::Read<Velocity>{}, ecs::Write<Tint>{}, [this](ecs::Registry& registry, double)
+        {
+            const float invMaxSpeed = 1.0f / std::max(_maxSpeed, 0.001f);
+            auto view = registry.GetView<Tint, Velocity>();
+            JobSystem::ParallelFor(view.GetSize(), [&](size_t begin, size_t end)
+            {
+                view.Each(begin, end, [=](ecs::Entity, Tint& tint, const Velocity& velocity)
+                {
+                    const float t = std::min(glm::length(velocity.value) * invMaxSpeed, 1.0f);
+                    tint.value = { t, 0.3f + 0.4f * (1.0f - t), 1.0f - t, 1.0f };
+                });
+            });
+        });
+
+        Resize(static_cast<size_t>(_count));
+
+        // unbind state
+        Shader::Unbind();
+        VertexArray::Unbind();
+        VertexBuffer::Unbind();
+    }
+
+    void LSwarm::Resize(size_t count)
+    {
+        std::uniform_real_distribution<float> spread { -2.0f, 2.0f };
+        while (_entities.size() < count)
+        {
+            const ecs::Entity entity = _registry.Create();
+            _registry.Emplace<Position>(entity, glm::vec3 { spread(_randomEngine), spread(_randomEngine), spread(_randomEngine) * 0.25f });
+            _registry.Emplace<Velocity>(entity, glm::vec3 { 0.0f });
+            _registry.Emplace<Tint>(entity, glm::vec4 { 1.0f });
+            _entities.push_back(entity);
+        }
+        while (_entities.size() > count)
+        {
+            _registry.Destroy(_entities.back());
+            _entities.pop_back();
+        }
+    }
+
+    void LSwarm::OnTick(TickEvent& e)
+    {
+        GK_PROFILE_FUNCTION();
+
+        Resize(static_cast<size_t>(_count));
+
+        // Target wanders on a figure eight
+        _time += e.GetDeltaTime();
+        const float t = static_cast<float>(_time) * 0.5f;
+        _target = { 1.5f * std::sin(t), 0.75f * std::sin(2.0f * t), 0.0f };
+
+        _scheduler.Run(_registry, e.GetDeltaTime());
+
+        _view = glm::translate(glm::mat4(1.0f), _cameraPosition);
+        _mvp = _projection * _view;
+    }
+
+    void LSwarm::OnRender(RenderEvent&)
+    {
+        GK_PROFILE_FUNCTION();
+
+        RenderCommand::SetClearColor({ 0.05f, 0.05f, 0.08f });
+        RenderCommand::ClearBuffer();
+
+        if (_entities.empty()) return;
+
+        if (!_shader->Bind())
+        {
+            RenderError("Shader error!");
+            return;
+        }
+
+        if (!_texture->Bind(0))
+        {
+            RenderError("Failed to load texture!");
+            return;
+        }
+
+        // Fill vertices straight from the packed pools
+        Vertex* vertexPtr = _vertices.get();
+        const float half { _size * 0.5f };
+        _registry.GetView<Position, Tint>().Each([&](ecs::Entity, const Position& position, const Tint& tint)
+        {
+            const glm::vec3& p = position.value;
+            *vertexPtr++ = { { p.x - half, p.y + half, p.z }, tint.value, { 0.0f, 1.0f }, 0.0f };
+            *vertexPtr++ = { { p.x + half, p.y + half, p.z }, tint.value, { 1.0f, 1.0f }, 0.0f };
+            *vertexPtr++ = { { p.x + half, p.y - half, p.z }, tint.value, { 1.0f, 0.0f }, 0.0f };
+            *vertexPtr++ = { { p.x - half, p.y - half, p.z }, tint.value, { 0.0f, 0.0f }, 0.0f };
+        });
+        const size_t quads = static_cast<size_t>(vertexPtr - _vertices.get()) / 4;
+
+        _vbo.SetData(_vertices.get(), static_cast<unsigned>(quads * 4 * sizeof(Vertex)));
+
+        _shader->SetUniformMat4f("u_MVP", _mvp);
+
+        _vao.Bind();
+        Renderer::Render(_vao, _shader, 0, static_cast<int>(quads * 6 - 1));
+    }
+
+    void LSwarm::OnUI(UIEvent& e)
+    {
+        LLab::OnUI(e);
+
+        // Create Settings window
+        constexpr float padding { 15.f };
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        constexpr ImGuiWindowFlags flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings;
+        const ImVec2 workPos = viewport->WorkPos;
+        const ImVec2 workSize = viewport->WorkSize;
+        ImVec2 position;
+        position.x = workPos.x + workSize.x - padding;
+        position.y = workPos.y + padding;
+        ImGui::SetNextWindowBgAlpha(0.75f);
+        ImGui::SetNextWindowPos(position, ImGuiCond_Always, { 1.0f, 0.0f });
+
+        ImGui::Begin("Settings", &_keepAlive, flags);
+        ImGui::Text("Render %.3f ms/f (%.1f fps)", 1000.0 / static_cast<double>(ImGui::GetIO().Framerate),
+            static_cast<double>(ImGui::GetIO().Framerate));
+        ImGui::Text("Entities: %d", static_cast<int>(_registry.GetCount()));
+        ImGui::SameLine(0, 20.0f);
+        ImGui::Text("Stages: %d", static_cast<int>(_scheduler.GetStageCount()));
+        for (const ecs::Scheduler::System& system : _scheduler.GetSystems())
+        {
+            ImGui::BulletText("%s (stage %d)", system.name.c_str(), static_cast<int>(system.stage));
+        }
+        ImGui::Separator();
+        ImGui::DragInt("Entities", &_count, 10, 0, swarmCapacity, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Attraction", &_attraction, 0.0f, 5.0f);
+        ImGui::SliderFloat("Max speed", &_maxSpeed, 0.1f, 5.0f);
+        ImGui::SliderFloat("Size", &_size, 0.002f, 0.1f, "%.3f", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderFloat("Camera Z", &_cameraPosition.z, -10.0f, -1.0f);
+        ImGui::End();
+    }
+}
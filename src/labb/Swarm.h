@@ -0,0 +1,66 @@
+﻿/**
+ * Grafik
+ * Lab: Swarm
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "Lab.h"
+
+#include "DataTexture.h"
+#include "ElementBuffer.h"
+#include "VertexArray.h"
+#include "VertexBuffer.h"
+#include "renderer/Shader.h"
+#include "ecs/Scheduler.h"
+
+#include <random>
+
+
+namespace labb
+{
+    constexpr size_t swarmCapacity { 100000 };
+
+    class LSwarm : public LLab
+    {
+        struct Position { glm::vec3 value; };
+        struct Velocity { glm::vec3 value; };
+        struct Tint { glm::vec4 value; };
+
+        int         _count          { 20000 };
+        float       _attraction     { 1.5f };
+        float       _maxSpeed       { 1.2f };
+        float       _size           { 0.015f };
+        double      _time           { 0 };
+        glm::vec3   _target         { 0.0f };
+        glm::vec3   _cameraPosition { 0.0f, 0.0f, -5.0f };
+
+    public:
+        LSwarm();
+        ~LSwarm() override = default;
+
+        void OnTick(TickEvent& e) override;
+        void OnRender(RenderEvent& e) override;
+        void OnUI(UIEvent& e) override;
+
+    private:
+        ecs::Registry _registry { };
+        ecs::Scheduler _scheduler { };
+        std::vector<ecs::Entity> _entities { };
+
+        VertexArray _vao {};
+        VertexBuffer _vbo { nullptr, sizeof(Vertex) * swarmCapacity * 4, true };
+        std::optional<ElementBuffer> _ebo;
+        std::shared_ptr<Shader> _shader { Shader::Create( "data/shaders/batch.vert", "data/shaders/batch.frag" ) };
+        std::optional<DataTexture> _texture;
+        std::unique_ptr<Vertex[]> _vertices { };
+
+        std::default_random_engine _randomEngine { };
+
+        // Matrices
+        glm::mat4 _projection { 1.0f };
+        glm::mat4 _view { 1.0f };
+        glm::mat4 _mvp { 1.0f };
+
+        void Resize(size_t count);
+    };
+}
@@ -24,7 +24,7 @@ namespace labb
         int width, height;
         if (!Renderer::GetFramebufferSize(width, height))
         {
-            std::cout << "Error reading framebuffer size" << std::endl;
+            Log::Error("Triangle: Error reading framebuffer size");
         }
         
         // Data for triangle
@@ -45,7 +45,7 @@ namespace labb
         if (!_vao) _vao.emplace();
     
         // Generate vertex buffer for static draw
-        const VertexBuffer vbo(vertices, sizeof(vertices));
+        _vbo.emplace(vertices, sizeof(vertices));
         
         // Define layout
         VertexBufferLayout layout;
@@ -53,11 +53,11 @@ namespace labb
         layout.Push<float>(4); // color attribute, 4 floats
 
         // Add vertex buffer with attributes to VAO
-        _vao->AddVertexBuffer(vbo, layout);
+        _vao->AddVertexBuffer(*_vbo, layout);
 
         // Generate element/index buffer and bind to VAO
-        const ElementBuffer ebo(indices, 3);
-        _vao->AddElementBuffer(ebo);
+        _ebo.emplace(indices, 3);
+        _vao->AddElementBuffer(*_ebo);
         
         // Define matrices
         _projection = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f);
@@ -78,6 +78,8 @@ namespace labb
 
     void LTriangle::OnTick(TickEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         // Update matrices with current rotation
         _model = rotate(glm::mat4(1.0f), _rotation.x, glm::vec3(1.0f, 0.0f, 0.0f));
         _model = rotate(_model, _rotation.y, glm::vec3(0.0f, 1.0f, 0.0f));
@@ -88,6 +90,8 @@ namespace labb
 
     void LTriangle::OnRender(RenderEvent&)
     {
+        GK_PROFILE_FUNCTION();
+
         RenderCommand::SetClearColor({ 0.6f, 0.6f, 0.6f });
         RenderCommand::ClearBuffer();
 
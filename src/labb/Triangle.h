@@ -6,7 +6,9 @@
 #pragma once
 #include "Lab.h"
 
+#include "ElementBuffer.h"
 #include "VertexArray.h"
+#include "VertexBuffer.h"
 #include "renderer/Shader.h"
 
 
@@ -25,6 +27,8 @@ namespace labb
 
     private:
         std::optional<VertexArray> _vao;
+        std::optional<VertexBuffer> _vbo;
+        std::optional<ElementBuffer> _ebo;
         std::shared_ptr<Shader> _triangleShader { nullptr };
 
         // Matrices
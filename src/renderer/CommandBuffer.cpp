@@ -0,0 +1,96 @@
+﻿/**
+ * Grafik
+ * CommandBuffer
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "CommandBuffer.h"
+
+#include <algorithm>
+
+
+namespace
+{
+    size_t AlignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Entries are aligned for any payload, which starts right after its header
+    constexpr size_t EntryAlignment { alignof(std::max_align_t) };
+}
+
+std::byte* CommandBuffer::Push(ExecuteFunc execute, size_t size)
+{
+    const size_t total = AlignUp(HeaderSize + size, EntryAlignment);
+
+    // Move on to the next block when this one is full, blocks are kept for reuse
+    if (_blocks.empty() || _blocks[_current].used + total > _blocks[_current].size)
+    {
+        if (!_blocks.empty())
+        {
+            _current++;
+        }
+
+        // Large uploads get a block their size, it replaces an unused smaller one so the count stays put
+        const size_t blockSize = std::max(BlockSize, total);
+        if (_current == _blocks.size())
+        {
+            _blocks.push_back({ std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize, 0 });
+        }
+        else if (_blocks[_current].size < total)
+        {
+            _blocks[_current] = { std::make_unique_for_overwrite<std::byte[]>(blockSize), blockSize, 0 };
+        }
+    }
+
+    Block& block = _blocks[_current];
+    std::byte* start = block.data.get() + block.used;
+    block.used += total;
+
+    new (start) Header { execute, static_cast<uint32_t>(total) };
+    return start + HeaderSize;
+}
+
+void* CommandBuffer::Allocate(size_t size)
+{
+    return Push(nullptr, size);
+}
+
+void CommandBuffer::Execute() const
+{
+    for (size_t i = 0; i < _blocks.size() && i <= _current; i++)
+    {
+        const Block& block = _blocks[i];
+        size_t offset { 0 };
+        while (offset < block.used)
+        {
+            const auto* header = reinterpret_cast<const Header*>(block.data.get() + offset);
+            if (header->execute)
+            {
+                header->execute(block.data.get() + offset + HeaderSize);
+            }
+            offset += header->size;
+        }
+    }
+}
+
+void CommandBuffer::Reset()
+{
+    for (Block& block : _blocks)
+    {
+        block.used = 0;
+    }
+    _current = 0;
+    _commandCount = 0;
+}
+
+size_t CommandBuffer::GetUsedBytes() const
+{
+    size_t used { 0 };
+    for (const Block& block : _blocks)
+    {
+        used += block.used;
+    }
+    return used;
+}
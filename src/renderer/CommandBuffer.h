@@ -0,0 +1,76 @@
+﻿/**
+ * Grafik
+ * CommandBuffer
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+
+/**
+ * Linear arena of POD render commands, recorded on one thread and executed on another.
+ * A command is any trivially copyable struct with a `void Execute() const`. Memory is kept
+ * in blocks that are reused after Reset, so steady frames don't allocate.
+ */
+class CommandBuffer
+{
+public:
+    static constexpr size_t BlockSize { 64 * 1024 };
+
+    CommandBuffer() = default;
+
+    CommandBuffer(const CommandBuffer&) = delete;
+    CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+    template <typename C>
+    void Record(const C& command);
+
+    // Scratch memory for data a command points to (vertex data, strings), valid until Reset.
+    // Aligned for any type, larger than a block gets a block of its own
+    [[nodiscard]] void* Allocate(size_t size);
+
+    // Run every command in recording order
+    void Execute() const;
+    void Reset();
+
+    [[nodiscard]] size_t GetCommandCount() const { return _commandCount; }
+    [[nodiscard]] size_t GetUsedBytes() const;
+    [[nodiscard]] bool IsEmpty() const { return _commandCount == 0; }
+
+private:
+    using ExecuteFunc = void(*)(const void* command);
+
+    struct Header
+    {
+        ExecuteFunc execute { nullptr };    // nullptr marks scratch data, skipped when executing
+        uint32_t size { 0 };                // header and payload, to the next header
+    };
+    static constexpr size_t HeaderSize { (sizeof(Header) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1) };
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data { };
+        size_t size { 0 };
+        size_t used { 0 };
+    };
+
+    std::vector<Block> _blocks { };
+    size_t _current { 0 };
+    size_t _commandCount { 0 };
+
+    [[nodiscard]] std::byte* Push(ExecuteFunc execute, size_t size);
+};
+
+template <typename C>
+void CommandBuffer::Record(const C& command)
+{
+    static_assert(std::is_trivially_copyable_v<C> && std::is_trivially_destructible_v<C>, "Commands must be POD");
+    static_assert(alignof(C) <= alignof(std::max_align_t));
+
+    std::byte* payload = Push([](const void* data) { static_cast<const C*>(data)->Execute(); }, sizeof(C));
+    std::memcpy(payload, &command, sizeof(C));
+    _commandCount++;
+}
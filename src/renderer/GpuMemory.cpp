@@ -0,0 +1,84 @@
+﻿/**
+ * Grafik
+ * GpuMemory
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "GpuMemory.h"
+
+
+std::array<std::atomic<int64_t>, GpuMemory::ResourceCount> GpuMemory::_counts { };
+std::array<std::atomic<int64_t>, GpuMemory::ResourceCount> GpuMemory::_bytes { };
+
+void GpuMemory::Allocate(Resource resource, size_t bytes)
+{
+    const auto index = static_cast<size_t>(resource);
+    _counts[index].fetch_add(1, std::memory_order_relaxed);
+    _bytes[index].fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+void GpuMemory::Free(Resource resource, size_t bytes)
+{
+    const auto index = static_cast<size_t>(resource);
+    _counts[index].fetch_sub(1, std::memory_order_relaxed);
+    _bytes[index].fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+GpuMemory::Usage GpuMemory::Get(Resource resource)
+{
+    const auto index = static_cast<size_t>(resource);
+    return { _counts[index].load(std::memory_order_relaxed), _bytes[index].load(std::memory_order_relaxed) };
+}
+
+GpuMemory::Usage GpuMemory::GetTotal()
+{
+    Usage total;
+    for (size_t i = 0; i < ResourceCount; i++)
+    {
+        const Usage usage = Get(static_cast<Resource>(i));
+        total.count += usage.count;
+        total.bytes += usage.bytes;
+    }
+    return total;
+}
+
+GpuMemory::Snapshot GpuMemory::GetSnapshot()
+{
+    Snapshot snapshot;
+    for (size_t i = 0; i < ResourceCount; i++)
+    {
+        snapshot[i] = Get(static_cast<Resource>(i));
+    }
+    return snapshot;
+}
+
+bool GpuMemory::CheckLeaks(const Snapshot& baseline)
+{
+    bool clean { true };
+    for (size_t i = 0; i < ResourceCount; i++)
+    {
+        const auto resource = static_cast<Resource>(i);
+        const Usage usage = Get(resource);
+        if (usage.count > baseline[i].count || usage.bytes > baseline[i].bytes)
+        {
+            Log::Warn("GpuMemory: {} still holds {} more ({} bytes) than before",
+                GetResourceString(resource), usage.count - baseline[i].count, usage.bytes - baseline[i].bytes);
+            clean = false;
+        }
+    }
+    return clean;
+}
+
+std::string_view GpuMemory::GetResourceString(Resource resource)
+{
+    switch (resource)
+    {
+        case Resource::VertexBuffer:    return "Vertex buffers";
+        case Resource::ElementBuffer:   return "Element buffers";
+        case Resource::Texture:         return "Textures";
+        case Resource::DataTexture:     return "Data textures";
+        case Resource::Shader:          return "Shaders";
+        case Resource::Count:           break;
+    }
+    return "Unknown";
+}
@@ -0,0 +1,53 @@
+﻿/**
+ * Grafik
+ * GpuMemory
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <atomic>
+
+
+/**
+ * Ledger of the GPU memory held per resource type. Resources register their storage when they
+ * allocate it and release the same size when they free it, so a total that doesn't return to where
+ * it was after a lab is closed is a leak. Sizes are what was requested, not what the driver reserves.
+ */
+class GpuMemory
+{
+public:
+    enum class Resource : unsigned char
+    {
+        VertexBuffer,
+        ElementBuffer,
+        Texture,
+        DataTexture,
+        Shader,
+        Count
+    };
+    static constexpr size_t ResourceCount { static_cast<size_t>(Resource::Count) };
+
+    struct Usage
+    {
+        int64_t count { 0 };
+        int64_t bytes { 0 };
+    };
+    using Snapshot = std::array<Usage, ResourceCount>;
+
+    static void Allocate(Resource resource, size_t bytes);
+    static void Free(Resource resource, size_t bytes);
+
+    // Safe to read from any thread
+    [[nodiscard]] static Usage Get(Resource resource);
+    [[nodiscard]] static Usage GetTotal();
+    [[nodiscard]] static Snapshot GetSnapshot();
+
+    // Logs the resource types holding more than in the baseline, returns false if any do
+    static bool CheckLeaks(const Snapshot& baseline);
+
+    static std::string_view GetResourceString(Resource resource);
+
+private:
+    static std::array<std::atomic<int64_t>, ResourceCount> _counts;
+    static std::array<std::atomic<int64_t>, ResourceCount> _bytes;
+};
@@ -0,0 +1,185 @@
+﻿/**
+ * Grafik
+ * GpuTimer
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "GpuTimer.h"
+
+#include "renderer/RenderCommand.h"
+#include "renderer/RendererAPI.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+
+
+namespace
+{
+    // Frames in flight before a frame's queries are reused
+    constexpr unsigned frameLatency { 4 };
+
+    struct Mark
+    {
+        const char* name;
+        unsigned depth;
+        int64_t cpuStart;
+        int64_t cpuEnd;
+    };
+
+    struct FrameSlot
+    {
+        std::vector<GLuint> queries { };    // begin and end timestamp per mark, grows on demand
+        std::vector<Mark> marks { };
+        unsigned frame { 0 };
+        bool pending { false };
+    };
+
+    std::array<FrameSlot, frameLatency> slots { };
+    FrameSlot* current { nullptr };
+    std::vector<unsigned> openMarks { };    // marks not yet ended in the current frame
+
+    struct BeginCommand
+    {
+        const char* name;
+        void Execute() const { GpuTimer::Begin(name); }
+    };
+
+    struct EndCommand
+    {
+        void Execute() const { GpuTimer::End(); }
+    };
+}
+
+void GpuTimer::BeginFrame()
+{
+    current = nullptr;
+    openMarks.clear();
+    if (RendererAPI::GetAPI() != RendererAPI::API::OpenGL) return;
+
+    // Read back finished frames oldest first, stop at the first one the GPU is still working on
+    for (unsigned i = 1; i <= frameLatency; i++)
+    {
+        const unsigned slot = (_frame + i) % frameLatency;
+        if (!slots[slot].pending) continue;
+
+        const std::vector<Mark>& marks = slots[slot].marks;
+        GLint available { 0 };
+        glGetQueryObjectiv(slots[slot].queries[marks.size() * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        Resolve(slot);
+    }
+
+    {
+        const std::lock_guard lock { _mutex };
+        _frame++;
+    }
+    current = &slots[_frame % frameLatency];
+
+    // Still not done after a full ring, drop it rather than wait
+    current->pending = false;
+    current->marks.clear();
+    current->frame = _frame;
+}
+
+void GpuTimer::Begin(const char* name)
+{
+    if (RenderThread::ShouldRecord())
+    {
+        RenderCommand::Submit(BeginCommand { name });
+        return;
+    }
+    if (!current) return;
+
+    const size_t index = current->marks.size();
+    if (current->queries.size() < (index + 1) * 2)
+    {
+        const size_t count = current->queries.size();
+        current->queries.resize(std::max<size_t>(count * 2, 16));
+        glGenQueries(static_cast<GLsizei>(current->queries.size() - count), current->queries.data() + count);
+    }
+
+    glQueryCounter(current->queries[index * 2], GL_TIMESTAMP);
+    current->marks.push_back({ name, static_cast<unsigned>(openMarks.size()), Profiler::Now(), 0 });
+    openMarks.push_back(static_cast<unsigned>(index));
+}
+
+void GpuTimer::End()
+{
+    if (RenderThread::ShouldRecord())
+    {
+        RenderCommand::Submit(EndCommand { });
+        return;
+    }
+    if (!current || openMarks.empty()) return;
+
+    const unsigned index = openMarks.back();
+    openMarks.pop_back();
+
+    glQueryCounter(current->queries[index * 2 + 1], GL_TIMESTAMP);
+    current->marks[index].cpuEnd = Profiler::Now();
+
+    // Results are only read once every scope of the frame is closed
+    if (openMarks.empty())
+    {
+        current->pending = true;
+    }
+}
+
+void GpuTimer::Clear()
+{
+    for (FrameSlot& slot : slots)
+    {
+        if (!slot.queries.empty())
+        {
+            glDeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        }
+        slot = FrameSlot { };
+    }
+    current = nullptr;
+    openMarks.clear();
+
+    const std::lock_guard lock { _mutex };
+    _scopes.clear();
+}
+
+void GpuTimer::Resolve(unsigned slot)
+{
+    FrameSlot& frame = slots[slot];
+    frame.pending = false;
+
+    const std::lock_guard lock { _mutex };
+    for (size_t i = 0; i < frame.marks.size(); i++)
+    {
+        const Mark& mark = frame.marks[i];
+        GLuint64 begin { 0 }, end { 0 };
+        glGetQueryObjectui64v(frame.queries[i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+
+        const float gpuTime = static_cast<float>(static_cast<double>(end - begin) / 1e6);
+        const float cpuTime = static_cast<float>(static_cast<double>(mark.cpuEnd - mark.cpuStart) / 1e6);
+
+        auto scope = std::ranges::find(_scopes, mark.name, &Scope::name);
+        if (scope == _scopes.end())
+        {
+            scope = _scopes.insert(_scopes.end(), Scope { mark.name });
+        }
+        scope->depth = mark.depth;
+        scope->cpuTotal += cpuTime;
+        scope->gpuTotal += gpuTime;
+
+        // Passes issued several times in a frame add up
+        if (scope->lastFrame == frame.frame)
+        {
+            scope->cpuTimes[scope->offset] += cpuTime;
+            scope->gpuTimes[scope->offset] += gpuTime;
+            continue;
+        }
+        scope->offset = (scope->offset + 1) % HistorySize;
+        scope->cpuTimes[scope->offset] = cpuTime;
+        scope->gpuTimes[scope->offset] = gpuTime;
+        scope->lastFrame = frame.frame;
+        scope->frames++;
+    }
+}
@@ -0,0 +1,71 @@
+﻿/**
+ * Grafik
+ * GpuTimer
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <mutex>
+
+
+/**
+ * Named GPU pass timings from OpenGL timestamp queries. Queries of the last few frames are kept
+ * in a ring and only read back once available, so timing never stalls the pipeline; a frame whose
+ * results are not ready in time is dropped. Each scope also measures the CPU time spent issuing it.
+ * Call from the thread that owns the context; scopes opened while the render thread is active are
+ * recorded and timed where they execute. Scope names must be string literals.
+ */
+class GpuTimer
+{
+public:
+    static constexpr unsigned HistorySize { 120 };
+
+    struct Scope
+    {
+        const char* name { nullptr };
+        unsigned depth { 0 };
+        std::array<float, HistorySize> cpuTimes { };   // ms, ring with the newest sample at offset
+        std::array<float, HistorySize> gpuTimes { };
+        unsigned offset { 0 };
+        unsigned lastFrame { 0 };                       // frame of the newest sample
+        unsigned frames { 0 };                          // totals since the scope first ran
+        double cpuTotal { 0.0 };
+        double gpuTotal { 0.0 };
+    };
+
+    // Reads back finished frames and starts recording a new one
+    static void BeginFrame();
+
+    static void Begin(const char* name);
+    static void End();
+
+    // Deletes the query objects, call while the owning context is still current
+    static void Clear();
+
+    [[nodiscard]] static unsigned GetFrame() { return _frame; }
+
+    // Locks the history for reading from another thread
+    [[nodiscard]] static std::unique_lock<std::mutex> Lock() { return std::unique_lock { _mutex }; }
+    [[nodiscard]] static const std::vector<Scope>& GetScopes() { return _scopes; }
+
+private:
+    static void Resolve(unsigned slot);
+
+    inline static std::mutex _mutex { };
+    inline static std::vector<Scope> _scopes { };   // guarded by _mutex
+    inline static unsigned _frame { 0 };            // guarded by _mutex
+};
+
+class GpuScope
+{
+public:
+    explicit GpuScope(const char* name) { GpuTimer::Begin(name); }
+    ~GpuScope() { GpuTimer::End(); }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+};
+
+#define GK_GPU_SCOPE(name) GK_PROFILE_SCOPE(name); const GpuScope GK_GPU_JOIN(gpuScope, __LINE__) { name }
+#define GK_GPU_JOIN_(a, b) a##b
+#define GK_GPU_JOIN(a, b) GK_GPU_JOIN_(a, b)
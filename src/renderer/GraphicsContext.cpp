@@ -8,6 +8,7 @@
 
 #include "renderer/RendererAPI.h"
 #include "renderer/opengl/OpenGLContext.h"
+#include "renderer/opengl/OpenGLHeadlessContext.h"
 #include "renderer/vulkan/VulkanContext.h"
 
 
@@ -21,3 +22,26 @@ std::unique_ptr<GraphicsContext> GraphicsContext::Create()
     }
     return nullptr;
 }
+
+std::unique_ptr<GraphicsContext> GraphicsContext::CreateHeadless()
+{
+#ifdef GK_LINUX
+    if (RendererAPI::GetAPI() == RendererAPI::API::OpenGL)
+    {
+        return std::make_unique<OpenGLHeadlessContext>();
+    }
+#endif
+    // WGL needs a window, a hidden one stands in
+    return nullptr;
+}
+
+std::string_view GraphicsContext::GetPresentModeString(PresentMode mode)
+{
+    switch (mode)
+    {
+        case PresentMode::VSync:        return "VSync";
+        case PresentMode::Immediate:    return "Immediate";
+        case PresentMode::Adaptive:     return "Adaptive";
+    }
+    return "Unknown";
+}
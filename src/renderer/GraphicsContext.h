@@ -5,19 +5,57 @@
  */
 #pragma once
 
+#include <atomic>
+
 
 struct GLFWwindow;
 
 class GraphicsContext
 {
 public:
+    enum class PresentMode : unsigned char
+    {
+        VSync,          // wait for vertical blank
+        Immediate,      // present right away, may tear
+        Adaptive,       // vsync, but present late frames right away
+    };
+    inline static constexpr PresentMode PresentModes[] = { PresentMode::VSync, PresentMode::Immediate, PresentMode::Adaptive };
+
     virtual ~GraphicsContext() = default;
     
     virtual void Init(GLFWwindow* window) = 0;
     virtual void SwapBuffers() = 0;
 
+    // Call on the thread the context is current on, returns the mode that is in effect
+    virtual PresentMode SetPresentMode(PresentMode mode) { return mode; }
+    [[nodiscard]] PresentMode GetPresentMode() const { return _presentMode; }
+
+    static std::string_view GetPresentModeString(PresentMode mode);
+
+    // Frames the GPU may fall behind before a swap waits for it, 0 leaves queueing to the driver
+    static constexpr unsigned MaxFramesInFlight { 3 };
+    void SetMaxFramesInFlight(unsigned frames) { _maxFramesInFlight = std::min(frames, MaxFramesInFlight); }
+    [[nodiscard]] unsigned GetMaxFramesInFlight() const { return _maxFramesInFlight; }
+
+    // Frames still queued on the GPU at the last swap, and how long it waited for them in ms
+    [[nodiscard]] unsigned GetQueueDepth() const { return _queueDepth; }
+    [[nodiscard]] float GetFenceWait() const { return _fenceWait; }
+
+    // Bind to or release from the calling thread, for APIs with thread-bound contexts
+    virtual void MakeCurrent() { }
+    virtual void ReleaseCurrent() { }
+
     static std::unique_ptr<GraphicsContext> Create();
 
+    // A context that needs no window or display server, nullptr where the API or platform has none
+    static std::unique_ptr<GraphicsContext> CreateHeadless();
+
 protected:
     GLFWwindow* _window { nullptr };
+    PresentMode _presentMode { PresentMode::VSync };
+
+    // Set from any thread, stats written by the thread that swaps
+    std::atomic<unsigned> _maxFramesInFlight { 0 };
+    std::atomic<unsigned> _queueDepth { 0 };
+    std::atomic<float> _fenceWait { 0.0f };
 };
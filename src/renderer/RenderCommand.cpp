@@ -6,9 +6,44 @@
 #include "gpch.h"
 #include "RenderCommand.h"
 
+#include "renderer/RenderStats.h"
+#include "renderer/RenderThread.h"
+
 #include <glm/glm.hpp>
 
 
+namespace
+{
+    // Recorded while the render thread is active, each runs the same call again on the render thread
+    struct ResetStateCommand
+    {
+        void Execute() const { RenderCommand::ResetState(); }
+    };
+
+    struct ClearBufferCommand
+    {
+        void Execute() const { RenderCommand::ClearBuffer(); }
+    };
+
+    struct SetClearColorCommand
+    {
+        float r, g, b, alpha;
+        void Execute() const { RenderCommand::SetClearColor(glm::vec4 { r, g, b, alpha }); }
+    };
+
+    struct SetWireframeModeCommand
+    {
+        bool bUseLineDraw;
+        void Execute() const { RenderCommand::SetWireframeMode(bUseLineDraw); }
+    };
+
+    struct SetViewportCommand
+    {
+        int width, height;
+        void Execute() const { RenderCommand::SetViewport(width, height); }
+    };
+}
+
 void RenderCommand::Init(const RendererAPI::API api)
 {
     _renderAPI = RendererAPI::Create(api);
@@ -16,30 +51,56 @@ void RenderCommand::Init(const RendererAPI::API api)
 
 void RenderCommand::ResetState()
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderThread::GetCommands().Record(ResetStateCommand { });
+        return;
+    }
     _renderAPI->ResetState();
 }
 
 void RenderCommand::SetClearColor(const glm::vec3& color)
 {
-    _renderAPI->SetClearColor(color.r, color.g, color.b);
+    SetClearColor(glm::vec4 { color, 1.0f });
 }
 
 void RenderCommand::SetClearColor(const glm::vec4& color)
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderThread::GetCommands().Record(SetClearColorCommand { color.r, color.g, color.b, color.a });
+        return;
+    }
     _renderAPI->SetClearColor(color.r, color.g, color.b, color.a);
 }
 
 void RenderCommand::ClearBuffer()
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderThread::GetCommands().Record(ClearBufferCommand { });
+        return;
+    }
     _renderAPI->ClearBuffer();
+    RenderStats::Get().clears++;
 }
 
 void RenderCommand::SetWireframeMode(bool bUseLineDraw)
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderThread::GetCommands().Record(SetWireframeModeCommand { bUseLineDraw });
+        return;
+    }
     _renderAPI->SetWireframeMode(bUseLineDraw);
 }
 
 void RenderCommand::SetViewport(int width, int height)
 {
+    if (RenderThread::ShouldRecord())
+    {
+        RenderThread::GetCommands().Record(SetViewportCommand { width, height });
+        return;
+    }
     _renderAPI->SetViewport(width, height);
 }
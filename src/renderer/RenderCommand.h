@@ -5,6 +5,7 @@
  */
 #pragma once
 #include "renderer/RendererAPI.h"
+#include "renderer/RenderThread.h"
 
 #include <glm/fwd.hpp>
 
@@ -23,7 +24,37 @@ public:
     static void SetWireframeMode(bool bUseLineDraw = true);
 
     static void SetViewport(int width, int height);
+
+    // Run command on the thread that owns the context: recorded while the render thread is active,
+    // right away otherwise. A command is a POD struct with Execute() or a lambda capturing by value
+    template <typename C>
+    static void Submit(const C& command);
     
 private:
     inline static std::unique_ptr<RendererAPI> _renderAPI { nullptr };
+
+    template <typename F>
+    struct FunctionCommand
+    {
+        F fn;
+        void Execute() const { fn(); }
+    };
 };
+
+template <typename C>
+void RenderCommand::Submit(const C& command)
+{
+    if constexpr (requires { command.Execute(); })
+    {
+        if (RenderThread::ShouldRecord())
+        {
+            RenderThread::GetCommands().Record(command);
+            return;
+        }
+        command.Execute();
+    }
+    else
+    {
+        Submit(FunctionCommand<C> { command });
+    }
+}
@@ -0,0 +1,27 @@
+﻿/**
+ * Grafik
+ * RenderStats
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+#include "RenderStats.h"
+
+
+RenderStats::Counters RenderStats::_current { };
+std::array<RenderStats::Counters, RenderStats::HistorySize> RenderStats::_history { };
+
+void RenderStats::BeginFrame()
+{
+    const std::lock_guard lock { _mutex };
+    _history[_frames % HistorySize] = _current;
+    _frames++;
+    _current = Counters { };
+}
+
+const RenderStats::Counters& RenderStats::GetFrame(unsigned framesAgo)
+{
+    static constexpr Counters empty { };
+    if (framesAgo >= GetFrameCount()) return empty;
+
+    return _history[(_frames - 1 - framesAgo) % HistorySize];
+}
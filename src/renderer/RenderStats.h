@@ -0,0 +1,51 @@
+﻿/**
+ * Grafik
+ * RenderStats
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+
+#include <mutex>
+
+
+/**
+ * Per-frame renderer counters, incremented where the work is issued on the thread that owns the
+ * context. Frames run from one BeginFrame to the next, so a frame includes the UI drawn after the labs.
+ */
+class RenderStats
+{
+public:
+    static constexpr unsigned HistorySize { 120 };
+
+    struct Counters
+    {
+        uint32_t    drawCalls           { 0 };
+        uint32_t    instances           { 0 };
+        uint64_t    indices             { 0 };
+        uint32_t    programBinds        { 0 };
+        uint32_t    vertexArrayBinds    { 0 };
+        uint32_t    textureBinds        { 0 };
+        uint32_t    uniformUploads      { 0 };
+        uint32_t    clears              { 0 };
+        uint64_t    bufferBytes         { 0 };     // vertex and index data uploaded
+        uint64_t    textureBytes        { 0 };     // texel data uploaded
+    };
+
+    // Stores the counters of the frame that ended and starts counting a new one
+    static void BeginFrame();
+
+    // Counters of the frame being recorded, context thread only
+    [[nodiscard]] static Counters& Get() { return _current; }
+
+    // Locks the history for reading from another thread
+    [[nodiscard]] static std::unique_lock<std::mutex> Lock() { return std::unique_lock { _mutex }; }
+    // Completed frame, 0 is the latest and up to GetFrameCount()-1 back
+    [[nodiscard]] static const Counters& GetFrame(unsigned framesAgo = 0);
+    [[nodiscard]] static unsigned GetFrameCount() { return std::min(_frames, HistorySize); }
+
+private:
+    static Counters _current;
+    inline static std::mutex _mutex { };
+    static std::array<Counters, HistorySize> _history;  // guarded by _mutex
+    inline static unsigned _frames { 0 };
+};
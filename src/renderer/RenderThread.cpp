@@ -0,0 +1,155 @@
+﻿/**
+ * Grafik
+ * RenderThread
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "RenderThread.h"
+
+#include "renderer/GraphicsContext.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+namespace
+{
+    std::jthread thread { };
+    thread_local bool isRenderThread { false };
+
+    GraphicsContext* context { nullptr };
+
+    CommandBuffer buffers[2] { };
+    size_t recording { 0 };
+
+    // Guarded by mutex
+    std::mutex mutex { };
+    std::condition_variable signal { };
+    CommandBuffer* submitted { nullptr };
+    FunctionRef<void()>* call { nullptr };
+    bool stopping { false };
+
+    struct PresentCommand
+    {
+        GraphicsContext* context;
+
+        void Execute() const { context->SwapBuffers(); }
+    };
+}
+
+void RenderThread::Start(GraphicsContext* graphicsContext)
+{
+    if (_active || !graphicsContext) return;
+
+    context = graphicsContext;
+    context->ReleaseCurrent();
+
+    stopping = false;
+    recording = 0;
+    buffers[0].Reset();
+    buffers[1].Reset();
+    thread = std::jthread(Loop);
+    _active = true;
+
+    Log::Debug("RenderThread: Started");
+}
+
+void RenderThread::Stop()
+{
+    if (!_active) return;
+
+    // Anything recorded after the last frame still runs
+    Execute([] { });
+    {
+        std::scoped_lock lock { mutex };
+        stopping = true;
+    }
+    signal.notify_all();
+    thread.join();
+
+    _active = false;
+    context->MakeCurrent();
+    context = nullptr;
+}
+
+bool RenderThread::IsRenderThread()
+{
+    return isRenderThread;
+}
+
+CommandBuffer& RenderThread::GetCommands()
+{
+    return buffers[recording];
+}
+
+void RenderThread::Present()
+{
+    buffers[recording].Record(PresentCommand { context });
+
+    std::unique_lock lock { mutex };
+    signal.wait(lock, [] { return submitted == nullptr; });
+
+    // The other buffer finished executing before the last frame was submitted
+    submitted = &buffers[recording];
+    recording ^= 1;
+    buffers[recording].Reset();
+
+    lock.unlock();
+    signal.notify_all();
+}
+
+void RenderThread::Execute(FunctionRef<void()> fn)
+{
+    if (!_active || isRenderThread)
+    {
+        fn();
+        return;
+    }
+
+    std::unique_lock lock { mutex };
+    signal.wait(lock, [] { return submitted == nullptr && call == nullptr; });
+
+    // Commands recorded so far come first, so the order matches the single-threaded path
+    submitted = &buffers[recording];
+    call = &fn;
+    lock.unlock();
+    signal.notify_all();
+
+    lock.lock();
+    signal.wait(lock, [] { return call == nullptr; });
+    buffers[recording].Reset();
+}
+
+void RenderThread::Loop()
+{
+    isRenderThread = true;
+    Profiler::SetThreadName("Render");
+    context->MakeCurrent();
+
+    std::unique_lock lock { mutex };
+    while (true)
+    {
+        signal.wait(lock, [] { return submitted || call || stopping; });
+        if (!submitted && !call) break;
+
+        CommandBuffer* commands = submitted;
+        FunctionRef<void()>* fn = call;
+        lock.unlock();
+
+        if (commands)
+        {
+            GK_PROFILE_SCOPE("Commands");
+            commands->Execute();
+        }
+        if (fn) (*fn)();
+
+        lock.lock();
+        submitted = nullptr;
+        call = nullptr;
+        signal.notify_all();
+    }
+
+    context->ReleaseCurrent();
+    isRenderThread = false;
+}
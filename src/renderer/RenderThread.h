@@ -0,0 +1,48 @@
+﻿/**
+ * Grafik
+ * RenderThread
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+#include "renderer/CommandBuffer.h"
+#include "core/Function.h"
+
+
+class GraphicsContext;
+
+/**
+ * Thread that owns the graphics context while active. The main thread records commands into one
+ * of two command buffers; Present hands the frame over and recording continues in the other,
+ * so the next frame's logic overlaps this frame's submission and swap. Lab draws are recorded too;
+ * work that needs the context directly (resource creation and destruction) goes through Execute.
+ */
+class RenderThread
+{
+public:
+    // Moves the context to the render thread, call from the thread that owns it
+    static void Start(GraphicsContext* context);
+    // Finishes submitted work and moves the context back to the calling thread
+    static void Stop();
+
+    [[nodiscard]] static bool IsActive() { return _active; }
+    [[nodiscard]] static bool IsRenderThread();
+
+    // Commands issued from other threads must be recorded while the render thread is active
+    [[nodiscard]] static bool ShouldRecord() { return _active && !IsRenderThread(); }
+
+    // Main thread, the buffer of the frame being recorded
+    [[nodiscard]] static CommandBuffer& GetCommands();
+
+    // Main thread. Record the swap and hand the frame to the render thread, waits only if
+    // the previous frame is still executing
+    static void Present();
+
+    // Wait for submitted frames, run what was recorded so far and then fn on the render thread,
+    // and return when done. Runs fn right away when inactive or already on the render thread
+    static void Execute(FunctionRef<void()> fn);
+
+private:
+    static void Loop();
+
+    inline static bool _active { false };
+};
@@ -9,6 +9,7 @@
 #include "core/Application.h"
 #include "components/Window.h"
 #include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
 #include "renderer/Shader.h"
 
 #include "VertexArray.h"
@@ -18,6 +19,25 @@
 #include <glm/glm.hpp>
 
 
+namespace
+{
+    struct DrawElementsCommand
+    {
+        int count;
+        const void* offset;
+
+        void Execute() const
+        {
+            glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset);
+
+            RenderStats::Counters& stats = RenderStats::Get();
+            stats.drawCalls++;
+            stats.instances++;
+            stats.indices += static_cast<uint64_t>(count);
+        }
+    };
+}
+
 Renderer::Renderer(GLFWwindow* window)
 {
     _context = window;
@@ -25,6 +45,8 @@ Renderer::Renderer(GLFWwindow* window)
 
 void Renderer::Render(const VertexArray& vao, const std::shared_ptr<Shader>& shader, const int elementStart, int elementEnd)
 {
+    GK_PROFILE_FUNCTION();
+
     if (shader->Bind())
     {
         vao.Bind();
@@ -35,7 +57,7 @@ void Renderer::Render(const VertexArray& vao, const std::shared_ptr<Shader>& sha
         }
         const int count = elementEnd+1 - elementStart;
         const void* offset = reinterpret_cast<const void*>(static_cast<intptr_t>(sizeof(unsigned)*elementStart)); // NOLINT(performance-no-int-to-ptr)
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, offset);
+        RenderCommand::Submit(DrawElementsCommand { count, offset });
     }
 }
 
@@ -64,6 +86,7 @@ void Renderer::EndScene()
 void Renderer::Clear() const
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    RenderStats::Get().clears++;
 }
 
 void Renderer::SetClearColor(const glm::vec3& color)
@@ -88,13 +111,13 @@ void Renderer::SetViewport(int width, int height)
 
 bool Renderer::GetFramebufferSize(int& width, int& height)
 {
-    GLFWwindow* _window = Application::Get().GetWindow()->GetNativeWindow();
+    const Window* window = Application::Get().GetWindow();
     
-    if (!_window)
+    if (!window || (!window->GetNativeWindow() && !window->IsHeadless()))
     {
         return false;
     }
-    glfwGetFramebufferSize(_window, &width, &height);
+    window->GetFramebufferSize(width, height);
     return true;
 }
 
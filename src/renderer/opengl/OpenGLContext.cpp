@@ -30,23 +30,24 @@ void OpenGLContext::Init(GLFWwindow* window)
     _window = window;
     
     glfwMakeContextCurrent(_window);
+    InitGL(reinterpret_cast<void* (*)(const char*)>(glfwGetProcAddress));
 
+    // swap buffers in sync with screen freq aka v-sync
+    SetPresentMode(PresentMode::VSync);
+}
+
+void OpenGLContext::InitGL(void* (*getProcAddress)(const char*))
+{
     // Initialize GLAD
-    if (!gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress)))
+    if (!gladLoadGLLoader(getProcAddress))
     {
-        glfwTerminate();
-        {
-            throw std::runtime_error("GLAD initialization failed!");
-        }
+        throw std::runtime_error("GLAD initialization failed!");
     }
 
 #   ifdef GK_DEBUG
     InitDebug();
 #   endif
 
-    // swap buffers in sync with screen freq aka v-sync
-    glfwSwapInterval(1);
-
     // Set OpenGL state
     SetState();
 }
@@ -66,10 +67,86 @@ void OpenGLContext::SetState()
 void OpenGLContext::SwapBuffers()
 {
     glfwSwapBuffers(_window);
+    LimitFramesInFlight(_maxFramesInFlight);
+}
+
+void OpenGLContext::LimitFramesInFlight(const unsigned maxFrames)
+{
+    auto popFence = [this]
+    {
+        glDeleteSync(_fences[_fenceFirst]);
+        _fenceFirst = (_fenceFirst + 1) % FenceRing;
+        _fenceCount--;
+    };
+
+    // Frames complete in order, drop the ones the GPU is done with
+    while (_fenceCount > 0 && glClientWaitSync(_fences[_fenceFirst], 0, 0) != GL_TIMEOUT_EXPIRED)
+    {
+        popFence();
+    }
+    if (_fenceCount == FenceRing)
+    {
+        popFence();
+    }
+    _fences[(_fenceFirst + _fenceCount) % FenceRing] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    _fenceCount++;
+    _queueDepth = _fenceCount;
+
+    // Wait here rather than in the driver's queue, so the next frame samples input once the GPU is near
+    if (maxFrames == 0)
+    {
+        _fenceWait = 0.0f;
+        return;
+    }
+
+    GK_PROFILE_SCOPE("Wait GPU");
+    const int64_t start = Profiler::Now();
+    while (_fenceCount >= maxFrames)
+    {
+        constexpr GLuint64 timeout { 1'000'000'000 };   // ns
+        GLenum result;
+        do
+        {
+            result = glClientWaitSync(_fences[_fenceFirst], GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        }
+        while (result == GL_TIMEOUT_EXPIRED);
+        popFence();
+    }
+    _fenceWait = static_cast<float>(static_cast<double>(Profiler::Now() - start) / 1e6);
+}
+
+GraphicsContext::PresentMode OpenGLContext::SetPresentMode(PresentMode mode)
+{
+    // Adaptive is a negative interval, only allowed with the tear control extension
+    if (mode == PresentMode::Adaptive
+        && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+    {
+        Log::Warn("OpenGLContext: Adaptive vsync is not supported, using vsync");
+        mode = PresentMode::VSync;
+    }
+
+    switch (mode)
+    {
+        case PresentMode::VSync:        glfwSwapInterval(1); break;
+        case PresentMode::Immediate:    glfwSwapInterval(0); break;
+        case PresentMode::Adaptive:     glfwSwapInterval(-1); break;
+    }
+    _presentMode = mode;
+    return mode;
+}
+
+void OpenGLContext::MakeCurrent()
+{
+    glfwMakeContextCurrent(_window);
+}
+
+void OpenGLContext::ReleaseCurrent()
+{
+    glfwMakeContextCurrent(nullptr);
 }
 
 #ifdef GK_DEBUG
-void OpenGLContext::InitDebug() const
+void OpenGLContext::InitDebug()
 {
     Log::Info("{:*^50}", " OpenGL ");
     // Print adapter info
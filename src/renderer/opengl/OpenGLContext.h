@@ -8,6 +8,7 @@
 
 
 struct GLFWwindow;
+typedef struct __GLsync* GLsync;
 
 class OpenGLContext : public GraphicsContext
 {
@@ -16,10 +17,33 @@ public:
 
     void Init(GLFWwindow* window) override;
     void SwapBuffers() override;
+    PresentMode SetPresentMode(PresentMode mode) override;
 
-    void SetState();
+    void MakeCurrent() override;
+    void ReleaseCurrent() override;
 
-#ifdef _DEBUG
-    void InitDebug() const;
+    static void SetState();
+
+#ifdef GK_DEBUG
+    static void InitDebug();
 #endif
+
+protected:
+    // For contexts not created through GLFW, skips the window hints
+    struct NoWindowHints { };
+    explicit OpenGLContext(NoWindowHints) { }
+
+    // With the context current: load the entry points, set up debug output and the initial state
+    static void InitGL(void* (*getProcAddress)(const char*));
+
+    // Fence the swapped frame and wait for the GPU to catch up to maxFrames, 0 only measures the queue
+    void LimitFramesInFlight(unsigned maxFrames);
+
+private:
+
+    // Unfinished frames oldest first, beyond the limit they are only kept to measure the queue
+    static constexpr unsigned FenceRing { 8 };
+    std::array<GLsync, FenceRing> _fences { };
+    unsigned _fenceFirst { 0 };
+    unsigned _fenceCount { 0 };
 };
@@ -0,0 +1,124 @@
+﻿/**
+ * Grafik
+ * OpenGLHeadlessContext
+ * Copyright 2023 Martin Furuberg
+ */
+#include "gpch.h"
+
+#ifdef GK_LINUX
+#include "OpenGLHeadlessContext.h"
+
+#include <glad/glad.h>
+
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+
+namespace
+{
+    void* GetProcAddress(const char* name)
+    {
+        return reinterpret_cast<void*>(eglGetProcAddress(name));
+    }
+
+    // Surfaceless needs no display server, the default display is the fallback for older drivers
+    EGLDisplay GetDisplay()
+    {
+        const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+        {
+            const EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) return display;
+        }
+        return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+}
+
+OpenGLHeadlessContext::~OpenGLHeadlessContext()
+{
+    if (_display == EGL_NO_DISPLAY) return;
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(_display, _context);
+    }
+    eglTerminate(_display);
+}
+
+void OpenGLHeadlessContext::Init(GLFWwindow*)
+{
+    const EGLDisplay display = GetDisplay();
+    EGLint major { 0 }, minor { 0 };
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        throw std::runtime_error("EGL initialization failed!");
+    }
+    _display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        throw std::runtime_error("EGL has no desktop OpenGL!");
+    }
+
+    // Surfaceless still needs a config, the default asks for window surfaces which it has none of
+    const EGLint configAttributes[] { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config { nullptr };
+    EGLint configCount { 0 };
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        throw std::runtime_error("EGL has no OpenGL config!");
+    }
+
+    const EGLint contextAttributes[]
+    {
+        EGL_CONTEXT_MAJOR_VERSION, static_cast<EGLint>(Grafik::OpenGLAPIMajor),
+        EGL_CONTEXT_MINOR_VERSION, static_cast<EGLint>(Grafik::OpenGLAPIMinor),
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#   ifdef GK_DEBUG
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#   endif
+        EGL_NONE
+    };
+    _context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (_context == EGL_NO_CONTEXT)
+    {
+        throw std::runtime_error("EGL context creation failed, is OpenGL "
+            + std::to_string(Grafik::OpenGLAPIMajor) + "." + std::to_string(Grafik::OpenGLAPIMinor) + " supported?");
+    }
+    MakeCurrent();
+
+    Log::Info("OpenGLHeadlessContext: EGL {}.{} by {}", major, minor, eglQueryString(display, EGL_VENDOR));
+    InitGL(GetProcAddress);
+    _presentMode = PresentMode::Immediate;
+}
+
+void OpenGLHeadlessContext::SwapBuffers()
+{
+    // A swap would throttle on the display, here the driver's queue is the only limit
+    glFlush();
+    const unsigned maxFrames = _maxFramesInFlight;
+    LimitFramesInFlight(maxFrames > 0 ? maxFrames : MaxFramesInFlight);
+}
+
+GraphicsContext::PresentMode OpenGLHeadlessContext::SetPresentMode(PresentMode)
+{
+    // No display to wait for
+    return _presentMode;
+}
+
+void OpenGLHeadlessContext::MakeCurrent()
+{
+    if (!eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, _context))
+    {
+        throw std::runtime_error("EGL context could not be made current, surfaceless contexts may be unsupported");
+    }
+}
+
+void OpenGLHeadlessContext::ReleaseCurrent()
+{
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+}
+
+#endif
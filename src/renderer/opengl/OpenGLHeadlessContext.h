@@ -0,0 +1,37 @@
+﻿/**
+ * Grafik
+ * OpenGLHeadlessContext
+ * Copyright 2023 Martin Furuberg
+ */
+#pragma once
+#include "renderer/opengl/OpenGLContext.h"
+
+
+/**
+ * OpenGL without a window or display server, through EGL's surfaceless platform. Mesa falls back to
+ * llvmpipe on machines without a GPU, so benchmarks run unattended on build servers. There is no
+ * default framebuffer, render into a Framebuffer. Linux only, see GraphicsContext::CreateHeadless.
+ */
+class OpenGLHeadlessContext : public OpenGLContext
+{
+public:
+    OpenGLHeadlessContext() : OpenGLContext { NoWindowHints { } } { }
+    ~OpenGLHeadlessContext() override;
+
+    OpenGLHeadlessContext(const OpenGLHeadlessContext&) = delete;
+    OpenGLHeadlessContext& operator=(const OpenGLHeadlessContext&) = delete;
+
+    // Window is unused, pass nullptr
+    void Init(GLFWwindow* window) override;
+
+    // Nothing presents, flushes and keeps the GPU queue bounded
+    void SwapBuffers() override;
+    PresentMode SetPresentMode(PresentMode mode) override;
+
+    void MakeCurrent() override;
+    void ReleaseCurrent() override;
+
+private:
+    void* _display { nullptr };     // EGLDisplay
+    void* _context { nullptr };     // EGLContext
+};
@@ -5,6 +5,9 @@
  */
 #include "gpch.h"
 #include "OpenGLShader.h"
+#include "renderer/GpuMemory.h"
+#include "renderer/RenderCommand.h"
+#include "renderer/RenderStats.h"
 #include "utils/File.h"
 
 #include <glm/glm.hpp>
@@ -13,11 +16,56 @@
 #include <filesystem>
 
 
+namespace
+{
+    // Recorded while the render thread is active, the location is looked up when recording
+    struct BindProgramCommand
+    {
+        const OpenGLShader* shader;
+        void Execute() const { shader->Bind(); }
+    };
+
+    // Points at the caller's values or at a copy in the command buffer
+    struct IntArray
+    {
+        const int* values;
+        int count;
+    };
+
+    void Upload(int location, int value) { glUniform1i(location, value); }
+    void Upload(int location, const IntArray& value) { glUniform1iv(location, value.count, value.values); }
+    void Upload(int location, float value) { glUniform1f(location, value); }
+    void Upload(int location, const glm::vec3& value) { glUniform3fv(location, 1, &value.x); }
+    void Upload(int location, const glm::vec4& value) { glUniform4fv(location, 1, &value.x); }
+    void Upload(int location, const glm::mat4& value) { glUniformMatrix4fv(location, 1, GL_FALSE, &value[0].x); }
+
+    template <typename T>
+    struct UniformCommand
+    {
+        int location;
+        T value;
+
+        void Execute() const
+        {
+            Upload(location, value);
+            RenderStats::Get().uniformUploads++;
+        }
+    };
+
+    template <typename T>
+    void SetUniform(int location, const T& value)
+    {
+        RenderCommand::Submit(UniformCommand<T> { location, value });
+    }
+}
+
 OpenGLShader::OpenGLShader(const std::string& name, const std::string& vertexFile, const std::string& fragmentFile)
     : _shaderName { name }
     , _vertexFilePath { vertexFile }
     , _fragmentFilePath { fragmentFile }
 {
+    GK_PROFILE_FUNCTION();
+
     // Read vertex shader from file
     File vsFile(vertexFile.c_str());
     const auto vertexSource = vsFile.Read();
@@ -28,12 +76,19 @@ OpenGLShader::OpenGLShader(const std::string& name, const std::string& vertexFil
 
     if (!vertexSource || !fragmentSource)
     {
-        std::cout << "Error: Failed loading source for shader '" << _shaderName << "'." << std::endl;
+        Log::Error("OpenGLShader: Failed loading source for shader '{}'", _shaderName);
         return;
     }
 
     // Compile into program
     _id = CreateShaderProgram(*vertexSource, *fragmentSource);
+    CacheUniformLocations();
+
+    // Size of the linked binary, the closest measure of what the program holds
+    int binaryLength { 0 };
+    glGetProgramiv(_id, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+    _programBytes = static_cast<size_t>(std::max(binaryLength, 0));
+    GpuMemory::Allocate(GpuMemory::Resource::Shader, _programBytes);
 }
 
 unsigned OpenGLShader::CreateShaderProgram(const std::string& vertexShader, const std::string& fragmentShader)
@@ -55,7 +110,7 @@ unsigned OpenGLShader::CreateShaderProgram(const std::string& vertexShader, cons
     }
     else
     {
-        std::cout << "Warning: Failed to compile shader '" << _shaderName << "'." << std::endl;
+        Log::Warn("OpenGLShader: Failed to compile shader '{}'", _shaderName);
     }
 
     glDeleteShader(vs);
@@ -80,8 +135,7 @@ unsigned OpenGLShader::CompileShaderSource(unsigned type, const std::string& sou
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
         char* message = static_cast<char*>(alloca(length * sizeof(char)));
         glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Error: Compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader in '" << _shaderName << "' failed:\n";
-        std::cout << "\t" << message << "\n";
+        Log::Error("OpenGLShader: Compile {} shader in '{}' failed:\n\t{}", type == GL_VERTEX_SHADER ? "vertex" : "fragment", _shaderName, message);
 
         glDeleteShader(id);
         return 0;
@@ -89,11 +143,46 @@ unsigned OpenGLShader::CompileShaderSource(unsigned type, const std::string& sou
     return id;
 }
 
+void OpenGLShader::CacheUniformLocations()
+{
+    // Every active uniform up front, so setting one later needs neither the driver nor the context
+    int count { 0 };
+    int maxLength { 0 };
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(static_cast<size_t>(std::max(maxLength, 1)), '\0');
+    for (int i = 0; i < count; i++)
+    {
+        int length { 0 };
+        int size { 0 };
+        GLenum type { 0 };
+        glGetActiveUniform(_id, static_cast<GLuint>(i), maxLength, &length, &size, &type, name.data());
+
+        std::string uniform = name.substr(0, static_cast<size_t>(length));
+        const int location = glGetUniformLocation(_id, uniform.c_str());
+        if (location < 0) continue;
+
+        // Arrays are listed by their first element and set by their plain name
+        if (uniform.ends_with("[0]"))
+        {
+            uniform.resize(uniform.size() - 3);
+        }
+        _uniformLocations[uniform] = location;
+    }
+}
+
 bool OpenGLShader::Bind() const
 {
     if (IsOK())
     {
+        if (RenderThread::ShouldRecord())
+        {
+            RenderCommand::Submit(BindProgramCommand { this });
+            return true;
+        }
         glUseProgram(_id);
+        RenderStats::Get().programBinds++;
         return true;
     }
     return false;
@@ -106,57 +195,67 @@ void OpenGLShader::Unbind()
 
 void OpenGLShader::SetUniform1i(const std::string& name, int value) const
 {
-    glUniform1i(GetUniformLocation(name), value);
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void OpenGLShader::SetUniform1iv(const std::string& name, const std::vector<int>& values) const
 {
-    glUniform1iv(GetUniformLocation(name), static_cast<int>(values.size()), values.data());
+    IntArray array { values.data(), static_cast<int>(values.size()) };
+    if (RenderThread::ShouldRecord())
+    {
+        // The vector is gone by the time the command runs
+        const size_t bytes = values.size() * sizeof(int);
+        void* copy = RenderThread::GetCommands().Allocate(bytes);
+        std::memcpy(copy, values.data(), bytes);
+        array.values = static_cast<const int*>(copy);
+    }
+    SetUniform(GetUniformLocation(name), array);
 }
 
 void OpenGLShader::SetUniform1f(const std::string& name, float value) const
 {
-    glUniform1f(GetUniformLocation(name), value);
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void OpenGLShader::SetUniform4f(const std::string& name, float f0, float f1, float f2, float f3) const
 {
-    glUniform4f(GetUniformLocation(name), f0, f1, f2, f3);
+    SetUniform(GetUniformLocation(name), glm::vec4 { f0, f1, f2, f3 });
 }
 
 void OpenGLShader::SetUniformVec3f(const std::string& name, const glm::vec3& value) const
 {
-    glUniform3fv(GetUniformLocation(name), 1, &value.x);
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void OpenGLShader::SetUniformVec4f(const std::string& name, const glm::vec4& value) const
 {
-    glUniform4fv(GetUniformLocation(name), 1, &value.x);
+    SetUniform(GetUniformLocation(name), value);
 }
 
 void OpenGLShader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix) const
 {
-    glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0].x);
+    SetUniform(GetUniformLocation(name), matrix);
 }
 
 int OpenGLShader::GetUniformLocation(const std::string& name) const
 {
-    if (_uniformLocations.contains(name))
-    {
-        return _uniformLocations[name];
-    }
-    
-    const int location = glGetUniformLocation(_id, name.c_str());
-    if (location < 0)
+    if (const auto it = _uniformLocations.find(name); it != _uniformLocations.end())
     {
-        std::cout << "Warning: Uniform '" << name << "' not found in shader '" << _shaderName << "'.\n";
+        return it->second;
     }
-    _uniformLocations[name] = location;
+
+    // Not active in the linked program, warn once
+    Log::Warn("OpenGLShader: Uniform '{}' not found in shader '{}'", name, _shaderName);
+    _uniformLocations[name] = -1;
     
-    return location;
+    return -1;
 }
 
 OpenGLShader::~OpenGLShader()
 {
+    if (_id)
+    {
+        GpuMemory::Free(GpuMemory::Resource::Shader, _programBytes);
+    }
     glDeleteProgram(_id);
 }
@@ -13,10 +13,11 @@ class OpenGLShader : public Shader
 {
     unsigned _id { 0 };
     bool _compiled { false };
+    size_t _programBytes { 0 };
     std::string _shaderName { };
     std::string _vertexFilePath { };
     std::string _fragmentFilePath { };
-    mutable std::unordered_map<std::string, int> _uniformLocations;
+    mutable std::unordered_map<std::string, int> _uniformLocations;   // filled at link, misses added as -1
     
 public:
     OpenGLShader(const std::string& name, const std::string& vertexFile, const std::string& fragmentFile);
@@ -42,4 +43,5 @@ public:
 private:
     unsigned CreateShaderProgram(const std::string& vertexShader, const std::string& fragmentShader);
     unsigned CompileShaderSource(unsigned type, const std::string& source) const;
+    void CacheUniformLocations();
 };
@@ -33,6 +33,6 @@ void VulkanContext::SwapBuffers()
 void VulkanContext::InitDebug() const
 {
     // Print adapter info
-    std::cout << "Vulkan" << "\n";
+    Log::Info("Vulkan");
 }
 #endif
@@ -0,0 +1,243 @@
+﻿/**
+ * Grafik
+ * FontCache
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "FontCache.h"
+
+#include "utils/File.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+
+namespace
+{
+    // Bump when the layout below changes
+    constexpr uint32_t CacheVersion { 1 };
+    constexpr char CacheMagic[4] { 'G', 'K', 'F', 'A' };
+
+    struct CacheHeader
+    {
+        char        magic[4];
+        uint32_t    version;
+        uint64_t    key;
+        int32_t     width;
+        int32_t     height;
+        ImVec2      uvScale;
+        ImVec2      uvWhitePixel;
+        uint32_t    uvLineCount;
+        uint32_t    glyphCount;
+        float       fontSize;
+        float       ascent;
+        float       descent;
+        int32_t     metricsTotalSurface;
+    };
+
+    // FNV-1a, only has to tell cache entries apart
+    uint64_t Hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull)
+    {
+        const auto* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    uint64_t HashValue(const T& value, uint64_t hash)
+    {
+        return Hash(&value, sizeof(T), hash);
+    }
+
+    size_t GetRangeCount(const ImWchar* ranges)
+    {
+        size_t count { 0 };
+        while (ranges[count]) count++;
+        return count;
+    }
+
+    // Anything that changes the baked output goes into the key
+    uint64_t GetKey(std::span<const unsigned char> fontData, float sizePixels, const ImWchar* ranges, const ImFontAtlas* atlas)
+    {
+        uint64_t key = Hash(fontData.data(), fontData.size());
+        key = HashValue(sizePixels, key);
+        key = Hash(ranges, GetRangeCount(ranges) * sizeof(ImWchar), key);
+        key = HashValue(atlas->Flags, key);
+        key = HashValue(atlas->TexGlyphPadding, key);
+        key = HashValue(atlas->TexDesiredWidth, key);
+        key = HashValue(IMGUI_VERSION_NUM, key);
+        key = HashValue(sizeof(ImFontGlyph), key);
+        return HashValue(CacheVersion, key);
+    }
+
+    std::string GetMemoryKey(const std::string& fontPath, float sizePixels, const ImWchar* ranges)
+    {
+        std::string key = fontPath + '|' + std::to_string(sizePixels) + '|';
+        key.append(reinterpret_cast<const char*>(ranges), GetRangeCount(ranges) * sizeof(ImWchar));
+        return key;
+    }
+}
+
+ImFont* FontCache::AddFont(ImFontAtlas* atlas, const std::string& fontPath, float sizePixels, const ImWchar* glyphRanges)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto elapsed = [start] { return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count(); };
+    const ImWchar* ranges = glyphRanges ? glyphRanges : atlas->GetGlyphRangesDefault();
+
+    // Restoring replaces the whole atlas, other fonts would be lost
+    const bool bCacheable = atlas->Fonts.empty();
+
+    // Same process, e.g. after a renderer API switch: no disk access at all
+    const std::string memoryKey = GetMemoryKey(fontPath, sizePixels, ranges);
+    if (const auto baked = _baked.find(memoryKey); bCacheable && baked != _baked.end())
+    {
+        CacheHeader header;
+        std::memcpy(&header, baked->second.data(), sizeof(header));
+        if (ImFont* font = Restore(atlas, baked->second, header.key))
+        {
+            Log::Debug("FontCache: Restored {} from memory in {}us", fontPath, elapsed());
+            return font;
+        }
+    }
+
+    const std::optional<FileBuffer> fontFile = File(fontPath).Load();
+    if (!fontFile) return nullptr;
+
+    const uint64_t key = GetKey(fontFile->GetBytes(), sizePixels, ranges, atlas);
+    char fileName[24];
+    std::snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(key));
+    const std::string cachePath = _directory + '/' + fileName;
+
+    if (bCacheable && std::filesystem::exists(cachePath))
+    {
+        if (const std::optional<FileBuffer> cache = File(cachePath).Load(File::Mode::Map))
+        {
+            if (ImFont* font = Restore(atlas, { cache->GetData(), cache->GetSize() }, key))
+            {
+                _baked[memoryKey].assign(cache->GetData(), cache->GetData() + cache->GetSize());
+                Log::Debug("FontCache: Restored {} from {} in {}us", fontPath, cachePath, elapsed());
+                return font;
+            }
+            Log::Warn("FontCache: Ignoring stale cache {}", cachePath);
+        }
+    }
+
+    // Bake from the already loaded font data, the atlas takes ownership of its copy
+    void* fontData = IM_ALLOC(fontFile->GetSize());
+    std::memcpy(fontData, fontFile->GetData(), fontFile->GetSize());
+
+    ImFontConfig config;
+    std::snprintf(config.Name, sizeof(config.Name), "%s, %.0fpx", std::filesystem::path(fontPath).filename().string().c_str(), sizePixels);
+    ImFont* font = atlas->AddFontFromMemoryTTF(fontData, static_cast<int>(fontFile->GetSize()), sizePixels, &config, ranges);
+    if (!font || !bCacheable) return font;
+
+    std::vector<char> blob = Serialize(atlas, font, key);
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+    {
+        // Write beside and rename, a half written file is never picked up
+        const std::string tempPath = cachePath + ".tmp";
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+        out.close();
+        if (out)
+        {
+            std::filesystem::rename(tempPath, cachePath, error);
+        }
+        if (!out || error)
+        {
+            Log::Warn("FontCache: Unable to write {}", cachePath);
+            std::filesystem::remove(tempPath, error);
+        }
+    }
+
+    _baked[memoryKey] = std::move(blob);
+    Log::Debug("FontCache: Baked {} in {}us", fontPath, elapsed());
+    return font;
+}
+
+ImFont* FontCache::Restore(ImFontAtlas* atlas, std::span<const char> blob, unsigned long long key)
+{
+    CacheHeader header;
+    if (blob.size() < sizeof(header)) return nullptr;
+    std::memcpy(&header, blob.data(), sizeof(header));
+
+    const size_t uvLinesBytes = header.uvLineCount * sizeof(ImVec4);
+    const size_t glyphBytes = header.glyphCount * sizeof(ImFontGlyph);
+    const size_t pixelBytes = static_cast<size_t>(header.width) * static_cast<size_t>(header.height) * 4;
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 || header.version != CacheVersion || header.key != key
+        || header.uvLineCount != static_cast<uint32_t>(IM_ARRAYSIZE(atlas->TexUvLines)) || header.glyphCount == 0
+        || blob.size() != sizeof(header) + uvLinesBytes + glyphBytes + pixelBytes)
+    {
+        return nullptr;
+    }
+    const char* data = blob.data() + sizeof(header);
+
+    // Glyph table; lookup tables, fallback and ellipsis glyphs are derived from it
+    ImFont* font = IM_NEW(ImFont)();
+    font->FontSize = header.fontSize;
+    font->Ascent = header.ascent;
+    font->Descent = header.descent;
+    font->MetricsTotalSurface = header.metricsTotalSurface;
+    font->ContainerAtlas = atlas;
+    font->Glyphs.resize(static_cast<int>(header.glyphCount));
+    std::memcpy(font->Glyphs.Data, data + uvLinesBytes, glyphBytes);
+    font->BuildLookupTable();
+
+    // Texture data, the atlas frees it with IM_FREE
+    atlas->TexWidth = header.width;
+    atlas->TexHeight = header.height;
+    atlas->TexUvScale = header.uvScale;
+    atlas->TexUvWhitePixel = header.uvWhitePixel;
+    std::memcpy(atlas->TexUvLines, data, uvLinesBytes);
+    atlas->TexPixelsRGBA32 = static_cast<unsigned int*>(IM_ALLOC(pixelBytes));
+    std::memcpy(atlas->TexPixelsRGBA32, data + uvLinesBytes + glyphBytes, pixelBytes);
+    atlas->TexPixelsUseColors = false;
+
+    // Cursor shapes are not baked into the cache, ImGui draws them in software only
+    atlas->Flags |= ImFontAtlasFlags_NoMouseCursors;
+    atlas->Fonts.push_back(font);
+    atlas->TexReady = true;
+    return font;
+}
+
+std::vector<char> FontCache::Serialize(ImFontAtlas* atlas, const ImFont* font, unsigned long long key)
+{
+    // Builds the atlas if it isn't already
+    unsigned char* pixels;
+    int width, height;
+    atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    CacheHeader header { };
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.key = key;
+    header.width = width;
+    header.height = height;
+    header.uvScale = atlas->TexUvScale;
+    header.uvWhitePixel = atlas->TexUvWhitePixel;
+    header.uvLineCount = static_cast<uint32_t>(IM_ARRAYSIZE(atlas->TexUvLines));
+    header.glyphCount = static_cast<uint32_t>(font->Glyphs.Size);
+    header.fontSize = font->FontSize;
+    header.ascent = font->Ascent;
+    header.descent = font->Descent;
+    header.metricsTotalSurface = font->MetricsTotalSurface;
+
+    const size_t uvLinesBytes = header.uvLineCount * sizeof(ImVec4);
+    const size_t glyphBytes = header.glyphCount * sizeof(ImFontGlyph);
+    const size_t pixelBytes = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+
+    std::vector<char> blob(sizeof(header) + uvLinesBytes + glyphBytes + pixelBytes);
+    char* out = blob.data();
+    std::memcpy(out, &header, sizeof(header));
+    std::memcpy(out += sizeof(header), atlas->TexUvLines, uvLinesBytes);
+    std::memcpy(out += uvLinesBytes, font->Glyphs.Data, glyphBytes);
+    std::memcpy(out + glyphBytes, pixels, pixelBytes);
+    return blob;
+}
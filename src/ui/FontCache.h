@@ -0,0 +1,35 @@
+﻿/**
+ * Grafik
+ * FontCache
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+#include <imgui/imgui.h>
+
+#include <span>
+
+
+/**
+ * Baked ImGui font atlases (pixels, glyph table, metrics) kept on disk, keyed by font contents,
+ * size and glyph ranges, and in memory for the lifetime of the process. Restoring skips
+ * rasterization entirely; only the texture upload remains per graphics context.
+ */
+class FontCache
+{
+public:
+    // Add a font to an empty atlas, restoring it from cache when possible and baking it otherwise
+    static ImFont* AddFont(ImFontAtlas* atlas, const std::string& fontPath, float sizePixels, const ImWchar* glyphRanges = nullptr);
+
+    static void SetDirectory(std::string directory) { _directory = std::move(directory); }
+    static const std::string& GetDirectory() { return _directory; }
+
+    // Drop the in-memory copies, cache files stay
+    static void Clear() { _baked.clear(); }
+
+private:
+    inline static std::string _directory { "cache/fonts" };
+    inline static std::unordered_map<std::string, std::vector<char>> _baked { };
+
+    static ImFont* Restore(ImFontAtlas* atlas, std::span<const char> blob, unsigned long long key);
+    static std::vector<char> Serialize(ImFontAtlas* atlas, const ImFont* font, unsigned long long key);
+};
@@ -15,8 +15,12 @@ public:
     
     virtual void Init(GLFWwindow* window) = 0;
 
+    // Start and finish the ImGui frame, on the main thread
     virtual void Begin() = 0;
     virtual void End() = 0;
 
+    // Submit the finished frame, on the thread that owns the graphics context
+    virtual void Draw() = 0;
+
     static std::unique_ptr<UI> Create();
 };
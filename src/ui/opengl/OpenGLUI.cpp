@@ -23,12 +23,7 @@ void OpenGLUI::Init(GLFWwindow* window)
 
 void OpenGLUI::Begin()
 {
-    // Begin ImGUI frame, reset
-    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glDepthMask(GL_TRUE);
-    
-    ImGui_ImplOpenGL3_NewFrame();
-    
+    // Begin ImGUI frame
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     //ImGui::ShowDemoWindow();
@@ -37,6 +32,14 @@ void OpenGLUI::Begin()
 void OpenGLUI::End()
 {
     ImGui::Render();
+}
+
+void OpenGLUI::Draw()
+{
+    // Reset state, the OpenGL backend creates its objects on first use
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glDepthMask(GL_TRUE);
+    ImGui_ImplOpenGL3_NewFrame();
 
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }
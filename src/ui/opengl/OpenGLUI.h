@@ -16,4 +16,5 @@ public:
 
     void Begin() override;
     void End() override;
+    void Draw() override;
 };
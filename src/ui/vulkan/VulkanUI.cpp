@@ -22,6 +22,11 @@ void VulkanUI::End()
 
 }
 
+void VulkanUI::Draw()
+{
+
+}
+
 VulkanUI::~VulkanUI()
 {
 
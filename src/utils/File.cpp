@@ -1,82 +1,289 @@
 ﻿/**
  * Grafik
  * File
- * Copyright 2012-2022 Martin Furuberg 
+ * Copyright 2012-2022 Martin Furuberg
  */
 #include "gpch.h"
 #include "File.h"
 
-#include <format>
-#include <mutex>
-#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
 
+#ifndef GK_WIN
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
 
-std::optional<std::string> File::Read()
-{
-    static std::mutex mutex;
-    std::lock_guard lock(mutex);
-    fin.open(filePath, std::ios::in);
 
-    try
+namespace
+{
+    // Thin RAII wrapper over the native file handle
+    class NativeFile
     {
-        if (!fin.is_open())
+#   ifdef GK_WIN
+        HANDLE _handle { INVALID_HANDLE_VALUE };
+#   else
+        int _fd { -1 };
+#   endif
+        size_t _size { 0 };
+
+    public:
+        explicit NativeFile(const std::string& path)
+        {
+#       ifdef GK_WIN
+            _handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (_handle == INVALID_HANDLE_VALUE) return;
+
+            LARGE_INTEGER size { };
+            if (!GetFileSizeEx(_handle, &size))
+            {
+                CloseHandle(_handle);
+                _handle = INVALID_HANDLE_VALUE;
+                return;
+            }
+            _size = static_cast<size_t>(size.QuadPart);
+#       else
+            _fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (_fd < 0) return;
+
+            struct stat info { };
+            if (fstat(_fd, &info) != 0)
+            {
+                close(_fd);
+                _fd = -1;
+                return;
+            }
+            _size = static_cast<size_t>(info.st_size);
+#       endif
+        }
+
+        ~NativeFile()
+        {
+#       ifdef GK_WIN
+            if (_handle != INVALID_HANDLE_VALUE) CloseHandle(_handle);
+#       else
+            if (_fd >= 0) close(_fd);
+#       endif
+        }
+
+        NativeFile(const NativeFile&) = delete;
+        NativeFile& operator=(const NativeFile&) = delete;
+
+        [[nodiscard]] bool IsOpen() const
+        {
+#       ifdef GK_WIN
+            return _handle != INVALID_HANDLE_VALUE;
+#       else
+            return _fd >= 0;
+#       endif
+        }
+
+        [[nodiscard]] size_t GetSize() const { return _size; }
+
+        // Read the whole file into dst, which must hold GetSize() bytes
+        bool ReadAll(char* dst) const
+        {
+            size_t done { 0 };
+            while (done < _size)
+            {
+#           ifdef GK_WIN
+                // ReadFile takes a 32-bit count, larger files need several calls
+                const DWORD chunk = static_cast<DWORD>(std::min<size_t>(_size - done, 0x80000000ull));
+                OVERLAPPED at { };
+                at.Offset = static_cast<DWORD>(done & 0xFFFFFFFFull);
+                at.OffsetHigh = static_cast<DWORD>(done >> 32);
+                DWORD read { 0 };
+                if (!ReadFile(_handle, dst + done, chunk, &read, &at) || read == 0) return false;
+#           else
+                const ssize_t read = pread(_fd, dst + done, _size - done, static_cast<off_t>(done));
+                if (read <= 0) return false;
+#           endif
+                done += static_cast<size_t>(read);
+            }
+            return true;
+        }
+
+        // Map the whole file read-only, the view outlives this handle
+        [[nodiscard]] const char* Map() const
+        {
+#       ifdef GK_WIN
+            const HANDLE mapping = CreateFileMappingA(_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return nullptr;
+            const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            return static_cast<const char*>(view);
+#       else
+            void* view = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+            if (view == MAP_FAILED) return nullptr;
+            madvise(view, _size, MADV_SEQUENTIAL);
+            return static_cast<const char*>(view);
+#       endif
+        }
+
+        static void Unmap(const char* data, [[maybe_unused]] size_t size)
         {
-            throw std::runtime_error(std::format("File: Unable to open file {}", filePath));
+#       ifdef GK_WIN
+            UnmapViewOfFile(data);
+#       else
+            munmap(const_cast<char*>(data), size);
+#       endif
         }
+    };
+}
+
+FileBuffer::FileBuffer(FileBuffer&& other) noexcept
+    : _owned { std::move(other._owned) }
+    , _data { std::exchange(other._data, nullptr) }
+    , _size { std::exchange(other._size, 0) }
+    , _mapped { std::exchange(other._mapped, false) } { }
+
+FileBuffer& FileBuffer::operator=(FileBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        _owned = std::move(other._owned);
+        _data = std::exchange(other._data, nullptr);
+        _size = std::exchange(other._size, 0);
+        _mapped = std::exchange(other._mapped, false);
     }
-    catch (std::runtime_error &e)
+    return *this;
+}
+
+void FileBuffer::Release()
+{
+    if (_mapped && _data)
     {
-        std::cout << e.what() << std::endl;
-        fin.close();
-        return {};
+        NativeFile::Unmap(_data, _size);
     }
+    _owned.reset();
+    _data = nullptr;
+    _size = 0;
+    _mapped = false;
+}
 
-    std::stringstream buffer;
-    buffer << fin.rdbuf();
-    std::string contents = buffer.str();
-    fin.close();
+FileBuffer::~FileBuffer()
+{
+    Release();
+}
 
-    if (contents.empty())
+std::optional<FileBuffer> File::Load(Mode mode) const
+{
+    const NativeFile file { filePath };
+    if (!file.IsOpen())
     {
-        std::cout << "Warning: File " << filePath << " is empty!" << std::endl;
+        Log::Error("File: Unable to open file {}", filePath);
         return {};
     }
 
-    return contents;
-}
+    const size_t fileSize = file.GetSize();
+    if (!fileSize)
+    {
+        Log::Warn("File: {} is empty!", filePath);
+        return {};
+    }
 
-std::optional<std::vector<char>> File::ReadBytes()
-{
-    static std::mutex mutex;
-    std::lock_guard lock(mutex);
-    fin.open(filePath, std::ios::ate | std::ios::binary);
+    FileBuffer buffer;
+    buffer._size = fileSize;
 
-    try
+    if (mode == Mode::Map || (mode == Mode::Auto && fileSize >= MapThreshold))
     {
-        if (!fin.is_open())
+        if ((buffer._data = file.Map()))
         {
-            throw std::runtime_error(std::format("File: Unable to open file {}", filePath));
+            buffer._mapped = true;
+            return buffer;
         }
+        // Fall back to a plain read if mapping is unavailable
+    }
+
+    buffer._owned = std::make_unique_for_overwrite<char[]>(fileSize);
+    buffer._data = buffer._owned.get();
+    if (!file.ReadAll(buffer._owned.get()))
+    {
+        Log::Error("File: Failed reading {}", filePath);
+        return {};
     }
-    catch (std::runtime_error &e)
+    return buffer;
+}
+
+std::optional<std::string> File::Read() const
+{
+    const NativeFile file { filePath };
+    if (!file.IsOpen())
     {
-        std::cout << e.what() << std::endl;
-        fin.close();
+        Log::Error("File: Unable to open file {}", filePath);
         return {};
     }
 
-    size_t fileSize = fin.tellg();
-    std::vector<char> buffer(fileSize);
+    if (!file.GetSize())
+    {
+        Log::Warn("File: {} is empty!", filePath);
+        return {};
+    }
 
-    fin.seekg(0);
-    fin.read(buffer.data(), fileSize);
-    fin.close();
+    // Read straight into the string storage
+    std::string contents(file.GetSize(), '\0');
+    if (!file.ReadAll(contents.data()))
+    {
+        Log::Error("File: Failed reading {}", filePath);
+        return {};
+    }
+    return contents;
+}
 
-    if (!fileSize)
+std::optional<std::vector<char>> File::ReadBytes() const
+{
+    const NativeFile file { filePath };
+    if (!file.IsOpen())
     {
-        std::cout << "Warning: File " << filePath << " is empty!" << std::endl;
+        Log::Error("File: Unable to open file {}", filePath);
         return {};
     }
 
+    if (!file.GetSize())
+    {
+        Log::Warn("File: {} is empty!", filePath);
+        return {};
+    }
+
+    std::vector<char> buffer(file.GetSize());
+    if (!file.ReadAll(buffer.data()))
+    {
+        Log::Error("File: Failed reading {}", filePath);
+        return {};
+    }
     return buffer;
-}
\ No newline at end of file
+}
+
+std::vector<std::optional<FileBuffer>> File::ReadMany(std::span<const std::string> filePaths, Mode mode)
+{
+    std::vector<std::optional<FileBuffer>> results(filePaths.size());
+    if (filePaths.empty()) return results;
+
+    // Workers pull the next path from a shared index, each result slot is written by exactly one worker
+    std::atomic<size_t> next { 0 };
+    auto worker = [&]
+    {
+        for (size_t i = next++; i < filePaths.size(); i = next++)
+        {
+            results[i] = File(filePaths[i]).Load(mode);
+        }
+    };
+
+    const size_t workerCount = std::min<size_t>(filePaths.size(), std::max(1u, std::thread::hardware_concurrency()));
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(workerCount - 1);
+        for (size_t i = 1; i < workerCount; i++)
+        {
+            workers.emplace_back(worker);
+        }
+        worker();
+    }
+    return results;
+}
@@ -1,26 +1,77 @@
 ﻿/**
  * Grafik
  * File
- * Copyright 2012-2022 Martin Furuberg 
+ * Copyright 2012-2022 Martin Furuberg
  */
 #pragma once
 
-#include <fstream>
+#include <span>
+#include <string_view>
 
 
+/**
+ * Contents of a file, either owned (heap) or a read-only mapped view.
+ * Move-only; releases the memory or unmaps the view on destruction.
+ */
+class FileBuffer
+{
+    std::unique_ptr<char[]> _owned { };
+    const char* _data { nullptr };
+    size_t _size { 0 };
+    bool _mapped { false };
+
+public:
+    FileBuffer() = default;
+    ~FileBuffer();
+
+    FileBuffer(FileBuffer&& other) noexcept;
+    FileBuffer& operator=(FileBuffer&& other) noexcept;
+    FileBuffer(const FileBuffer&) = delete;
+    FileBuffer& operator=(const FileBuffer&) = delete;
+
+    [[nodiscard]] const char* GetData() const { return _data; }
+    [[nodiscard]] size_t GetSize() const { return _size; }
+    [[nodiscard]] bool IsMapped() const { return _mapped; }
+    [[nodiscard]] bool IsEmpty() const { return _size == 0; }
+
+    [[nodiscard]] std::string_view GetView() const { return { _data, _size }; }
+    [[nodiscard]] std::span<const unsigned char> GetBytes() const { return { reinterpret_cast<const unsigned char*>(_data), _size }; }
+
+private:
+    void Release();
+
+    friend class File;
+};
+
 class File
 {
 public:
+    enum class Mode
+    {
+        Auto,   // map files at or above MapThreshold, read the rest
+        Read,   // always read into an owned buffer
+        Map     // always map
+    };
+
+    static constexpr size_t MapThreshold { 1024 * 1024 };
+
     File(const char* inFilePath) : filePath { inFilePath } {}
+    File(std::string inFilePath) : filePath { std::move(inFilePath) } {}
     File(const File&) = delete;
     File& operator=(const File&) = delete;
     ~File() = default;
-    
+
 private:
-    std::ifstream fin;
     std::string filePath;
-    
-public:    
-    std::optional<std::string> Read();
-    std::optional<std::vector<char>> ReadBytes();
+
+public:
+    [[nodiscard]] std::optional<FileBuffer> Load(Mode mode = Mode::Auto) const;
+
+    std::optional<std::string> Read() const;
+    std::optional<std::vector<char>> ReadBytes() const;
+
+    [[nodiscard]] const std::string& GetPath() const { return filePath; }
+
+    // Load several files concurrently, results are in the same order as the paths
+    static std::vector<std::optional<FileBuffer>> ReadMany(std::span<const std::string> filePaths, Mode mode = Mode::Auto);
 };
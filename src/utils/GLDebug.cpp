@@ -8,55 +8,76 @@
 
 #include <glad/glad.h>
 
+#ifndef GK_WIN
+    #include <csignal>
+#endif
+
 
 #ifdef GK_DEBUG
-void APIENTRY HandleGLDebugMessage(unsigned int source, unsigned int type, unsigned int id, unsigned int severity, int length, const char* message, const void* userParam)
+namespace
 {
-    (void)userParam;
-    
-    // Ignore non-significant error/warning codes
-    if (length == 0 || id == 131169 || id == 131185 || id == 131218 || id == 131204) return; 
-
-    std::cout << "---------------\n";
-    std::cout << "GL debug message (" << id << "): " <<  message << "\n";
-
-    switch (source)
+    const char* GetSourceString(unsigned int source)
     {
-        case GL_DEBUG_SOURCE_API:             std::cout << "Source: API"; break;
-        case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   std::cout << "Source: Window System"; break;
-        case GL_DEBUG_SOURCE_SHADER_COMPILER: std::cout << "Source: Shader Compiler"; break;
-        case GL_DEBUG_SOURCE_THIRD_PARTY:     std::cout << "Source: Third Party"; break;
-        case GL_DEBUG_SOURCE_APPLICATION:     std::cout << "Source: Application"; break;
-        case GL_DEBUG_SOURCE_OTHER:           std::cout << "Source: Other"; break;
-        default:                              std::cout << "Source: Unknown"; break;
+        switch (source)
+        {
+            case GL_DEBUG_SOURCE_API:             return "API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM:   return "Window System";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "Shader Compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY:     return "Third Party";
+            case GL_DEBUG_SOURCE_APPLICATION:     return "Application";
+            case GL_DEBUG_SOURCE_OTHER:           return "Other";
+            default:                              return "Unknown";
+        }
     }
-    std::cout << " / ";
 
-    switch (type)
+    const char* GetTypeString(unsigned int type)
     {
-        case GL_DEBUG_TYPE_ERROR:               std::cout << "Type: Error"; break;
-        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: std::cout << "Type: Deprecated Behaviour"; break;
-        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  std::cout << "Type: Undefined Behaviour"; break; 
-        case GL_DEBUG_TYPE_PORTABILITY:         std::cout << "Type: Portability"; break;
-        case GL_DEBUG_TYPE_PERFORMANCE:         std::cout << "Type: Performance"; break;
-        case GL_DEBUG_TYPE_MARKER:              std::cout << "Type: Marker"; break;
-        case GL_DEBUG_TYPE_PUSH_GROUP:          std::cout << "Type: Push Group"; break;
-        case GL_DEBUG_TYPE_POP_GROUP:           std::cout << "Type: Pop Group"; break;
-        case GL_DEBUG_TYPE_OTHER:               std::cout << "Type: Other"; break;
-        default:                                std::cout << "Type: Unknown"; break;
+        switch (type)
+        {
+            case GL_DEBUG_TYPE_ERROR:               return "Error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated Behaviour";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined Behaviour";
+            case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+            case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+            case GL_DEBUG_TYPE_MARKER:              return "Marker";
+            case GL_DEBUG_TYPE_PUSH_GROUP:          return "Push Group";
+            case GL_DEBUG_TYPE_POP_GROUP:           return "Pop Group";
+            case GL_DEBUG_TYPE_OTHER:               return "Other";
+            default:                                return "Unknown";
+        }
     }
-    std::cout << " / ";
+}
+
+void APIENTRY HandleGLDebugMessage(unsigned int source, unsigned int type, unsigned int id, unsigned int severity, int length, const char* message, const void* userParam)
+{
+    (void)userParam;
     
+    // Ignore non-significant error/warning codes
+    if (length == 0 || id == 131169 || id == 131185 || id == 131218 || id == 131204) return; 
+
+    // Called on the context thread mid-frame, the message is formatted and written by the logger thread
     switch (severity)
     {
-        case GL_DEBUG_SEVERITY_HIGH:         std::cout << "Severity: high"; break;
-        case GL_DEBUG_SEVERITY_MEDIUM:       std::cout << "Severity: medium"; break;
-        case GL_DEBUG_SEVERITY_LOW:          std::cout << "Severity: low"; break;
-        case GL_DEBUG_SEVERITY_NOTIFICATION: std::cout << "Severity: notification"; break;
-        default:                             std::cout << "Severity: unknown"; break;
+        case GL_DEBUG_SEVERITY_HIGH:
+            Log::Error("GL debug message ({}): {}\nSource: {} / Type: {} / Severity: high", id, message, GetSourceString(source), GetTypeString(type));
+            break;
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            Log::Warn("GL debug message ({}): {}\nSource: {} / Type: {} / Severity: medium", id, message, GetSourceString(source), GetTypeString(type));
+            break;
+        case GL_DEBUG_SEVERITY_LOW:
+            Log::Info("GL debug message ({}): {}\nSource: {} / Type: {} / Severity: low", id, message, GetSourceString(source), GetTypeString(type));
+            break;
+        default:
+            Log::Debug("GL debug message ({}): {}\nSource: {} / Type: {} / Severity: notification", id, message, GetSourceString(source), GetTypeString(type));
+            break;
     }
-    std::cout << std::endl;
 
+    // Show the message before breaking
+    Log::Flush();
+#   ifdef GK_WIN
     __debugbreak();
+#   else
+    std::raise(SIGTRAP);
+#   endif
 }
 #endif
@@ -4,6 +4,7 @@
  * Copyright 2012-2022 Martin Furuberg 
  */
 #pragma once
+#include <glad/glad.h>
 
 
 void APIENTRY HandleGLDebugMessage(unsigned int source, unsigned int type, unsigned int id, unsigned int severity, int length, const char* message, const void* userParam);
@@ -0,0 +1,624 @@
+﻿/**
+ * Grafik
+ * Image
+ * Copyright 2023 Martin Furuberg 
+ */
+#include "gpch.h"
+#include "Image.h"
+#include "File.h"
+#include "core/JobSystem.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_FAILURE_USERMSG
+#ifdef __GNUC__
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+#include <stb/stb_image.h>
+#ifdef __GNUC__
+    #pragma GCC diagnostic pop
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define GK_IMAGE_X64
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+        #define GK_TARGET(isa)
+    #else
+        #include <cpuid.h>
+        #define GK_TARGET(isa) __attribute__((target(isa)))
+    #endif
+#endif
+
+
+namespace
+{
+    // Rows are split into jobs of at least this many pixels, smaller ones cost more to hand out than they save
+    constexpr size_t MinJobPixels { 16 * 1024 };
+
+    constexpr float KaiserRadius { 1.5f };  // in destination texels
+    constexpr float KaiserAlpha { 4.0f };
+
+    constexpr int EncodeTableSize { 1 << 14 };
+
+    // Run fn(begin, end) over row ranges as jobs, a small image stays in one
+    template <typename Fn>
+    void ParallelRows(int rows, int width, Fn&& fn)
+    {
+        const size_t count = static_cast<size_t>(rows);
+        const size_t minRows = (MinJobPixels + static_cast<size_t>(width) - 1) / std::max<size_t>(1, static_cast<size_t>(width));
+        const size_t grain = std::max(JobSystem::GetAutoGrain(count), minRows);
+        JobSystem::ParallelFor(count, [&fn](size_t begin, size_t end)
+        {
+            fn(static_cast<int>(begin), static_cast<int>(end));
+        }, grain);
+    }
+
+    // sRGB transfer tables, decoding is exact per byte and encoding is indexed by quantized linear value
+    struct ColorTables
+    {
+        std::array<float, 256> toLinear { };
+        std::vector<unsigned char> toSrgb = std::vector<unsigned char>(EncodeTableSize + 1);
+
+        ColorTables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                const float c = static_cast<float>(i) / 255.0f;
+                toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            for (int i = 0; i <= EncodeTableSize; i++)
+            {
+                const float l = static_cast<float>(i) / EncodeTableSize;
+                const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+                toSrgb[i] = static_cast<unsigned char>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    };
+
+    const ColorTables& GetColorTables()
+    {
+        static const ColorTables tables;
+        return tables;
+    }
+
+    unsigned char Premultiply(unsigned char color, unsigned char alpha)
+    {
+        return static_cast<unsigned char>((color * alpha + 127) / 255);
+    }
+
+    // Source taps per destination texel along one axis, indices are clamped to the edge
+    struct Contributions
+    {
+        int taps { 0 };
+        std::vector<int> indices { };
+        std::vector<float> weights { };
+    };
+
+    float BesselI0(float x)
+    {
+        float sum { 1.0f }, term { 1.0f };
+        const float half = x * 0.5f;
+        for (int k = 1; k < 16; k++)
+        {
+            term *= (half / static_cast<float>(k)) * (half / static_cast<float>(k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    float KaiserWeight(float distance, float scale, float radius)
+    {
+        if (std::abs(distance) >= radius) return 0.0f;
+
+        const float x = distance / scale * std::numbers::pi_v<float>;
+        const float sinc = std::abs(x) < 1e-5f ? 1.0f : std::sin(x) / x;
+        const float t = distance / radius;
+        return sinc * BesselI0(KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(KaiserAlpha);
+    }
+
+    Contributions BuildContributions(int srcSize, int dstSize, MipFilter filter)
+    {
+        const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+        const float radius = filter == MipFilter::Box ? scale * 0.5f : scale * KaiserRadius;
+
+        Contributions result;
+        result.taps = static_cast<int>(std::ceil(radius * 2.0f)) + 1;
+        result.indices.resize(static_cast<size_t>(dstSize) * result.taps);
+        result.weights.resize(static_cast<size_t>(dstSize) * result.taps);
+
+        for (int d = 0; d < dstSize; d++)
+        {
+            const float center = (static_cast<float>(d) + 0.5f) * scale;
+            const int first = static_cast<int>(std::floor(center - radius));
+            int* indices = result.indices.data() + static_cast<size_t>(d) * result.taps;
+            float* weights = result.weights.data() + static_cast<size_t>(d) * result.taps;
+
+            float sum { 0.0f };
+            for (int k = 0; k < result.taps; k++)
+            {
+                const int s = first + k;
+                const float w = filter == MipFilter::Box
+                    ? std::max(0.0f, std::min(s + 1.0f, center + radius) - std::max(static_cast<float>(s), center - radius))
+                    : KaiserWeight(static_cast<float>(s) + 0.5f - center, scale, radius);
+                indices[k] = std::clamp(s, 0, srcSize - 1);
+                weights[k] = w;
+                sum += w;
+            }
+            for (int k = 0; k < result.taps; k++)
+            {
+                weights[k] /= sum;
+            }
+        }
+        return result;
+    }
+
+    /*
+     * Kernels. Pixels are RGBA, filtering works on float4 texels in linear premultiplied space.
+     */
+
+    void ExpandRowScalar(const unsigned char* src, unsigned char* dst, int width, int channels)
+    {
+        for (int x = 0; x < width; x++, src += channels, dst += 4)
+        {
+            switch (channels)
+            {
+            case 1: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = 255; break;
+            case 2: dst[0] = dst[1] = dst[2] = src[0]; dst[3] = src[1]; break;
+            case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break;
+            default: std::memcpy(dst, src, 4); break;
+            }
+        }
+    }
+
+    void SwizzleRowScalar(unsigned char* row, int width, const std::array<unsigned char, 4>& swizzle)
+    {
+        for (int x = 0; x < width; x++, row += 4)
+        {
+            const unsigned char pixel[4] { row[0], row[1], row[2], row[3] };
+            for (int c = 0; c < 4; c++)
+            {
+                row[c] = pixel[swizzle[c]];
+            }
+        }
+    }
+
+    void ResampleRowScalar(const float* src, float* dst, int dstWidth, const Contributions& h)
+    {
+        for (int x = 0; x < dstWidth; x++, dst += 4)
+        {
+            const int* indices = h.indices.data() + static_cast<size_t>(x) * h.taps;
+            const float* weights = h.weights.data() + static_cast<size_t>(x) * h.taps;
+            float acc[4] { };
+            for (int k = 0; k < h.taps; k++)
+            {
+                const float* texel = src + static_cast<size_t>(indices[k]) * 4;
+                for (int c = 0; c < 4; c++)
+                {
+                    acc[c] += weights[k] * texel[c];
+                }
+            }
+            std::memcpy(dst, acc, sizeof(acc));
+        }
+    }
+
+    void BlendRowsScalar(const float* const* rows, const float* weights, int taps, float* dst, int floats)
+    {
+        for (int i = 0; i < floats; i++)
+        {
+            float acc { 0.0f };
+            for (int k = 0; k < taps; k++)
+            {
+                acc += weights[k] * rows[k][i];
+            }
+            dst[i] = acc;
+        }
+    }
+
+#ifdef GK_IMAGE_X64
+    GK_TARGET("ssse3")
+    void ExpandRgbRowSSSE3(const unsigned char* src, unsigned char* dst, int width)
+    {
+        const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+        // Each 16 byte load covers four pixels plus a partial one, stop while a full load still fits
+        int x { 0 };
+        for (; x + 6 <= width; x += 4)
+        {
+            const __m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+        }
+        ExpandRowScalar(src + x * 3, dst + x * 4, width - x, 3);
+    }
+
+    GK_TARGET("avx2")
+    void ExpandRgbRowAVX2(const unsigned char* src, unsigned char* dst, int width)
+    {
+        const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                                 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+
+        // Two four pixel groups per iteration, one per 128-bit lane
+        int x { 0 };
+        for (; x + 10 <= width; x += 8)
+        {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 3 + 12));
+            const __m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha));
+        }
+        ExpandRgbRowSSSE3(src + x * 3, dst + x * 4, width - x);
+    }
+
+    GK_TARGET("ssse3")
+    void SwizzleRowSSSE3(unsigned char* row, int width, const std::array<unsigned char, 4>& swizzle)
+    {
+        alignas(16) char mask[16];
+        for (int i = 0; i < 16; i++)
+        {
+            mask[i] = static_cast<char>((i & ~3) + swizzle[i & 3]);
+        }
+        const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+
+        int x { 0 };
+        for (; x + 4 <= width; x += 4)
+        {
+            __m128i* p = reinterpret_cast<__m128i*>(row + x * 4);
+            _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), shuffle));
+        }
+        SwizzleRowScalar(row + x * 4, width - x, swizzle);
+    }
+
+    GK_TARGET("avx2")
+    void SwizzleRowAVX2(unsigned char* row, int width, const std::array<unsigned char, 4>& swizzle)
+    {
+        alignas(32) char mask[32];
+        for (int i = 0; i < 32; i++)
+        {
+            mask[i] = static_cast<char>((i & 15 & ~3) + swizzle[i & 3]);
+        }
+        const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+
+        int x { 0 };
+        for (; x + 8 <= width; x += 8)
+        {
+            __m256i* p = reinterpret_cast<__m256i*>(row + x * 4);
+            _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), shuffle));
+        }
+        SwizzleRowSSSE3(row + x * 4, width - x, swizzle);
+    }
+
+    // SSE2 is part of x64, a float4 texel fits one register
+    void ResampleRowSSE(const float* src, float* dst, int dstWidth, const Contributions& h)
+    {
+        for (int x = 0; x < dstWidth; x++, dst += 4)
+        {
+            const int* indices = h.indices.data() + static_cast<size_t>(x) * h.taps;
+            const float* weights = h.weights.data() + static_cast<size_t>(x) * h.taps;
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < h.taps; k++)
+            {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(src + static_cast<size_t>(indices[k]) * 4)));
+            }
+            _mm_storeu_ps(dst, acc);
+        }
+    }
+
+    void BlendRowsSSE(const float* const* rows, const float* weights, int taps, float* dst, int floats)
+    {
+        for (int i = 0; i < floats; i += 4)
+        {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < taps; k++)
+            {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+            }
+            _mm_storeu_ps(dst + i, acc);
+        }
+    }
+
+    // Vertical taps share one weight across the whole row, so the wider registers pay off here
+    GK_TARGET("avx2")
+    void BlendRowsAVX2(const float* const* rows, const float* weights, int taps, float* dst, int floats)
+    {
+        int i { 0 };
+        for (; i + 8 <= floats; i += 8)
+        {
+            __m256 acc = _mm256_setzero_ps();
+            for (int k = 0; k < taps; k++)
+            {
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(weights[k]), _mm256_loadu_ps(rows[k] + i)));
+            }
+            _mm256_storeu_ps(dst + i, acc);
+        }
+        for (; i < floats; i += 4)
+        {
+            __m128 acc = _mm_setzero_ps();
+            for (int k = 0; k < taps; k++)
+            {
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[k]), _mm_loadu_ps(rows[k] + i)));
+            }
+            _mm_storeu_ps(dst + i, acc);
+        }
+    }
+
+    GK_TARGET("xsave")
+    unsigned long long ReadXcr0()
+    {
+        return _xgetbv(0);
+    }
+#endif
+
+    struct Kernels
+    {
+        void (*expandRgb)(const unsigned char*, unsigned char*, int) { };
+        void (*swizzle)(unsigned char*, int, const std::array<unsigned char, 4>&) { SwizzleRowScalar };
+        void (*resample)(const float*, float*, int, const Contributions&) { ResampleRowScalar };
+        void (*blend)(const float* const*, const float*, int, float*, int) { BlendRowsScalar };
+    };
+
+    Kernels SelectKernels(Image::SimdLevel level)
+    {
+        Kernels kernels;
+        kernels.expandRgb = [](const unsigned char* src, unsigned char* dst, int width) { ExpandRowScalar(src, dst, width, 3); };
+#   ifdef GK_IMAGE_X64
+        kernels.resample = ResampleRowSSE;
+        kernels.blend = BlendRowsSSE;
+        if (level >= Image::SimdLevel::SSSE3)
+        {
+            kernels.expandRgb = ExpandRgbRowSSSE3;
+            kernels.swizzle = SwizzleRowSSSE3;
+        }
+        if (level >= Image::SimdLevel::AVX2)
+        {
+            kernels.expandRgb = ExpandRgbRowAVX2;
+            kernels.swizzle = SwizzleRowAVX2;
+            kernels.blend = BlendRowsAVX2;
+        }
+#   else
+        (void)level;
+#   endif
+        return kernels;
+    }
+
+    const Kernels& GetKernels()
+    {
+        static const Kernels kernels = SelectKernels(Image::GetSimdLevel());
+        return kernels;
+    }
+
+    // Base level to linear premultiplied float texels
+    std::vector<float> Decode(const std::vector<unsigned char>& pixels, int width, int height, bool srgb)
+    {
+        const ColorTables& tables = GetColorTables();
+        std::vector<float> texels(static_cast<size_t>(width) * height * 4);
+        ParallelRows(height, width, [&](int begin, int end)
+        {
+            for (size_t i = static_cast<size_t>(begin) * width; i < static_cast<size_t>(end) * width; i++)
+            {
+                const unsigned char* p = pixels.data() + i * 4;
+                float* t = texels.data() + i * 4;
+                const float alpha = static_cast<float>(p[3]) / 255.0f;
+                for (int c = 0; c < 3; c++)
+                {
+                    t[c] = (srgb ? tables.toLinear[p[c]] : static_cast<float>(p[c]) / 255.0f) * alpha;
+                }
+                t[3] = alpha;
+            }
+        });
+        return texels;
+    }
+
+    std::vector<unsigned char> Encode(const std::vector<float>& texels, int width, int height, bool srgb, bool premultiply)
+    {
+        const ColorTables& tables = GetColorTables();
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * height * 4);
+        ParallelRows(height, width, [&](int begin, int end)
+        {
+            for (size_t i = static_cast<size_t>(begin) * width; i < static_cast<size_t>(end) * width; i++)
+            {
+                const float* t = texels.data() + i * 4;
+                unsigned char* p = pixels.data() + i * 4;
+
+                // Kaiser lobes can overshoot, clamp before leaving premultiplied space
+                const float alpha = std::clamp(t[3], 0.0f, 1.0f);
+                const auto alpha8 = static_cast<unsigned char>(alpha * 255.0f + 0.5f);
+                for (int c = 0; c < 3; c++)
+                {
+                    const float value = alpha > 0.0f ? std::clamp(t[c] / alpha, 0.0f, 1.0f) : 0.0f;
+                    const unsigned char color = srgb
+                        ? tables.toSrgb[static_cast<size_t>(value * EncodeTableSize + 0.5f)]
+                        : static_cast<unsigned char>(value * 255.0f + 0.5f);
+                    p[c] = premultiply ? Premultiply(color, alpha8) : color;
+                }
+                p[3] = alpha8;
+            }
+        });
+        return pixels;
+    }
+
+    std::vector<float> Downsample(const std::vector<float>& src, int srcWidth, int srcHeight, int dstWidth, int dstHeight, MipFilter filter)
+    {
+        const Kernels& kernels = GetKernels();
+        const Contributions h = BuildContributions(srcWidth, dstWidth, filter);
+        const Contributions v = BuildContributions(srcHeight, dstHeight, filter);
+
+        // Horizontal pass over every source row, then blend rows vertically
+        std::vector<float> rows(static_cast<size_t>(dstWidth) * srcHeight * 4);
+        ParallelRows(srcHeight, dstWidth * h.taps, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; y++)
+            {
+                kernels.resample(src.data() + static_cast<size_t>(y) * srcWidth * 4, rows.data() + static_cast<size_t>(y) * dstWidth * 4, dstWidth, h);
+            }
+        });
+
+        std::vector<float> dst(static_cast<size_t>(dstWidth) * dstHeight * 4);
+        ParallelRows(dstHeight, dstWidth * v.taps, [&](int begin, int end)
+        {
+            std::vector<const float*> taps(v.taps);
+            for (int y = begin; y < end; y++)
+            {
+                for (int k = 0; k < v.taps; k++)
+                {
+                    taps[k] = rows.data() + static_cast<size_t>(v.indices[static_cast<size_t>(y) * v.taps + k]) * dstWidth * 4;
+                }
+                kernels.blend(taps.data(), v.weights.data() + static_cast<size_t>(y) * v.taps, v.taps,
+                    dst.data() + static_cast<size_t>(y) * dstWidth * 4, dstWidth * 4);
+            }
+        });
+        return dst;
+    }
+}
+
+size_t Image::GetBytes() const
+{
+    size_t bytes { 0 };
+    for (const auto& level : _mips)
+    {
+        bytes += level.size();
+    }
+    return bytes;
+}
+
+std::vector<std::vector<unsigned char>> Image::ReleaseLevels()
+{
+    _width = _height = 0;
+    return std::exchange(_mips, { });
+}
+
+std::optional<Image> Image::Load(const std::string& filePath, const ImageOptions& options)
+{
+    const std::optional<FileBuffer> buffer = File(filePath).Load();
+    if (!buffer) return {};
+
+    // Decode in native channel count, expansion and flipping happen in the pipeline
+    int width, height, channels;
+    const std::span<const unsigned char> bytes = buffer->GetBytes();
+    unsigned char* pixels = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &channels, 0);
+    if (!pixels)
+    {
+        Log::Error("Image: Failure loading '{}'; {}", filePath, stbi_failure_reason());
+        return {};
+    }
+
+    Image image = FromPixels(pixels, width, height, channels, options);
+    stbi_image_free(pixels);
+    return image;
+}
+
+Image Image::FromPixels(const unsigned char* pixels, int width, int height, int channels, const ImageOptions& options)
+{
+    Image image;
+    if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) return image;
+
+    const Kernels& kernels = GetKernels();
+    const int maxLevels = std::bit_width(static_cast<unsigned>(std::max(width, height)));
+    const int levels = options.mipLevels > 0 ? std::min(options.mipLevels, maxLevels) : maxLevels;
+
+    image._width = width;
+    image._height = height;
+    image._mips.resize(levels);
+
+    // Expand to RGBA, flipping is just reading the rows in reverse
+    std::vector<unsigned char>& base = image._mips[0];
+    base.resize(static_cast<size_t>(width) * height * 4);
+    const bool swizzle = options.swizzle != std::array<unsigned char, 4> { 0, 1, 2, 3 };
+    ParallelRows(height, width, [&](int begin, int end)
+    {
+        for (int y = begin; y < end; y++)
+        {
+            const int srcY = options.flipVertically ? height - 1 - y : y;
+            const unsigned char* src = pixels + static_cast<size_t>(srcY) * width * channels;
+            unsigned char* dst = base.data() + static_cast<size_t>(y) * width * 4;
+            if (channels == 3)
+            {
+                kernels.expandRgb(src, dst, width);
+            }
+            else
+            {
+                ExpandRowScalar(src, dst, width, channels);
+            }
+
+            if (swizzle)
+            {
+                kernels.swizzle(dst, width, options.swizzle);
+            }
+        }
+    });
+
+    // Mips are filtered from the straight alpha base, each level from the one above
+    if (levels > 1)
+    {
+        std::vector<float> texels = Decode(base, width, height, options.srgb);
+        int levelWidth = width, levelHeight = height;
+        for (int level = 1; level < levels; level++)
+        {
+            const int dstWidth = std::max(1, levelWidth >> 1), dstHeight = std::max(1, levelHeight >> 1);
+            texels = Downsample(texels, levelWidth, levelHeight, dstWidth, dstHeight, options.mipFilter);
+            image._mips[level] = Encode(texels, dstWidth, dstHeight, options.srgb, options.premultiplyAlpha);
+            levelWidth = dstWidth;
+            levelHeight = dstHeight;
+        }
+    }
+
+    // The base level never went through float, premultiply the bytes directly to keep it exact
+    if (options.premultiplyAlpha)
+    {
+        ParallelRows(height, width, [&](int begin, int end)
+        {
+            for (size_t i = static_cast<size_t>(begin) * width; i < static_cast<size_t>(end) * width; i++)
+            {
+                unsigned char* p = base.data() + i * 4;
+                p[0] = Premultiply(p[0], p[3]);
+                p[1] = Premultiply(p[1], p[3]);
+                p[2] = Premultiply(p[2], p[3]);
+            }
+        });
+    }
+
+    return image;
+}
+
+Image::SimdLevel Image::GetSimdLevel()
+{
+    static const SimdLevel level = []
+    {
+#   ifdef GK_IMAGE_X64
+        unsigned regs[4] { };
+    #   ifdef _MSC_VER
+        const auto cpuid = [&](unsigned leaf) { __cpuidex(reinterpret_cast<int*>(regs), static_cast<int>(leaf), 0); };
+    #   else
+        const auto cpuid = [&](unsigned leaf) { __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]); };
+    #   endif
+        cpuid(0);
+        const unsigned maxLeaf = regs[0];
+
+        cpuid(1);
+        const bool ssse3 = regs[2] & (1u << 9);
+        const bool osxsave = regs[2] & (1u << 27);
+        const bool avx = regs[2] & (1u << 28);
+
+        // AVX2 also needs the OS to save the upper halves of the YMM registers
+        bool avx2 { false };
+        if (maxLeaf >= 7 && osxsave && avx && (ReadXcr0() & 0x6) == 0x6)
+        {
+            cpuid(7);
+            avx2 = regs[1] & (1u << 5);
+        }
+
+        if (avx2) return SimdLevel::AVX2;
+        if (ssse3) return SimdLevel::SSSE3;
+#   endif
+        return SimdLevel::None;
+    }();
+    return level;
+}
@@ -0,0 +1,57 @@
+﻿/**
+ * Grafik
+ * Image
+ * Copyright 2023 Martin Furuberg 
+ */
+#pragma once
+
+#include <array>
+
+
+enum class MipFilter
+{
+    Box,        // exact area average
+    Kaiser      // windowed sinc, sharper minification
+};
+
+struct ImageOptions
+{
+    bool        flipVertically      { true };   // GL expects the first row at the bottom
+    bool        premultiplyAlpha    { false };
+    bool        srgb                { true };   // filter color in linear space
+    MipFilter   mipFilter           { MipFilter::Box };
+    int         mipLevels           { 0 };      // 0 builds the full chain, 1 only the base level
+    std::array<unsigned char, 4> swizzle { 0, 1, 2, 3 };
+};
+
+/**
+ * Decoded RGBA8 image with its mip chain, ready for a single upload.
+ * All per-pixel work (flip, expansion, swizzle, premultiply, mip filtering)
+ * runs as jobs on the JobSystem using SSE/AVX2 kernels picked at runtime.
+ */
+class Image
+{
+public:
+    enum class SimdLevel { None, SSSE3, AVX2 };
+
+    Image() = default;
+
+    [[nodiscard]] int GetWidth() const { return _width; }
+    [[nodiscard]] int GetHeight() const { return _height; }
+    [[nodiscard]] int GetLevels() const { return static_cast<int>(_mips.size()); }
+    [[nodiscard]] const std::vector<unsigned char>& GetLevel(int level) const { return _mips[level]; }
+    [[nodiscard]] size_t GetBytes() const;
+
+    // Hand over the mip chain, leaving the image empty
+    std::vector<std::vector<unsigned char>> ReleaseLevels();
+
+    static std::optional<Image> Load(const std::string& filePath, const ImageOptions& options = { });
+    static Image FromPixels(const unsigned char* pixels, int width, int height, int channels, const ImageOptions& options = { });
+
+    static SimdLevel GetSimdLevel();
+
+private:
+    int _width { 0 };
+    int _height { 0 };
+    std::vector<std::vector<unsigned char>> _mips { };
+};
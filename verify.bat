@@ -0,0 +1,39 @@
+@echo off
+REM Renders each lab headless on Mesa's llvmpipe and compares it to data\golden
+REM Record new references with: verify.bat -updategolden
+REM
+REM Frame times only hold on the runner that recorded them, so they stay out of the repo. Set
+REM TIME_BASELINE to a folder with the bench-results CSVs of an earlier good run on this runner
+REM to check them as well.
+REM
+REM GALLIUM_DRIVER only picks the driver once Mesa's opengl32.dll is loaded. Windows loads
+REM opengl32.dll from the exe's folder before System32, so the exe and Mesa's DLLs are copied
+REM into bench-results\mesa first. MESA_DIR is the x64 folder of a Mesa build for Windows.
+IF "%MESA_DIR%"=="" (
+    ECHO Set MESA_DIR to the folder holding Mesa's opengl32.dll
+    EXIT /B 1
+)
+SET RUNDIR=bench-results\mesa
+IF NOT EXIST %RUNDIR% MKDIR %RUNDIR%
+COPY /Y bin\Release\Grafik\*.exe %RUNDIR% > NUL || EXIT /B 1
+COPY /Y "%MESA_DIR%\*.dll" %RUNDIR% > NUL || EXIT /B 1
+
+SET GALLIUM_DRIVER=llvmpipe
+REM llvmpipe reports GL 4.5, the renderer asks for 4.6
+SET MESA_GL_VERSION_OVERRIDE=4.6
+SET MESA_GLSL_VERSION_OVERRIDE=460
+SET ARGS=%*
+SET FAILED=0
+FOR %%L IN (clearcolor triangle stacks mirror batch loop swarm) DO CALL :lab %%L
+IF %FAILED%==1 EXIT /B 1
+EXIT /B 0
+
+:lab
+SET TIMES=
+IF DEFINED TIME_BASELINE IF EXIST "%TIME_BASELINE%\%1.csv" SET TIMES=-timebaseline "%TIME_BASELINE%\%1.csv"
+%RUNDIR%\Grafik.exe -bench %1 -frames 120 -warmup 30 -size 640x480 -seed 1 -benchout bench-results\%1.csv -golden data\golden\%1.ppm -baseline data\golden\%1.csv %TIMES% %ARGS%
+IF ERRORLEVEL 1 (
+    ECHO %1 failed
+    SET FAILED=1
+)
+EXIT /B 0
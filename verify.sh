@@ -0,0 +1,28 @@
+#!/bin/sh
+# Renders each lab headless on Mesa's llvmpipe and compares it to data/golden
+# Record new references with: ./verify.sh -updategolden
+#
+# The headless context is surfaceless EGL, so no display is needed. Without a GPU
+# Mesa falls back to llvmpipe, GALLIUM_DRIVER makes that explicit.
+#
+# Frame times only hold on the runner that recorded them, so they stay out of the repo. Set
+# TIME_BASELINE to a folder with the bench-results CSVs of an earlier good run on this runner
+# to check them as well.
+export GALLIUM_DRIVER=llvmpipe
+# llvmpipe reports GL 4.5, the renderer asks for 4.6
+export MESA_GL_VERSION_OVERRIDE=4.6
+export MESA_GLSL_VERSION_OVERRIDE=460
+
+GRAFIK=${GRAFIK:-bin/Release/Grafik/Grafik}
+FAILED=0
+for LAB in clearcolor triangle stacks mirror batch loop swarm; do
+    TIMES=""
+    if [ -n "$TIME_BASELINE" ] && [ -f "$TIME_BASELINE/$LAB.csv" ]; then
+        TIMES="$TIME_BASELINE/$LAB.csv"
+    fi
+    if ! "$GRAFIK" -bench $LAB -frames 120 -warmup 30 -size 640x480 -seed 1 -benchout bench-results/$LAB.csv -golden data/golden/$LAB.ppm -baseline data/golden/$LAB.csv ${TIMES:+-timebaseline "$TIMES"} "$@"; then
+        echo "$LAB failed"
+        FAILED=1
+    fi
+done
+exit $FAILED